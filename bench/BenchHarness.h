@@ -0,0 +1,104 @@
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include "settings/Utility.h"
+
+using namespace std;
+
+// Keeps results alive so the compiler cannot drop the measured work.
+inline volatile double bench_sink = 0.0;
+
+struct BenchResult {
+    string name;
+    string params;                  // "key":value pairs, already JSON
+    vector<double> samples_ms;      // one per timed run
+    double items_per_run = 0.0;     // e.g. samples or paths per run, 0 if not meaningful
+
+    double get_min() const { return *std::min_element(samples_ms.begin(), samples_ms.end()); }
+    double get_max() const { return *std::max_element(samples_ms.begin(), samples_ms.end()); }
+    double get_mean() const {
+        double sum = 0.0;
+        for (double s : samples_ms) sum += s;
+        return sum / samples_ms.size();
+    }
+    double get_stddev() const {
+        double mean = get_mean(), sum = 0.0;
+        for (double s : samples_ms) sum += (s - mean) * (s - mean);
+        return samples_ms.size() > 1 ? std::sqrt(sum / (samples_ms.size() - 1)) : 0.0;
+    }
+    double get_percentile(double p) const { return ::get_percentile(samples_ms, p); }
+    // median absolute deviation, robust against the odd slow run
+    double get_mad() const {
+        double median = get_percentile(50.0);
+        BenchResult deviations;
+        for (double s : samples_ms) deviations.samples_ms.push_back(std::abs(s - median));
+        return deviations.get_percentile(50.0);
+    }
+};
+
+// Runs every benchmark warmup times untimed, then at least min_runs timed runs and more until min_seconds
+// passed (capped at max_runs). Setup belongs outside of body, reset runs untimed before every run.
+class BenchHarness
+{
+private:
+    vector<BenchResult> results;
+    string filter;
+    int min_runs, max_runs, warmup;
+    double min_seconds;
+
+public:
+    BenchHarness(string filter = "", int min_runs = 5, int max_runs = 50, double min_seconds = 0.5, int warmup = 1)
+        : filter(filter), min_runs(min_runs), max_runs(max_runs), warmup(warmup), min_seconds(min_seconds) {}
+
+    bool is_selected(const string &name) const { return filter.empty() || name.find(filter) != string::npos; }
+
+    void run(const string &name, const string &params, double items_per_run, const function<void()> &body,
+             const function<void()> &reset = nullptr) {
+        if (!is_selected(name)) return;
+        for (int i = 0; i < warmup; i++) { if (reset) reset(); body(); }
+
+        BenchResult r = { name, params, {}, items_per_run };
+        double total_ms = 0.0;
+        while ((int)r.samples_ms.size() < max_runs && ((int)r.samples_ms.size() < min_runs || total_ms < min_seconds * 1000.0)) {
+            if (reset) reset();
+            auto start_time = std::chrono::steady_clock::now();
+            body();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            r.samples_ms.push_back(ms);
+            total_ms += ms;
+        }
+        std::cerr << name << " {" << params << "}: median " << r.get_percentile(50.0) << "ms over " << r.samples_ms.size() << " runs" << std::endl;
+        results.push_back(r);
+    }
+
+    string to_json(unsigned int seed) const {
+        std::ostringstream out;
+        out.precision(6);
+        out << "{\n  \"suite\": \"layer_trains_bench\",\n  \"seed\": " << seed << ",\n  \"unit\": \"ms\",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchResult &r = results[i];
+            double median = r.get_percentile(50.0);
+            out << (i ? "," : "") << "\n    {\"name\": \"" << r.name << "\", \"params\": {" << r.params << "}"
+                << ", \"runs\": " << r.samples_ms.size()
+                << ", \"min\": " << r.get_min() << ", \"median\": " << median << ", \"mean\": " << r.get_mean()
+                << ", \"stddev\": " << r.get_stddev() << ", \"mad\": " << r.get_mad()
+                << ", \"p90\": " << r.get_percentile(90.0) << ", \"max\": " << r.get_max();
+            if (r.items_per_run > 0.0) out << ", \"items_per_run\": " << r.items_per_run << ", \"ns_per_item\": " << median * 1e6 / r.items_per_run;
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+        return out.str();
+    }
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef SYNTHETICTERRAIN_H
+#define SYNTHETICTERRAIN_H
+
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "settings/Parallel.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+// Reproducible inputs for the benchmarks. Everything comes from integer hashes and std::mt19937 (whose
+// sequence is fixed by the standard), never from std distributions, so a seed gives the same map everywhere.
+
+#define SYNTHETIC_MAP_WIDTH 20000.f         // [m], the same at every resolution so paths stay comparable
+#define SYNTHETIC_HEIGHT_RANGE 1500.f       // [m]
+#define SYNTHETIC_OCTAVES 4
+
+inline uint32_t hash_coords(int x, int y, uint32_t seed) {
+    uint32_t h = seed ^ ((uint32_t)x * 0x27d4eb2du) ^ ((uint32_t)y * 0x165667b1u);
+    h ^= h >> 15; h *= 0x85ebca6bu;
+    h ^= h >> 13; h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// [0,1) from the top 24 bits
+inline float unit_float(uint32_t bits) { return (bits >> 8) * (1.f / 16777216.f); }
+
+inline float value_noise(float x, float y, uint32_t seed) {
+    int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+    float fx = x - x0, fy = y - y0;
+    fx = fx * fx * (3.f - 2.f * fx);
+    fy = fy * fy * (3.f - 2.f * fy);
+    float a = unit_float(hash_coords(x0, y0, seed)), b = unit_float(hash_coords(x0 + 1, y0, seed));
+    float c = unit_float(hash_coords(x0, y0 + 1, seed)), d = unit_float(hash_coords(x0 + 1, y0 + 1, seed));
+    return glm::mix(glm::mix(a, b, fx), glm::mix(c, d, fx), fy);
+}
+
+enum class SyntheticShape {
+    ROLLING,    // fractal noise with a valley along the diagonal
+    RIDGES,     // sharp crests, flanks fall away on both sides
+    VALLEYS,    // sharp V shaped valley floors between rounded hills
+    PLATEAUS    // flat terraces joined by steep steps
+};
+
+inline const char* get_synthetic_shape_name(SyntheticShape shape) {
+    switch (shape) {
+        case SyntheticShape::RIDGES: return "ridges";
+        case SyntheticShape::VALLEYS: return "valleys";
+        case SyntheticShape::PLATEAUS: return "plateaus";
+        default: return "rolling";
+    }
+}
+
+#define SYNTHETIC_TERRACE_NUM 5
+
+// [0,1] height of the shape at uv
+inline float synthetic_height(float u, float v, uint32_t seed, SyntheticShape shape) {
+    float h = 0.f, amplitude = .5f, frequency = 4.f;
+    for (int o = 0; o < SYNTHETIC_OCTAVES; o++) {
+        float n = value_noise(u * frequency, v * frequency, seed + o);
+        if (shape == SyntheticShape::RIDGES) { n = 1.f - std::abs(2.f * n - 1.f); n *= n; }
+        else if (shape == SyntheticShape::VALLEYS) n = std::abs(2.f * n - 1.f);
+        h += amplitude * n;
+        amplitude *= .5f;
+        frequency *= 2.f;
+    }
+    if (shape == SyntheticShape::ROLLING) {
+        float valley = glm::clamp(std::abs(u - v) * 3.f, 0.f, 1.f);
+        h *= .4f + .6f * valley;
+    } else if (shape == SyntheticShape::PLATEAUS) {
+        float t = glm::clamp(h, 0.f, 1.f) * SYNTHETIC_TERRACE_NUM;
+        float step = std::floor(t), f = t - step;
+        f = f * f * (3.f - 2.f * f);
+        f = f * f * (3.f - 2.f * f);
+        h = (step + f) / SYNTHETIC_TERRACE_NUM;
+    }
+    return glm::clamp(h, 0.f, 1.f);
+}
+
+// 16 bit heights of a size x size map
+inline vector<unsigned short> make_synthetic_heights(int size, uint32_t seed, SyntheticShape shape = SyntheticShape::ROLLING) {
+    vector<unsigned short> heights((size_t)size * size);
+    parallel_for(0, size, [&](int y, int worker) {
+        for (int x = 0; x < size; x++) {
+            float h = synthetic_height((float)x / size, (float)y / size, seed, shape);
+            heights[(size_t)y * size + x] = (unsigned short)(h * 65535.f);
+        }
+    });
+    return heights;
+}
+
+// areas map like the painted ones: height in red, a checker of region codes in blue and green
+inline vector<unsigned char> make_synthetic_areas(const vector<unsigned short> &heights, int size) {
+    vector<unsigned char> areas((size_t)size * size * 3);
+    int cell = std::max(1, size / 8);
+    parallel_for(0, size, [&](int y, int worker) {
+        for (int x = 0; x < size; x++) {
+            size_t i = (size_t)y * size + x;
+            int region = (x / cell + 2 * (y / cell)) % 5;
+            areas[i*3] = (unsigned char)(heights[i] >> 8);
+            areas[i*3+1] = region == 1 ? (unsigned char)FORREST : 0;
+            areas[i*3+2] = region == 3 ? (unsigned char)CITY : 0;
+        }
+    });
+    return areas;
+}
+
+inline vector<vec3> make_synthetic_gradient(vec3 from, vec3 to) {
+    vector<vec3> gradient(256);
+    for (int i = 0; i < 256; i++) gradient[i] = glm::mix(from, to, i / 255.f);
+    return gradient;
+}
+
+// terrain data of a synthetic map, size only changes the detail
+inline TerrainData make_synthetic_terrain_data(int size) {
+    TerrainData td = {};
+    td.title = "Synthetic";
+    td.heightmap_path = "";
+    td.areas_data_path = "";
+    td.resolution_x = size;
+    td.resolution_y = size;
+    td.minimum_height_reach = 0.f;
+    td.maximum_height_reach = SYNTHETIC_HEIGHT_RANGE;
+    td.vertical_scale = SYNTHETIC_HEIGHT_RANGE / SYNTHETIC_MAP_WIDTH;
+    td.water_level_height = 150.f;
+    td.snow_level_height = 2000.f;
+    return td;
+}
+
+// random point in [-range, range]^2 of terrain local space
+inline vec2 random_local_pos(std::mt19937 &rng, float range = .5f) {
+    return vec2(unit_float(rng()) * 2.f - 1.f, unit_float(rng()) * 2.f - 1.f) * range;
+}
+
+#endif
@@ -0,0 +1,521 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstdlib>
+#include "rendering/Window.h"
+#include "BenchHarness.h"
+#include "SyntheticTerrain.h"
+#include "terrain/ElevationLineDrawer.h"
+#include "terrain/TerrainPainter.h"
+#include "terrain/ReachabilityField.h"
+#include "terrain/ContourExtractor.h"
+#include "terrain/TerrainFields.h"
+#include "terrain/TerraformBrush.h"
+#include "terrain/Hydrology.h"
+#include "path_drawer/VerticalAlignment.h"
+#include "path_drawer/PathSystem.h"
+#include "path_drawer/TrackSegmentTree.h"
+#include "user_interaction/InteractableManager.h"
+
+InputHandler* InputHandler::instance = nullptr;
+
+// Micro benchmarks of the CPU side hot paths on synthetic data, built against the no-op GL headers in
+// bench/gl_stub so no window or context is needed.
+//   layer_trains_bench [--sizes 1024,4096,16384] [--filter name] [--seed 1] [--out results.json] [--heightmap file.png]
+// --heightmap also runs the map cases that take one on a 16 bit heightmap with the transalpine height reach.
+
+#define BENCH_PATH_STEP 0.01f               // same as CONSTANT_SLOPE_PATH_POINT_STEP of the path drawers
+#define BENCH_PATH_SLOPE 0.03f
+#define BENCH_PATHS_PER_RUN 256
+#define BENCH_SAMPLES_PER_RUN 1000000
+#define BENCH_QUERIES_PER_RUN 100
+#define BENCH_SHORTCUT_FRACTION 0.05f       // random long links on top of the grid, of the node number
+#define BENCH_ROUTE_QUERIES_PER_RUN 4
+#define BENCH_ROUTE_NUM 4                   // k of the alternative route searches
+#define BENCH_LINKS_PER_RUN 4
+#define BENCH_ROW_CHECK_PAIRS 1000
+#define BENCH_ROW_CHECK_TOLERANCE 1e-4f     // relative, kept rows may have summed a tied route in another order
+#define BENCH_PROCESS_CALLS_PER_RUN 10000
+#define BENCH_TRACK_PATH_POINTS 300         // like a committed path of the drawers
+#define BENCH_TRACK_PATH_STEP 0.004f
+#define BENCH_TRACK_QUERIES_PER_RUN 100
+#define BENCH_REACH_GRADE .1f
+#define BENCH_REACH_GRADE_CHANGE .02f       // one scroll step of the auto slope drawer
+#define BENCH_ALIGNMENT_PATHS_PER_RUN 8
+#define BENCH_ALIGNMENT_PATH_LENGTH 5000.f  // [m] start to end
+#define BENCH_ALIGNMENT_PATH_POINTS 2000    // like a committed path of the solvers
+
+// everything written to cout is dropped while this lives (object construction is chatty)
+struct SilenceCout {
+    std::streambuf *previous;
+    std::ostringstream sink;
+    SilenceCout() : previous(std::cout.rdbuf(sink.rdbuf())) {}
+    ~SilenceCout() { std::cout.rdbuf(previous); }
+};
+
+static vector<int> parse_sizes(const string &list) {
+    vector<int> sizes;
+    std::stringstream stream(list);
+    string item;
+    while (std::getline(stream, item, ',')) if (!item.empty()) sizes.push_back(std::atoi(item.c_str()));
+    return sizes;
+}
+
+static string size_params(int size) { return "\"size\": " + std::to_string(size); }
+
+/* Heightfield */
+
+static void bench_heightfield(BenchHarness &bench, int size, uint32_t seed) {
+    if (!bench.is_selected("eld_bilinear_sampling") && !bench.is_selected("constant_slope_path") && !bench.is_selected("auto_slope_path")) return;
+    ElevationLineDrawer drawer(make_synthetic_heights(size, seed), size, size, make_synthetic_terrain_data(size).vertical_scale);
+
+    // sample positions are drawn up front so only the sampling is timed
+    std::mt19937 rng(seed);
+    vector<vec2> positions(BENCH_SAMPLES_PER_RUN);
+    for (vec2 &p : positions) p = random_local_pos(rng);
+    bench.run("eld_bilinear_sampling", size_params(size), BENCH_SAMPLES_PER_RUN, [&]() {
+        float sum = 0.f;
+        for (const vec2 &p : positions) sum += drawer.get_height_at_local_pos(p.x, p.y);
+        bench_sink = bench_sink + sum;
+    });
+
+    vector<vec3> starts(BENCH_PATHS_PER_RUN);
+    vector<vec2> ends(BENCH_PATHS_PER_RUN);
+    for (int i = 0; i < BENCH_PATHS_PER_RUN; i++) {
+        vec2 start = random_local_pos(rng, .45f);
+        starts[i] = vec3(start, drawer.get_height_at_local_pos(start.x, start.y));
+        ends[i] = random_local_pos(rng, .45f);
+    }
+    string path_params = size_params(size) + ", \"paths\": " + std::to_string(BENCH_PATHS_PER_RUN) + ", \"step\": " + std::to_string(BENCH_PATH_STEP);
+
+    // the path cache would answer repeated calls, so it is cleared before every path
+    bench.run("constant_slope_path", path_params, BENCH_PATHS_PER_RUN, [&]() {
+        size_t points = 0;
+        for (int i = 0; i < BENCH_PATHS_PER_RUN; i++) {
+            drawer.clear_cache();
+            points += drawer.generate_constant_slope_path(starts[i], ends[i], BENCH_PATH_SLOPE, BENCH_PATH_STEP).size();
+        }
+        bench_sink = bench_sink + points;
+    });
+    bench.run("auto_slope_path", path_params, BENCH_PATHS_PER_RUN, [&]() {
+        size_t points = 0;
+        for (int i = 0; i < BENCH_PATHS_PER_RUN; i++) {
+            drawer.clear_cache();
+            points += drawer.generate_auto_slope_path(starts[i], ends[i], BENCH_PATH_SLOPE, BENCH_PATH_STEP).size();
+        }
+        bench_sink = bench_sink + points;
+    });
+}
+
+/* Painter */
+
+static void bench_painter(BenchHarness &bench, int size, uint32_t seed) {
+    if (!bench.is_selected("painter_bake")) return;
+    vector<unsigned char> areas = make_synthetic_areas(make_synthetic_heights(size, seed), size);
+    TerrainData terrain_data = make_synthetic_terrain_data(size);
+    TerrainPainter painter(&terrain_data);
+    painter.set_source(areas.data(), size, size,
+        make_synthetic_gradient(vec3(.2f, .35f, .15f), vec3(.9f, .85f, .8f)),
+        make_synthetic_gradient(vec3(.45f, .4f, .35f), vec3(.3f, .3f, .3f)),
+        make_synthetic_gradient(vec3(.1f, .3f, .5f), vec3(.05f, .1f, .3f)));
+    areas = {};
+
+    vector<unsigned char> color_buffer;
+    bench.run("painter_bake", size_params(size), (double)size * size, [&]() {
+        painter.bake_terrain_pixels(color_buffer);
+        bench_sink = bench_sink + color_buffer[color_buffer.size() / 2];
+    });
+}
+
+/* Reachability */
+
+// the field at the downsampled app resolution and at the full resolution of the map
+static void bench_reachability(BenchHarness &bench, int size, int resolution, uint32_t seed) {
+    if (!bench.is_selected("reachability_recompute") && !bench.is_selected("reachability_limit_change")) return;
+    ElevationLineDrawer drawer(make_synthetic_heights(size, seed), size, size, make_synthetic_terrain_data(size).vertical_scale);
+    TerrainData terrain_data = make_synthetic_terrain_data(size);
+    ReachabilityField field(&drawer, &terrain_data, resolution);
+    std::mt19937 rng(seed);
+    field.update(vec3(random_local_pos(rng, .4f), 0.f), BENCH_REACH_GRADE);
+    string params = size_params(size) + ", \"cells\": " + std::to_string(field.get_width()) + "x" + std::to_string(field.get_height());
+
+    // a new handle, the whole field is rebuilt
+    bench.run("reachability_recompute", params, 1, [&]() {
+        field.update(vec3(random_local_pos(rng, .4f), 0.f), BENCH_REACH_GRADE);
+        bench_sink = bench_sink + field.get_texels()[0];
+    });
+
+    // scrolling the grade limit up and down, the same rebuild from the same handle
+    int step = 0;
+    field.update(vec3(0.f), BENCH_REACH_GRADE);
+    bench.run("reachability_limit_change", params, 1, [&]() {
+        field.update(vec3(0.f), BENCH_REACH_GRADE + (++step & 1) * BENCH_REACH_GRADE_CHANGE);
+        bench_sink = bench_sink + field.get_texels()[0];
+    });
+}
+
+/* Terraforming */
+
+// one brush step of a raise stroke at 60 fps with the derived fields following it, the CPU side of
+// Terrain::terraform without the texture uploads and colour re-bakes
+static void bench_terraform(BenchHarness &bench, int size, uint32_t seed) {
+    if (!bench.is_selected("terraform_step")) return;
+    TerrainData terrain_data = make_synthetic_terrain_data(size);
+    ElevationLineDrawer drawer(make_synthetic_heights(size, seed), size, size, terrain_data.vertical_scale);
+    TerrainFields fields(&drawer, &terrain_data);
+    fields.compute();
+    drawer.add_edit_listener([&](const PixelRect &r) { fields.update_pixels(r); });
+    TerraformBrush brush(&drawer, &terrain_data);
+    std::mt19937 rng(seed);
+    string params = size_params(size) + ", \"radius\": " + std::to_string((int)TERRAFORM_BRUSH_RADIUS);
+    bench.run("terraform_step", params, 1, [&]() {
+        PixelRect r = brush.apply(random_local_pos(rng, .4f), TERRAFORM_BRUSH_RADIUS, TERRAFORM_BRUSH_SPEED / 60.f, TERRAFORM_RAISE);
+        bench_sink = bench_sink + r.x1;
+    });
+}
+
+/* Drainage */
+
+// the full pass that follows a terraform stroke, flow accumulation and flat routing run serially
+static void bench_hydrology(BenchHarness &bench, ElevationLineDrawer &drawer, const TerrainData &terrain_data, const string &params) {
+    if (!bench.is_selected("hydrology_compute")) return;
+    Hydrology hydrology(&drawer, &terrain_data);
+    bench.run("hydrology_compute", params, 1, [&]() {
+        hydrology.compute();
+        bench_sink = bench_sink + hydrology.get_lakes().size();
+    });
+}
+
+/* Contours */
+
+// every line of the map at the minor spacing from an empty cache, like the first contour query of a scene
+static void bench_contour_extract(BenchHarness &bench, ElevationLineDrawer &drawer, const TerrainData &terrain_data, const string &params) {
+    if (!bench.is_selected("contour_extract")) return;
+    ContourExtractor extractor(&drawer, &terrain_data);
+    string spacing_params = params + ", \"spacing\": " + std::to_string((int)CONTOUR_MINOR_SPACING);
+    bench.run("contour_extract", spacing_params, 1, [&]() {
+        bench_sink = bench_sink + extractor.extract(CONTOUR_MINOR_SPACING).lines.size();
+    }, [&]() { extractor.clear_cache(); });
+}
+
+/* Vertical alignment */
+
+// auto slope paths towards ends BENCH_ALIGNMENT_PATH_LENGTH away, as committed by the drawers; about half of
+// them cannot hold the grade to the end on the synthetic relief and end unpinned
+static void bench_vertical_alignment(BenchHarness &bench, int size, uint32_t seed) {
+    if (!bench.is_selected("vertical_alignment")) return;
+    ElevationLineDrawer drawer(make_synthetic_heights(size, seed), size, size, make_synthetic_terrain_data(size).vertical_scale);
+    TerrainData terrain_data = make_synthetic_terrain_data(size);
+    VerticalAlignment alignment(&drawer, &terrain_data);
+    float length = BENCH_ALIGNMENT_PATH_LENGTH / terrain_data.get_metres_per_local_unit();
+    float step = length / BENCH_ALIGNMENT_PATH_POINTS;
+
+    std::mt19937 rng(seed);
+    vector<vector<vec3>> paths(BENCH_ALIGNMENT_PATHS_PER_RUN);
+    for (vector<vec3> &path : paths) {
+        vec2 start = random_local_pos(rng, .5f - length);
+        float angle = unit_float(rng()) * 6.2831853f;
+        vec2 end = start + vec2(std::cos(angle), std::sin(angle)) * length;
+        vec3 start_3d = vec3(start, drawer.get_height_at_local_pos(start.x, start.y));
+        path = drawer.trace_slope_path(start_3d, end, drawer.get_auto_slope(start_3d, end, ALIGNMENT_MAX_GRADE), step);
+    }
+    string params = size_params(size) + ", \"paths\": " + std::to_string(BENCH_ALIGNMENT_PATHS_PER_RUN) + ", \"length_m\": "
+                  + std::to_string((int)BENCH_ALIGNMENT_PATH_LENGTH) + ", \"points\": " + std::to_string(BENCH_ALIGNMENT_PATH_POINTS);
+
+    bench.run("vertical_alignment", params, BENCH_ALIGNMENT_PATHS_PER_RUN, [&]() {
+        float cost = 0.f;
+        for (const vector<vec3> &path : paths) cost += alignment.optimise(path, ALIGNMENT_MAX_GRADE).cost;
+        bench_sink = bench_sink + cost;
+    });
+}
+
+/* Path network */
+
+struct SyntheticNetwork {
+    int node_num;
+    vector<vec2> positions;
+    vector<ivec2> links;
+    vector<float> lengths;
+};
+
+// jittered grid with links to the right and upper neighbours plus a few random long links
+static SyntheticNetwork make_synthetic_network(int node_num, uint32_t seed) {
+    SyntheticNetwork n;
+    int side = (int)std::ceil(std::sqrt((float)node_num));
+    n.node_num = side * side;
+    std::mt19937 rng(seed);
+    for (int i = 0; i < n.node_num; i++) {
+        vec2 jitter = vec2(unit_float(rng()), unit_float(rng())) - .5f;
+        n.positions.push_back((vec2(i % side, i / side) + jitter * .6f) / (float)side - .5f);
+    }
+    auto link = [&](int a, int b) {
+        n.links.push_back(ivec2(a, b));
+        n.lengths.push_back(glm::distance(n.positions[a], n.positions[b]));
+    };
+    for (int i = 0; i < n.node_num; i++) {
+        if (i % side + 1 < side) link(i, i + 1);
+        if (i + side < n.node_num) link(i, i + side);
+    }
+    int shortcut_num = (int)(n.node_num * BENCH_SHORTCUT_FRACTION);
+    for (int s = 0; s < shortcut_num; s++) {
+        int a = rng() % n.node_num, b = rng() % n.node_num;
+        if (a != b) link(a, b);
+    }
+    return n;
+}
+
+static void fill_path_system(PathSystem &system, const SyntheticNetwork &n, bool with_links = true) {
+    for (int i = 0; i < n.node_num; i++) system.create_destination(i, "synthetic", i % 4 != 0);
+    if (!with_links) return;
+    for (size_t l = 0; l < n.links.size(); l++) system.add_link(n.links[l].x, n.links[l].y, n.lengths[l]);
+}
+
+static void bench_path_system(BenchHarness &bench, int node_num, uint32_t seed) {
+    SyntheticNetwork network = make_synthetic_network(node_num, seed);
+    string params = "\"nodes\": " + std::to_string(network.node_num) + ", \"links\": " + std::to_string(network.links.size());
+
+    if (bench.is_selected("path_system_dijkstra")) {
+        PathSystem system;
+        fill_path_system(system, network);
+        std::mt19937 rng(seed);
+        vector<ivec2> queries(BENCH_QUERIES_PER_RUN);
+        for (ivec2 &q : queries) q = ivec2(rng() % network.node_num, rng() % network.node_num);
+
+        // no distance rows are precomputed, every query runs a search
+        bench.run("path_system_dijkstra", params, BENCH_QUERIES_PER_RUN, [&]() {
+            float sum = 0.f;
+            for (const ivec2 &q : queries) sum += system.find_traverse_length(q.x, q.y);
+            bench_sink = bench_sink + sum;
+        });
+    }
+
+    if (bench.is_selected("path_system_k_shortest")) {
+        PathSystem system;
+        fill_path_system(system, network);
+        std::mt19937 rng(seed);
+        vector<ivec2> queries(BENCH_ROUTE_QUERIES_PER_RUN);
+        for (ivec2 &q : queries) q = ivec2(rng() % network.node_num, rng() % network.node_num);
+
+        // every spur search of a Yen iteration on the shared pool
+        bench.run("path_system_k_shortest", params + ", \"k\": " + std::to_string(BENCH_ROUTE_NUM), BENCH_ROUTE_QUERIES_PER_RUN, [&]() {
+            float sum = 0.f;
+            for (const ivec2 &q : queries)
+                for (const PathRoute &route : system.find_k_shortest(q.x, q.y, BENCH_ROUTE_NUM)) sum += route.length;
+            bench_sink = bench_sink + sum;
+        });
+    }
+
+    // destinations are created untimed, the links are added in creation order so the sets merge as they grow
+    std::unique_ptr<PathSystem> system;
+    bench.run("path_system_add_link", params, (double)network.links.size(), [&]() {
+        for (size_t l = 0; l < network.links.size(); l++) system->add_link(network.links[l].x, network.links[l].y, network.lengths[l]);
+        bench_sink = bench_sink + system->are_all_destinations_connected();
+    }, [&]() {
+        system = std::make_unique<PathSystem>();
+        fill_path_system(*system, network, false);
+    });
+}
+
+// Cached distance rows through add_link: every run adds a few random links and refills the rows they
+// invalidated. Afterwards the rows are checked against fresh searches of a system that never cached any,
+// false if they disagree.
+static bool bench_distance_rows(BenchHarness &bench, int node_num, uint32_t seed) {
+    if (!bench.is_selected("path_system_distance_rows")) return true;
+    SyntheticNetwork network = make_synthetic_network(node_num, seed);
+    string params = "\"nodes\": " + std::to_string(network.node_num) + ", \"links\": " + std::to_string(network.links.size());
+    PathSystem system;
+    fill_path_system(system, network);
+    system.precompute_distances();
+
+    std::mt19937 rng(seed);
+    bench.run("path_system_distance_rows", params, BENCH_LINKS_PER_RUN, [&]() {
+        for (int l = 0; l < BENCH_LINKS_PER_RUN; l++) {
+            int a = rng() % network.node_num, b = rng() % network.node_num;
+            float length = glm::distance(network.positions[a], network.positions[b]);
+            system.add_link(a, b, length);
+            network.links.push_back(ivec2(a, b));
+            network.lengths.push_back(length);
+        }
+        system.precompute_distances();
+        bench_sink = bench_sink + system.find_traverse_length(0, network.node_num - 1);
+    });
+
+    PathSystem fresh;
+    fill_path_system(fresh, network);
+    auto differs = [](float cached, float expected) {
+        return std::abs(cached - expected) > BENCH_ROW_CHECK_TOLERANCE * std::max(1.f, std::abs(expected));
+    };
+    int mismatches = 0;
+    for (int p = 0; p < BENCH_ROW_CHECK_PAIRS; p++) {
+        int a = rng() % network.node_num, b = rng() % network.node_num;
+        mismatches += differs(system.find_traverse_length(a, b), fresh.find_traverse_length(a, b));
+    }
+    mismatches += differs(system.get_total_travel_length(), fresh.get_total_travel_length());
+    if (mismatches > 0) std::cerr << "path_system_distance_rows: " << mismatches << " cached distances differ from fresh searches" << std::endl;
+    return mismatches == 0;
+}
+
+/* Interactables */
+
+static void bench_interactables(BenchHarness &bench, int interactable_num, uint32_t seed) {
+    if (!bench.is_selected("interactable_create") && !bench.is_selected("interactable_process_all")) return;
+
+    std::unique_ptr<Camera> camera;
+    std::unique_ptr<World> world;
+    std::unique_ptr<InteractableManager> manager;
+    int calls = 0;
+    std::mt19937 rng(seed);
+    vector<Interactable*> created;
+
+    // a scene's worth of handles into the scene pool, released in bulk between runs like at a scene end
+    vector<vec2> create_positions(interactable_num);
+    for (vec2 &p : create_positions) p = random_local_pos(rng);
+    auto release_scene = [&]() {
+        SilenceCout silence;
+        manager.reset();
+        if (world) world->clear_objects();
+        get_scene_arena().release();
+        if (camera) camera->clear_dependancies();
+    };
+    auto new_scene = [&]() {
+        release_scene();
+        camera = std::make_unique<Camera>(SCR_WIDTH, SCR_HEIGHT);
+        world = std::make_unique<World>(camera.get());
+        manager = std::make_unique<InteractableManager>(world.get(), [&](Interactable *i) { calls++; });
+    };
+    bench.run("interactable_create", "\"interactables\": " + std::to_string(interactable_num), interactable_num, [&]() {
+        SilenceCout silence;
+        for (const vec2 &p : create_positions)
+            manager->create(vec3(p, 0.f), "synthetic", InteractionType::PATH_HANDLE, INTERACTABLE_INTERACT_DISTANCE);
+    }, new_scene);
+    release_scene();
+    if (!bench.is_selected("interactable_process_all")) return;
+
+    {
+        SilenceCout silence;
+        camera = std::make_unique<Camera>(SCR_WIDTH, SCR_HEIGHT);
+        world = std::make_unique<World>(camera.get());
+        manager = std::make_unique<InteractableManager>(world.get(), [&](Interactable *i) { calls++; });
+        for (int i = 0; i < interactable_num; i++) {
+            vec2 pos = random_local_pos(rng);
+            created.push_back(manager->create(vec3(pos, 0.f), "synthetic", InteractionType::PATH_HANDLE, INTERACTABLE_INTERACT_DISTANCE));
+        }
+    }
+
+    // cursor positions, half of them right at an interactable so highlights switch on and off
+    vector<vec3> cursors(BENCH_PROCESS_CALLS_PER_RUN);
+    for (int c = 0; c < BENCH_PROCESS_CALLS_PER_RUN; c++) {
+        cursors[c] = c % 2 ? vec3(random_local_pos(rng), 0.f) : created[rng() % created.size()]->position;
+    }
+
+    bench.run("interactable_process_all", "\"interactables\": " + std::to_string(interactable_num), BENCH_PROCESS_CALLS_PER_RUN, [&]() {
+        for (const vec3 &cursor : cursors) manager->process_all(cursor, false);
+        bench_sink = bench_sink + calls;
+    });
+
+    release_scene();
+}
+
+/* Committed track */
+
+// wandering polyline of BENCH_TRACK_PATH_POINTS points, heights are irrelevant to the tree
+static vector<vec3> make_track_path(std::mt19937 &rng) {
+    vector<vec3> points(BENCH_TRACK_PATH_POINTS);
+    vec2 p = random_local_pos(rng, .4f);
+    float heading = unit_float(rng()) * 6.2831853f;
+    for (vec3 &point : points) {
+        point = vec3(p, 0.f);
+        heading += (unit_float(rng()) - .5f) * .3f;
+        p = glm::clamp(p + BENCH_TRACK_PATH_STEP * vec2(std::cos(heading), std::sin(heading)), vec2(-.5f), vec2(.5f));
+    }
+    return points;
+}
+
+static void bench_track_tree(BenchHarness &bench, int path_num, uint32_t seed) {
+    if (!bench.is_selected("track_tree_path_crossings") && !bench.is_selected("track_tree_update_path")) return;
+    std::mt19937 rng(seed);
+    TrackSegmentTree tree;
+    vector<vector<vec3>> paths(path_num);
+    for (int p = 0; p < path_num; p++) {
+        paths[p] = make_track_path(rng);
+        tree.insert_path(paths[p], p);
+    }
+    vector<vector<vec3>> candidates(BENCH_TRACK_QUERIES_PER_RUN);
+    for (vector<vec3> &c : candidates) c = make_track_path(rng);
+    string params = "\"paths\": " + std::to_string(path_num) + ", \"segments\": " + std::to_string(tree.get_segment_num())
+                  + ", \"candidate_points\": " + std::to_string(BENCH_TRACK_PATH_POINTS);
+
+    // the preview check of every drag frame
+    vector<TrackCrossing> crossings;
+    bench.run("track_tree_path_crossings", params, BENCH_TRACK_QUERIES_PER_RUN, [&]() {
+        size_t found = 0;
+        for (const vector<vec3> &c : candidates) found += tree.find_path_crossings(c, crossings, .01f);
+        bench_sink = bench_sink + found;
+    });
+
+    // committed paths replaced in turn, the tree stays the same size
+    int next = 0;
+    bench.run("track_tree_update_path", params, BENCH_TRACK_QUERIES_PER_RUN, [&]() {
+        for (int q = 0; q < BENCH_TRACK_QUERIES_PER_RUN; q++) {
+            int id = next++ % path_num;
+            tree.update_path(candidates[q], id);
+            std::swap(paths[id], candidates[q]);
+        }
+        bench_sink = bench_sink + tree.get_segment_num();
+    });
+}
+
+int main(int argc, char **argv) {
+    vector<int> sizes = { 1024, 4096 };
+    string filter, out_path, heightmap_path;
+    uint32_t seed = 1;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        string arg = argv[a];
+        if (arg == "--sizes") sizes = parse_sizes(argv[a+1]);
+        else if (arg == "--filter") filter = argv[a+1];
+        else if (arg == "--out") out_path = argv[a+1];
+        else if (arg == "--seed") seed = (uint32_t)std::strtoul(argv[a+1], nullptr, 10);
+        else if (arg == "--heightmap") heightmap_path = argv[a+1];
+        else { std::cerr << "Unknown argument " << arg << std::endl; return 1; }
+    }
+
+    BenchHarness bench(filter);
+    for (int size : sizes) {
+        bench_heightfield(bench, size, seed);
+        bench_painter(bench, size, seed);
+        for (int resolution : { REACH_FIELD_RESOLUTION, 1024 }) bench_reachability(bench, size, resolution, seed);
+        bench_vertical_alignment(bench, size, seed);
+        bench_terraform(bench, size, seed);
+        if (bench.is_selected("contour_extract") || bench.is_selected("hydrology_compute")) {
+            ElevationLineDrawer drawer(make_synthetic_heights(size, seed), size, size, make_synthetic_terrain_data(size).vertical_scale);
+            TerrainData terrain_data = make_synthetic_terrain_data(size);
+            bench_contour_extract(bench, drawer, terrain_data, size_params(size));
+            bench_hydrology(bench, drawer, terrain_data, size_params(size));
+        }
+    }
+    if (!heightmap_path.empty()) {
+        TerrainData terrain_data = terrain_transalpine;
+        terrain_data.heightmap_path = heightmap_path.c_str();
+        ElevationLineDrawer drawer(terrain_data.heightmap_path, terrain_data.vertical_scale, true);
+        if (!drawer.is_loaded()) return 1;
+        string params = size_params(drawer.get_map_width()) + ", \"heightmap\": \"" + heightmap_path + "\"";
+        bench_contour_extract(bench, drawer, terrain_data, params);
+        bench_hydrology(bench, drawer, terrain_data, params);
+    }
+    for (int node_num : { 1000, 10000 }) bench_path_system(bench, node_num, seed);
+    if (!bench_distance_rows(bench, 1000, seed)) return 1;
+    for (int interactable_num : { 1000, 10000 }) bench_interactables(bench, interactable_num, seed);
+    for (int path_num : { 16, 256 }) bench_track_tree(bench, path_num, seed);
+
+    string json = bench.to_json(seed);
+    if (out_path.empty()) { std::cout << json; return 0; }
+    std::ofstream file(out_path);
+    if (!file) { std::cerr << "Could not write " << out_path << std::endl; return 1; }
+    file << json;
+    std::cerr << "Results written to " << out_path << std::endl;
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef GLFW_STUB_H
+#define GLFW_STUB_H
+
+// GLFW for the benchmark target: no window is ever created and nothing is ever pressed.
+
+struct GLFWwindow;
+struct GLFWmonitor;
+typedef void (*GLFWglproc)();
+typedef void (*GLFWframebuffersizefun)(GLFWwindow*, int, int);
+typedef void (*GLFWscrollfun)(GLFWwindow*, double, double);
+
+#define GLFW_CONTEXT_VERSION_MAJOR 0x00022002
+#define GLFW_CONTEXT_VERSION_MINOR 0x00022003
+#define GLFW_OPENGL_PROFILE 0x00022008
+#define GLFW_OPENGL_CORE_PROFILE 0x00032001
+#define GLFW_VISIBLE 0x00020004
+#define GLFW_CONTEXT_CREATION_API 0x0002200B
+#define GLFW_EGL_CONTEXT_API 0x00036002
+#define GLFW_FALSE 0
+#define GLFW_TRUE 1
+#define GLFW_RELEASE 0
+#define GLFW_PRESS 1
+#define GLFW_MOUSE_BUTTON_LEFT 0
+#define GLFW_MOUSE_BUTTON_RIGHT 1
+#define GLFW_MOUSE_BUTTON_MIDDLE 2
+#define GLFW_KEY_SPACE 32
+#define GLFW_KEY_A 65
+#define GLFW_KEY_D 68
+#define GLFW_KEY_S 83
+#define GLFW_KEY_W 87
+#define GLFW_KEY_ESCAPE 256
+#define GLFW_KEY_F3 292
+#define GLFW_KEY_F4 293
+#define GLFW_KEY_LEFT_SHIFT 340
+#define GLFW_KEY_LEFT_CONTROL 341
+
+inline int glfwInit() { return 0; }
+inline void glfwTerminate() {}
+inline void glfwWindowHint(int, int) {}
+inline GLFWwindow* glfwCreateWindow(int, int, const char*, GLFWmonitor*, GLFWwindow*) { return nullptr; }
+inline void glfwMakeContextCurrent(GLFWwindow*) {}
+inline GLFWglproc glfwGetProcAddress(const char*) { return nullptr; }
+inline GLFWframebuffersizefun glfwSetFramebufferSizeCallback(GLFWwindow*, GLFWframebuffersizefun) { return nullptr; }
+inline GLFWscrollfun glfwSetScrollCallback(GLFWwindow*, GLFWscrollfun) { return nullptr; }
+inline int glfwWindowShouldClose(GLFWwindow*) { return 1; }
+inline void glfwPollEvents() {}
+inline void glfwSwapBuffers(GLFWwindow*) {}
+inline GLFWwindow* glfwGetCurrentContext() { return nullptr; }
+inline void glfwSwapInterval(int) {}
+inline int glfwGetKey(GLFWwindow*, int) { return GLFW_RELEASE; }
+inline int glfwGetMouseButton(GLFWwindow*, int) { return GLFW_RELEASE; }
+inline void glfwGetCursorPos(GLFWwindow*, double *x, double *y) { *x = 0.0; *y = 0.0; }
+inline void glfwSetWindowShouldClose(GLFWwindow*, int) {}
+inline double glfwGetTime() { return 0.0; }
+
+#endif
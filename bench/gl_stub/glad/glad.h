@@ -0,0 +1,120 @@
+#ifndef GLAD_STUB_H
+#define GLAD_STUB_H
+
+// No-op OpenGL for the benchmark target. The engine headers compile against it unchanged, objects that
+// would talk to the GPU get zero ids and draw nothing, so only CPU work is measured.
+
+#include <cstdint>
+
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef int GLint;
+typedef int GLsizei;
+typedef float GLfloat;
+typedef char GLchar;
+typedef unsigned char GLboolean;
+typedef unsigned char GLubyte;
+typedef uint64_t GLuint64;
+
+#define GL_FALSE 0
+#define GL_TRUE 1
+#define GL_TRIANGLES 0x0004
+#define GL_TRIANGLE_FAN 0x0006
+#define GL_LINE_STRIP 0x0003
+#define GL_LINE 0x1B01
+#define GL_FRONT_AND_BACK 0x0408
+#define GL_CCW 0x0901
+#define GL_CULL_FACE 0x0B44
+#define GL_DEPTH_TEST 0x0B71
+#define GL_BLEND 0x0BE2
+#define GL_SRC_ALPHA 0x0302
+#define GL_ONE_MINUS_SRC_ALPHA 0x0303
+#define GL_COLOR_BUFFER_BIT 0x4000
+#define GL_DEPTH_BUFFER_BIT 0x0100
+#define GL_UNSIGNED_BYTE 0x1401
+#define GL_UNSIGNED_SHORT 0x1403
+#define GL_UNSIGNED_INT 0x1405
+#define GL_FLOAT 0x1406
+#define GL_RED 0x1903
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_RG 0x8227
+#define GL_R8 0x8229
+#define GL_R16 0x822A
+#define GL_RG16 0x822C
+#define GL_RGB32F 0x8815
+#define GL_TEXTURE_2D 0x0DE1
+#define GL_TEXTURE_MAG_FILTER 0x2800
+#define GL_TEXTURE_MIN_FILTER 0x2801
+#define GL_TEXTURE_WRAP_S 0x2802
+#define GL_TEXTURE_WRAP_T 0x2803
+#define GL_NEAREST 0x2600
+#define GL_LINEAR 0x2601
+#define GL_CLAMP_TO_EDGE 0x812F
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_TEXTURE0 0x84C0
+#define GL_TEXTURE15 0x84CF
+#define GL_ARRAY_BUFFER 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#define GL_STATIC_DRAW 0x88E4
+#define GL_DYNAMIC_DRAW 0x88E8
+#define GL_FRAGMENT_SHADER 0x8B30
+#define GL_VERTEX_SHADER 0x8B31
+#define GL_GEOMETRY_SHADER 0x8DD9
+#define GL_COMPILE_STATUS 0x8B81
+#define GL_LINK_STATUS 0x8B82
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_RENDERBUFFER 0x8D41
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#define GL_COLOR_ATTACHMENT15 0x8CEF
+#define GL_DEPTH_ATTACHMENT 0x8D00
+#define GL_DEPTH_COMPONENT24 0x81A6
+#define GL_TIME_ELAPSED 0x88BF
+#define GL_TIMESTAMP 0x8E28
+#define GL_QUERY_RESULT 0x8866
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#define GL_RENDERER 0x1F01
+#define GL_VERSION 0x1F02
+
+#define GL_STUB(name) template <typename... A> inline void name(A...) {}
+
+// object names
+inline void glGenTextures(GLsizei n, GLuint *ids) { for (int i = 0; i < n; i++) ids[i] = 0; }
+inline void glGenBuffers(GLsizei n, GLuint *ids) { for (int i = 0; i < n; i++) ids[i] = 0; }
+inline void glGenVertexArrays(GLsizei n, GLuint *ids) { for (int i = 0; i < n; i++) ids[i] = 0; }
+inline void glGenFramebuffers(GLsizei n, GLuint *ids) { for (int i = 0; i < n; i++) ids[i] = 0; }
+inline void glGenRenderbuffers(GLsizei n, GLuint *ids) { for (int i = 0; i < n; i++) ids[i] = 0; }
+inline void glGenQueries(GLsizei n, GLuint *ids) { for (int i = 0; i < n; i++) ids[i] = 0; }
+inline GLuint glCreateShader(GLenum) { return 0; }
+inline GLuint glCreateProgram() { return 0; }
+inline GLint glGetUniformLocation(GLuint, const GLchar*) { return -1; }
+typedef void* (*GLADloadproc)(const char *name);
+inline int gladLoadGLLoader(GLADloadproc) { return 1; }
+inline GLenum glCheckFramebufferStatus(GLenum) { return GL_FRAMEBUFFER_COMPLETE; }
+inline const GLubyte* glGetString(GLenum) { return (const GLubyte*)"no-op GL"; }
+
+// queries report success so no error paths run
+inline void glGetShaderiv(GLuint, GLenum, GLint *value) { *value = GL_TRUE; }
+inline void glGetProgramiv(GLuint, GLenum, GLint *value) { *value = GL_TRUE; }
+inline void glGetQueryObjectiv(GLuint, GLenum, GLint *value) { *value = GL_TRUE; }
+inline void glGetQueryObjectui64v(GLuint, GLenum, GLuint64 *value) { *value = 0; }
+
+GL_STUB(glActiveTexture) GL_STUB(glAttachShader) GL_STUB(glBeginQuery) GL_STUB(glBindBuffer)
+GL_STUB(glBindFramebuffer) GL_STUB(glBindRenderbuffer) GL_STUB(glBindTexture) GL_STUB(glBindVertexArray)
+GL_STUB(glBlendFunc) GL_STUB(glBufferData) GL_STUB(glBufferSubData) GL_STUB(glClear) GL_STUB(glClearColor)
+GL_STUB(glCompileShader) GL_STUB(glDeleteBuffers) GL_STUB(glDeleteQueries) GL_STUB(glDeleteShader)
+GL_STUB(glDeleteVertexArrays) GL_STUB(glDeleteTextures) GL_STUB(glDeleteProgram) GL_STUB(glDeleteFramebuffers)
+GL_STUB(glDeleteRenderbuffers) GL_STUB(glDepthMask) GL_STUB(glDisable) GL_STUB(glDrawArrays) GL_STUB(glDrawElements)
+GL_STUB(glEnable) GL_STUB(glEnableVertexAttribArray) GL_STUB(glEndQuery) GL_STUB(glFramebufferRenderbuffer)
+GL_STUB(glFramebufferTexture2D) GL_STUB(glFrontFace) GL_STUB(glGenerateMipmap) GL_STUB(glGetProgramInfoLog)
+GL_STUB(glGetShaderInfoLog) GL_STUB(glLineWidth) GL_STUB(glLinkProgram) GL_STUB(glPixelStorei) GL_STUB(glPolygonMode)
+GL_STUB(glQueryCounter) GL_STUB(glReadBuffer) GL_STUB(glReadPixels) GL_STUB(glRenderbufferStorage) GL_STUB(glShaderSource)
+GL_STUB(glTexImage2D) GL_STUB(glTexParameteri) GL_STUB(glTexSubImage2D) GL_STUB(glUniform1f) GL_STUB(glUniform1i)
+GL_STUB(glUniform2fv) GL_STUB(glUniform3fv) GL_STUB(glUniform4fv) GL_STUB(glUniformMatrix4fv) GL_STUB(glUseProgram)
+GL_STUB(glVertexAttribPointer) GL_STUB(glViewport)
+
+#undef GL_STUB
+
+#endif
@@ -0,0 +1,243 @@
+// heightmap pixel reads of every solve are counted, see ElevationLineDrawer
+#define HEIGHT_SAMPLE_COUNTING 1
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include "rendering/Window.h"
+#include "SyntheticTerrain.h"
+#include "terrain/ElevationLineDrawer.h"
+#include "terrain/IsolineTracer.h"
+#include "path_drawer/StraightPathDrawer.h"
+#include "path_drawer/SlopePathCandidates.h"
+
+InputHandler* InputHandler::instance = nullptr;
+
+// Quality and speed of the path solvers over a fixed corpus of start / end pairs on synthetic terrains
+// (and the bundled heightmap when it loads). Every solver runs over the same pairs in parallel and gets
+// a row in the comparison table: success rate, end point error, grade violation, points, height samples, time.
+//   path_solver_corpus [--pairs 2000] [--size 1024] [--max-grade 0.1] [--seed 1] [--heightmap path] [--out corpus.json]
+
+#define CORPUS_PATH_STEP 0.01f              // same as CONSTANT_SLOPE_PATH_POINT_STEP of the path drawers
+#define CORPUS_END_TOLERANCE 0.015f         // [local] a path ending further from the end point failed
+#define CORPUS_MIN_PAIR_DISTANCE 0.05f      // [local]
+#define CORPUS_MAX_PAIR_DISTANCE 0.5f       // [local]
+#define CORPUS_MARGIN 0.45f                 // pairs lie within [-margin, margin]^2
+#define CORPUS_VIOLATION_TOLERANCE 0.001f   // grade excess counted as a violating path
+
+struct CorpusPair {
+    vec3 start;
+    vec2 end;
+};
+
+// solver state of one thread, slope candidates run serially on it so the threads do not share the pool
+struct SolverWorker {
+    ElevationLineDrawer *heights;
+    WorkerPool serial_pool{1};
+    IsolineTracer isoline_tracer;
+    SlopePathCandidates candidates;
+
+    SolverWorker(ElevationLineDrawer *heights)
+        : heights(heights), isoline_tracer(heights), candidates(heights, serial_pool, PATH_CANDIDATE_MAX_NUM) {}
+};
+
+struct PathSolver {
+    const char *name;
+    std::function<vector<vec3>(SolverWorker &w, vec3 start, vec2 end, float max_grade)> solve;
+};
+
+// the solvers as the path drawers call them, caches are cleared so every pair is solved from scratch
+const vector<PathSolver> PATH_SOLVERS = {
+    { "straight", [](SolverWorker &w, vec3 start, vec2 end, float max_grade) {
+        return StraightPathDrawer::sample_straight_path(*w.heights, start, vec3(end, w.heights->get_height_at_local_pos(end.x, end.y)));
+    } },
+    { "auto_slope", [](SolverWorker &w, vec3 start, vec2 end, float max_grade) {
+        w.candidates.clear_cache();
+        float slope = w.heights->get_auto_slope(start, end, max_grade);
+        return w.candidates.generate(start, end, slope, max_grade, CORPUS_PATH_STEP, true);
+    } },
+    { "auto_slope_greedy", [](SolverWorker &w, vec3 start, vec2 end, float max_grade) {
+        return w.heights->trace_slope_path(start, end, w.heights->get_auto_slope(start, end, max_grade), CORPUS_PATH_STEP);
+    } },
+    { "match_slope", [](SolverWorker &w, vec3 start, vec2 end, float max_grade) {
+        w.isoline_tracer.clear_cache();
+        return w.isoline_tracer.trace(start, end, w.heights->get_auto_slope(start, end, max_grade));
+    } },
+};
+
+struct PairResult {
+    bool success;
+    float end_error;        // [m]
+    float grade_violation;  // largest segment grade above the limit
+    int point_num;
+    long long sample_num;
+    double time_us;
+};
+
+struct SolverScorecard {
+    string terrain, solver;
+    int pair_num = 0;
+    float success_rate = 0.f;
+    float end_error_mean = 0.f, end_error_p90 = 0.f;
+    float violation_mean = 0.f, violation_max = 0.f, violating_rate = 0.f;
+    float points_mean = 0.f, samples_mean = 0.f;
+    double time_mean_us = 0.0, time_p90_us = 0.0, wall_ms = 0.0;
+};
+
+static float get_max_grade_violation(const vector<vec3> &path, float max_grade) {
+    float violation = 0.f;
+    for (size_t i = 1; i < path.size(); i++) {
+        float run = glm::length(vec2(path[i]) - vec2(path[i-1]));
+        if (run < 1e-6f) continue;
+        violation = std::max(violation, std::abs(path[i].z - path[i-1].z) / run - max_grade);
+    }
+    return violation;
+}
+
+static vector<CorpusPair> make_corpus_pairs(ElevationLineDrawer &heights, int pair_num, uint32_t seed) {
+    std::mt19937 rng(seed);
+    vector<CorpusPair> pairs;
+    while ((int)pairs.size() < pair_num) {
+        vec2 start = random_local_pos(rng, CORPUS_MARGIN);
+        float angle = unit_float(rng()) * 2.f * PI;
+        float distance = glm::mix(CORPUS_MIN_PAIR_DISTANCE, CORPUS_MAX_PAIR_DISTANCE, unit_float(rng()));
+        vec2 end = start + vec2(std::cos(angle), std::sin(angle)) * distance;
+        if (std::abs(end.x) > CORPUS_MARGIN || std::abs(end.y) > CORPUS_MARGIN) continue;
+        pairs.push_back({ vec3(start, heights.get_height_at_local_pos(start.x, start.y)), end });
+    }
+    return pairs;
+}
+
+static SolverScorecard run_solver(const PathSolver &solver, const string &terrain, ElevationLineDrawer &heights,
+                                  float metres_per_local_unit, const vector<CorpusPair> &pairs, float max_grade) {
+    int worker_num = get_worker_num((int)pairs.size());
+    vector<std::unique_ptr<SolverWorker>> workers;
+    for (int w = 0; w < worker_num; w++) workers.push_back(std::make_unique<SolverWorker>(&heights));
+
+    vector<PairResult> results(pairs.size());
+    auto wall_start = std::chrono::steady_clock::now();
+    parallel_for(0, (int)pairs.size(), [&](int i, int worker) {
+        const CorpusPair &pair = pairs[i];
+        long long &sample_num = ElevationLineDrawer::get_thread_height_sample_num();
+        long long samples_before = sample_num;
+        auto start_time = std::chrono::steady_clock::now();
+        vector<vec3> path = solver.solve(*workers[worker], pair.start, pair.end, max_grade);
+        double time_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+
+        float end_error = path.empty() ? glm::length(pair.end - vec2(pair.start)) : glm::length(pair.end - vec2(path.back()));
+        results[i] = { end_error <= CORPUS_END_TOLERANCE, end_error * metres_per_local_unit,
+                       get_max_grade_violation(path, max_grade), (int)path.size(), sample_num - samples_before, time_us };
+    });
+    double wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+
+    SolverScorecard card;
+    card.terrain = terrain;
+    card.solver = solver.name;
+    card.pair_num = (int)pairs.size();
+    card.wall_ms = wall_ms;
+    vector<float> end_errors, times;
+    for (const PairResult &r : results) {
+        card.success_rate += r.success;
+        card.end_error_mean += r.end_error;
+        card.violation_mean += r.grade_violation;
+        card.violation_max = std::max(card.violation_max, r.grade_violation);
+        card.violating_rate += r.grade_violation > CORPUS_VIOLATION_TOLERANCE;
+        card.points_mean += r.point_num;
+        card.samples_mean += (float)r.sample_num;
+        card.time_mean_us += r.time_us;
+        end_errors.push_back(r.end_error);
+        times.push_back((float)r.time_us);
+    }
+    float n = (float)std::max(1, card.pair_num);
+    card.success_rate /= n; card.end_error_mean /= n; card.violation_mean /= n; card.violating_rate /= n;
+    card.points_mean /= n; card.samples_mean /= n; card.time_mean_us /= n;
+    card.end_error_p90 = get_percentile(end_errors, 90.f);
+    card.time_p90_us = get_percentile(times, 90.f);
+    return card;
+}
+
+static void print_table(const vector<SolverScorecard> &cards, float max_grade) {
+    std::printf("\nPath solver corpus, max grade %.3f, success = end within %.3f local units\n", max_grade, CORPUS_END_TOLERANCE);
+    std::printf("%-12s %-18s %6s %8s %10s %10s %9s %9s %8s %8s %10s %10s %10s\n", "terrain", "solver", "pairs", "success",
+                "err avg m", "err p90 m", "viol avg", "viol max", "viol %", "points", "samples", "us/path", "wall ms");
+    string last_terrain;
+    for (const SolverScorecard &c : cards) {
+        if (!last_terrain.empty() && c.terrain != last_terrain) std::printf("\n");
+        last_terrain = c.terrain;
+        std::printf("%-12s %-18s %6d %7.1f%% %10.1f %10.1f %9.4f %9.4f %7.1f%% %8.1f %10.0f %10.1f %10.1f\n",
+                    c.terrain.c_str(), c.solver.c_str(), c.pair_num, c.success_rate * 100.f, c.end_error_mean, c.end_error_p90,
+                    c.violation_mean, c.violation_max, c.violating_rate * 100.f, c.points_mean, c.samples_mean, c.time_mean_us, c.wall_ms);
+    }
+}
+
+static string to_json(const vector<SolverScorecard> &cards, uint32_t seed, float max_grade) {
+    std::ostringstream out;
+    out.precision(6);
+    out << "{\n  \"suite\": \"path_solver_corpus\",\n  \"seed\": " << seed << ",\n  \"max_grade\": " << max_grade
+        << ",\n  \"end_tolerance\": " << CORPUS_END_TOLERANCE << ",\n  \"scorecards\": [";
+    for (size_t i = 0; i < cards.size(); i++) {
+        const SolverScorecard &c = cards[i];
+        out << (i ? "," : "") << "\n    {\"terrain\": \"" << c.terrain << "\", \"solver\": \"" << c.solver << "\", \"pairs\": " << c.pair_num
+            << ", \"success_rate\": " << c.success_rate << ", \"end_error_mean_m\": " << c.end_error_mean << ", \"end_error_p90_m\": " << c.end_error_p90
+            << ", \"grade_violation_mean\": " << c.violation_mean << ", \"grade_violation_max\": " << c.violation_max
+            << ", \"violating_rate\": " << c.violating_rate << ", \"points_mean\": " << c.points_mean << ", \"height_samples_mean\": " << c.samples_mean
+            << ", \"time_mean_us\": " << c.time_mean_us << ", \"time_p90_us\": " << c.time_p90_us << ", \"wall_ms\": " << c.wall_ms << "}";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+int main(int argc, char **argv) {
+    int pair_num = 2000, size = 1024;
+    float max_grade = .1f;
+    uint32_t seed = 1;
+    string heightmap_path = terrain_transalpine.heightmap_path, out_path;
+    for (int a = 1; a + 1 < argc; a += 2) {
+        string arg = argv[a];
+        if (arg == "--pairs") pair_num = std::atoi(argv[a+1]);
+        else if (arg == "--size") size = std::atoi(argv[a+1]);
+        else if (arg == "--max-grade") max_grade = (float)std::atof(argv[a+1]);
+        else if (arg == "--seed") seed = (uint32_t)std::strtoul(argv[a+1], nullptr, 10);
+        else if (arg == "--heightmap") heightmap_path = argv[a+1];
+        else if (arg == "--out") out_path = argv[a+1];
+        else { std::cerr << "Unknown argument " << arg << std::endl; return 1; }
+    }
+
+    vector<SolverScorecard> cards;
+    auto run_terrain = [&](const string &name, ElevationLineDrawer &heights, float metres_per_local_unit) {
+        vector<CorpusPair> pairs = make_corpus_pairs(heights, pair_num, seed);
+        for (const PathSolver &solver : PATH_SOLVERS) {
+            cards.push_back(run_solver(solver, name, heights, metres_per_local_unit, pairs, max_grade));
+            std::cerr << name << " / " << solver.name << " done" << std::endl;
+        }
+    };
+
+    // bundled heightmap, 16 bit like the terrain loads it
+    {
+        ElevationLineDrawer heights(heightmap_path.c_str(), terrain_transalpine.vertical_scale, true);
+        if (heights.is_loaded()) run_terrain("transalpine", heights, terrain_transalpine.get_metres_per_local_unit());
+        else std::cerr << "Bundled heightmap " << heightmap_path << " not found, synthetic terrains only" << std::endl;
+    }
+
+    TerrainData synthetic = make_synthetic_terrain_data(size);
+    for (SyntheticShape shape : { SyntheticShape::ROLLING, SyntheticShape::RIDGES, SyntheticShape::VALLEYS, SyntheticShape::PLATEAUS }) {
+        ElevationLineDrawer heights(make_synthetic_heights(size, seed, shape), size, size, synthetic.vertical_scale);
+        run_terrain(get_synthetic_shape_name(shape), heights, synthetic.get_metres_per_local_unit());
+    }
+
+    print_table(cards, max_grade);
+    if (out_path.empty()) return 0;
+    std::ofstream file(out_path);
+    if (!file) { std::cerr << "Could not write " << out_path << std::endl; return 1; }
+    file << to_json(cards, seed, max_grade);
+    std::cerr << "Scorecards written to " << out_path << std::endl;
+    return 0;
+}
@@ -10,11 +10,22 @@ int main() {
     Window window( SCR_WIDTH, SCR_HEIGHT, WINDOW_TITLE );
     InputHandler input_handler = InputHandler();
     input_handler.set_scroll_speed(CAMERA_ZOOM_SPEED);
-    window.initGLFW();
+    window.initGLFW(FLYTHROUGH_BENCHMARK);
     if (!window.create()) return -1;
+    if (FLYTHROUGH_BENCHMARK) glfwSwapInterval(0); // frame times not capped by vsync
     glfwSetScrollCallback(window.get(), InputHandler::scroll_callback);
     double last_frame_time = 0.0f;
 
+    // input recording or replay, has to be set up before the scenes create their path solvers
+    InputRecorder &input_recorder = get_input_recorder();
+#if INPUT_RECORDING_MODE == INPUT_RECORDING_RECORD
+    input_recorder.start_recording(INPUT_RECORDING_PATH, get_shared_worker_pool().get_size());
+#elif INPUT_RECORDING_MODE == INPUT_RECORDING_REPLAY
+    if (!input_recorder.load_replay(INPUT_RECORDING_PATH)) return -1;
+#endif
+    FlythroughBenchmark &flythrough = get_flythrough_benchmark();
+    if (FLYTHROUGH_BENCHMARK) flythrough.start();
+
     // ==========================================================
     /* Create simulation objects */
     
@@ -26,45 +37,58 @@ int main() {
     // ==========================================================
     /* Create scenes */
 
-    const vector<Scene*> scenes = {
-        new TitleCardScene( &world, &camera, &screen_ui, &input_handler),
-        new TerrainScene( &terrain_transalpine, &world, &camera, &screen_ui, &input_handler)
-    };
+    TerrainScene *terrain_scene = new TerrainScene( &terrain_transalpine, &world, &camera, &screen_ui, &input_handler);
+    vector<Scene*> scenes = { terrain_scene };
+    if (!flythrough.is_running()) scenes.insert(scenes.begin(), new TitleCardScene( &world, &camera, &screen_ui, &input_handler));
 
     // ==========================================================
     /* Render Loop */
 
-    for (int i=0; i<scenes.size(); i++){
-        // remove previous scene objects
-        screen_ui.clear_objects();
-        world.clear_objects();
-        camera.clear_dependancies();
-
+    bool window_closed = false;
+    for (int i=0; i<scenes.size() && !window_closed; i++){
         // init current scene
         std::cout << std::endl << std::endl << "=============================" << std::endl 
             << "Starting scene nr " << (i+1) << std::endl << "=============================" << std::endl;
         Scene* current_scene = scenes[i];
+        get_resource_tracker().begin_scene(current_scene->get_name());
         current_scene->init();
+        if (current_scene == terrain_scene) flythrough.commit_synthetic_paths(terrain_scene);
         Shader *world_pos_buffer_shader = current_scene->get_world_pos_buffer_shader();
+#if FRAME_PROFILER_ENABLED
+        ProfilerOverlay *profiler_overlay = new ProfilerOverlay();
+        profiler_overlay->place(&screen_ui);
+#endif
         vec4 bg_col = current_scene->get_background_colour();
         
         while(current_scene->active()) {
             /* Frame time controls  */
+            PROFILE_FRAME_BEGIN();
+            input_recorder.begin_frame();
+            flythrough.begin_frame();
             float current_time = (float) glfwGetTime();
             float dt = current_time - last_frame_time;
             dt = dt > 0.2f ? .2f : dt; // make sure dt not massive on lag spike
             last_frame_time = current_time;
             
-            /* Process user input  */
-            input_handler.process_input(window.get(), dt, window.get_size());
-            screen_ui.check_button_clicked(&input_handler);
+            /* Process user input, live or replayed with the recorded timestep  */
+            {
+                PROFILE_ZONE("input");
+                InputFrame input_frame = flythrough.is_running() ? flythrough.next_input_frame(window.get_size())
+                    : input_recorder.is_replaying() ? input_recorder.next_replay_frame() : input_handler.poll_frame(window.get(), dt);
+                input_recorder.record(input_frame);
+                dt = input_frame.dt;
+                input_handler.apply_frame(input_frame, window.get_size());
+                screen_ui.check_button_clicked(&input_handler);
+            }
             
             /* Update camera position for shaders */
+            flythrough.apply_camera(camera);
             camera.calculate_transform_matrix();
             camera.update_dependent_shader_view_matrix();
 
             /* Render to world position buffer texture */            
             if (world_pos_buffer_shader){
+                PROFILE_PASS("world pos pass");
                 glBindFramebuffer(GL_FRAMEBUFFER, world_pos_buffer_shader->worldPosFBO);
                 window.clear(bg_col.r,bg_col.b,bg_col.g,bg_col.a);
                 world_pos_buffer_shader->render_to_world_pos_buffer();
@@ -72,7 +96,10 @@ int main() {
             }
 
             /* Current scene logic */
-            current_scene->loop(dt);
+            {
+                PROFILE_ZONE("scene loop");
+                current_scene->loop(dt);
+            }
 
             /* Final render */
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -81,19 +108,67 @@ int main() {
                 world_pos_buffer_shader->bind_world_pos_buffer();
                 world_pos_buffer_shader->send_mouse_position( input_handler.get_mouse_position_normalized(),  CURSOR_INNER_RADIUS, CURSOR_OUTER_RADIUS );
             }
-            world.render();
-            screen_ui.render( SCR_WIDTH, SCR_HEIGHT );
+            {
+                PROFILE_PASS("world pass");
+                world.render();
+            }
+            {
+                PROFILE_PASS("screen ui");
+                screen_ui.render( SCR_WIDTH, SCR_HEIGHT );
+            }
+            {
+                PROFILE_ZONE("swap buffers");
+                window.display(); 
+            }
+            PROFILE_FRAME_END();
+            input_recorder.end_frame();
+            flythrough.end_frame();
+
+            /* Frame profiler overlay and trace export */
+#if FRAME_PROFILER_ENABLED
+            if (input_handler.is_profiler_overlay_toggled()) profiler_overlay->toggle();
+            if (input_handler.is_trace_dump_requested()) get_frame_profiler().write_chrome_trace(FRAME_PROFILER_TRACE_PATH);
+            profiler_overlay->update(get_frame_profiler());
+#endif
 
-            window.display(); 
+            /* end of a replay */
+            if (input_recorder.is_replay_finished()) {
+                input_recorder.write_replay_timings(INPUT_REPLAY_TIMINGS_PATH);
+#if FRAME_PROFILER_ENABLED
+                get_frame_profiler().write_chrome_trace(FRAME_PROFILER_TRACE_PATH);
+#endif
+                glfwSetWindowShouldClose(window.get(), true);
+            }
+
+            /* end of the flythrough */
+            if (flythrough.is_finished()) {
+                flythrough.write_report(FLYTHROUGH_REPORT_PATH);
+                glfwSetWindowShouldClose(window.get(), true);
+            }
 
             /* check window closed */
             if (!window.open()) {
-                glfwTerminate();
-                return 0;
+                window_closed = true;
+                break;
             }
         }
+
+        // remove the scene and its objects, the overlay rows belong to the screen ui
+#if FRAME_PROFILER_ENABLED
+        delete profiler_overlay;
+#endif
+        delete current_scene;
+        scenes[i] = nullptr;
+        screen_ui.clear_objects();
+        world.clear_objects();
+        get_scene_arena().release();
+        camera.clear_dependancies();
+        get_resource_tracker().end_scene();
     }
+    for (Scene *scene : scenes) delete scene;   // never started
 
+    UIText::unload_font();
+    get_resource_tracker().print_report();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef ARCLENGTHPATH_H
+#define ARCLENGTHPATH_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+
+using namespace glm;
+using namespace std;
+
+// Polyline with a prefix sum of horizontal (xy) segment lengths, points can be looked up by distance along it in O(log n)
+class ArcLengthPath
+{
+private:
+    vector<vec3> points;
+    vector<float> cumulative_length; // cumulative_length[i] is the distance from the start to points[i]
+
+public:
+    ArcLengthPath() {}
+    ArcLengthPath(const vector<vec3> &points) { set_points(points); }
+
+    void set_points(const vector<vec3> &new_points) {
+        points = new_points;
+        cumulative_length.resize(points.size());
+        if (points.empty()) return;
+        cumulative_length[0] = 0.f;
+        for (size_t i = 1; i < points.size(); i++)
+            cumulative_length[i] = cumulative_length[i-1] + glm::length(vec2(points[i]) - vec2(points[i-1]));
+    }
+
+    // index of the segment [i, i+1] containing the distance, clamped to the path
+    int get_segment_at_distance(float d) const {
+        if (points.size() < 2) return 0;
+        int i = (int)(std::upper_bound(cumulative_length.begin(), cumulative_length.end(), d) - cumulative_length.begin()) - 1;
+        return glm::clamp(i, 0, (int)points.size() - 2);
+    }
+
+    vec3 get_point_at_distance(float d) const {
+        if (points.empty()) return vec3(0.f);
+        if (points.size() == 1) return points[0];
+        int i = get_segment_at_distance(d);
+        float segment = cumulative_length[i+1] - cumulative_length[i];
+        float t = segment > 0.f ? glm::clamp((d - cumulative_length[i]) / segment, 0.f, 1.f) : 0.f;
+        return glm::mix(points[i], points[i+1], t);
+    }
+
+    // horizontal unit direction of the path at the distance
+    vec2 get_direction_at_distance(float d) const {
+        if (points.size() < 2) return vec2(1.f, 0.f);
+        int i = get_segment_at_distance(d);
+        vec2 dir = vec2(points[i+1]) - vec2(points[i]);
+        float len = glm::length(dir);
+        return len > 0.f ? dir / len : vec2(1.f, 0.f);
+    }
+
+    // points every spacing along the path, both ends are always kept
+    vector<vec3> resample(float spacing) const {
+        vector<vec3> out;
+        if (points.size() < 2 || spacing <= 0.f) return points;
+
+        float total = get_length();
+        int num = std::max(1, (int)std::ceil(total / spacing));
+        out.reserve(num + 1);
+        int segment = 0;
+        for (int k = 0; k <= num; k++) {
+            float d = total * (float)k / (float)num;
+            // samples are increasing, walk the segments instead of searching again
+            while (segment < (int)points.size() - 2 && cumulative_length[segment+1] < d) segment++;
+            float seg_len = cumulative_length[segment+1] - cumulative_length[segment];
+            float t = seg_len > 0.f ? glm::clamp((d - cumulative_length[segment]) / seg_len, 0.f, 1.f) : 0.f;
+            out.push_back(glm::mix(points[segment], points[segment+1], t));
+        }
+        return out;
+    }
+
+    float get_length() const { return cumulative_length.empty() ? 0.f : cumulative_length.back(); }
+    const vector<vec3>& get_points() const { return points; }
+    const vector<float>& get_cumulative_lengths() const { return cumulative_length; }
+    int get_point_num() const { return (int)points.size(); }
+};
+
+#endif
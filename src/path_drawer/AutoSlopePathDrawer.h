@@ -8,6 +8,7 @@
 #include "Terrain.h"
 #include "InputHandler.h"
 #include "TerrainPathDrawer.h"
+#include "SlopePathCandidates.h"
 #include "Line.h"
 #include "World.h"
 
@@ -25,8 +26,13 @@ public:
     float last_scroll_value = 1.f;
     bool modify_scroll_on_next_update = false;
 
+    SlopePathCandidates candidates;
+
     AutoSlopePathDrawer (Terrain *terrain, World *w, float max_slope = 1.f, bool debug_msg = false) 
-        : TerrainPathDrawer(terrain,w,max_slope,debug_msg), max_slope(max_slope) { }   
+        : TerrainPathDrawer(terrain,w,max_slope,debug_msg), max_slope(max_slope), candidates(&terrain->elevation_line_drawer) {
+        if (get_input_recorder().is_replaying()) candidates.set_deterministic(get_input_recorder().get_recorded_worker_num());
+        else if (FLYTHROUGH_BENCHMARK) candidates.set_deterministic(FLYTHROUGH_PATH_CANDIDATE_NUM);
+    }   
 
     void update_path (InputHandler *input_handler) override {
         /* modify max slope */
@@ -40,19 +46,15 @@ public:
     }
 
     void recalculate_path (Line* line, vec3 start, vec3 end, float max_slope) override{        
-        // from a given point we can go two direction from any point along the gradient, we generate both and check 
-        // which has end closer to the end position
+        // from a given point we can go either way around the terrain, candidates cover both branches,
+        // finer steps and slope jitter and the best scoring one is kept
         float step = CONSTANT_SLOPE_PATH_POINT_STEP;
-        std::vector<vec3> path_left = terrain->elevation_line_drawer.generate_auto_slope_path(start,end,max_slope,step);
-        //std::vector<vec3> path_right = terrain->elevation_line_drawer.generate_constant_slope_path(start,end,slope,step,false);
-
-        // choose better path
-        // float dist_left = glm::length(path_left.at(path_left.size()-1) - end);
-        // float dist_right = glm::length(path_right.at(path_right.size()-1) - end);
-        // current_line_segment->set_points(dist_left < dist_right ? path_left : path_right);
-        line->set_points(path_left);
+        float slope = terrain->elevation_line_drawer.get_auto_slope(start, end, max_slope);
+        line->set_points(candidates.generate(start, end, slope, max_slope, step, true));
     }
     
+    void invalidate_region(vec2 box_min, vec2 box_max) override { candidates.invalidate_region(box_min, box_max); }
+
     /* Slope */
     void change_max_slope (float new_slope) { max_slope = new_slope; }
     float get_current_max_slope() { return max_slope; }
@@ -0,0 +1,234 @@
+#ifndef EARTHWORKS_H
+#define EARTHWORKS_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "settings/Settings.h"
+#include "settings/Parallel.h"
+#include "ElevationLineDrawer.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+#define EARTHWORKS_LANES 8  // independent accumulators per row, same idea as PathAnalytics
+
+struct EarthworksVolume {
+    float cut = 0.f, fill = 0.f;            // [m^3]
+    float corridor_area = 0.f;              // [m^2]
+    float max_cut_depth = 0.f, max_fill_depth = 0.f; // [m]
+};
+
+// Cut and fill volumes of a designed track (path points carry the track height) over a corridor of
+// the heightfield. Every pixel inside the corridor belongs to the closest segment of the whole path, so
+// hairpins and loops are counted once; segments are rasterised in parallel with per worker sums and
+// heights are read straight from the shared heightmap.
+class Earthworks
+{
+private:
+    ElevationLineDrawer *height_source;
+    float metres_per_unit;
+    int width = 0, height = 0;
+
+    // segment in pixel space with its bounding box
+    struct SegmentPx {
+        vec2 a, ab;
+        float inv_len_sqr;
+        vec2 box_min, box_max;
+    };
+    vector<SegmentPx> segments;
+
+    // uniform grid over the path, segments listed in every cell their box touches (ownership candidates)
+    vec2 grid_origin;
+    float grid_cell = 1.f;
+    int grid_w = 0, grid_h = 0;
+    vector<int> cell_start, cell_segments;
+
+    struct WorkerSums {
+        float cut[EARTHWORKS_LANES], fill[EARTHWORKS_LANES], pixels[EARTHWORKS_LANES];
+        float max_cut, max_fill;
+        vector<int> candidates, row_candidates;
+    };
+    vector<WorkerSums> worker_sums;
+
+    // squared distance from p to segment a-b in pixel units, t is the projection parameter
+    static inline float segment_distance_sqr(float px, float py, vec2 a, vec2 ab, float inv_len_sqr, float &t) {
+        t = glm::clamp(((px - a.x) * ab.x + (py - a.y) * ab.y) * inv_len_sqr, 0.f, 1.f);
+        float dx = a.x + ab.x * t - px, dy = a.y + ab.y * t - py;
+        return dx*dx + dy*dy;
+    }
+
+    void build_segments(const vector<vec3> &points, float half_width_px) {
+        int n = (int)points.size() - 1;
+        vec2 scale_px = vec2(width, height);
+        segments.resize(n);
+        vec2 path_min = vec2(1e30f), path_max = vec2(-1e30f);
+        for (int i = 0; i < n; i++) {
+            SegmentPx &s = segments[i];
+            s.a = (vec2(points[i]) + vec2(0.5f)) * scale_px;
+            vec2 b = (vec2(points[i+1]) + vec2(0.5f)) * scale_px;
+            s.ab = b - s.a;
+            float len_sqr = dot(s.ab, s.ab);
+            s.inv_len_sqr = len_sqr > 0.f ? 1.f / len_sqr : 0.f;
+            s.box_min = glm::min(s.a, b);
+            s.box_max = glm::max(s.a, b);
+            path_min = glm::min(path_min, s.box_min);
+            path_max = glm::max(path_max, s.box_max);
+        }
+
+        // cells about as many as segments, never narrower than the corridor
+        vec2 extent = path_max - path_min + vec2(1.f);
+        grid_cell = std::max(2.f * half_width_px, std::sqrt(extent.x * extent.y / (float)n));
+        grid_origin = path_min;
+        grid_w = std::max(1, (int)std::ceil(extent.x / grid_cell));
+        grid_h = std::max(1, (int)std::ceil(extent.y / grid_cell));
+
+        // counting sort of segments into cells, cell c lists cell_segments[cell_start[c], cell_start[c+1])
+        cell_start.assign((size_t)grid_w * grid_h + 1, 0);
+        for (int pass = 0; pass < 2; pass++) {
+            if (pass == 1) {
+                for (size_t c = 1; c < cell_start.size(); c++) cell_start[c] += cell_start[c-1];
+                cell_segments.resize(cell_start.back());
+            }
+            for (int i = n - 1; i >= 0; i--) {
+                int cx0, cy0, cx1, cy1;
+                get_cell_range(segments[i].box_min, segments[i].box_max, cx0, cy0, cx1, cy1);
+                for (int cy = cy0; cy <= cy1; cy++)
+                    for (int cx = cx0; cx <= cx1; cx++) {
+                        size_t c = (size_t)cy * grid_w + cx;
+                        if (pass == 0) cell_start[c]++;
+                        else cell_segments[--cell_start[c]] = i;
+                    }
+            }
+        }
+    }
+
+    void get_cell_range(vec2 box_min, vec2 box_max, int &cx0, int &cy0, int &cx1, int &cy1) const {
+        cx0 = glm::clamp((int)std::floor((box_min.x - grid_origin.x) / grid_cell), 0, grid_w - 1);
+        cy0 = glm::clamp((int)std::floor((box_min.y - grid_origin.y) / grid_cell), 0, grid_h - 1);
+        cx1 = glm::clamp((int)std::floor((box_max.x - grid_origin.x) / grid_cell), 0, grid_w - 1);
+        cy1 = glm::clamp((int)std::floor((box_max.y - grid_origin.y) / grid_cell), 0, grid_h - 1);
+    }
+
+    // segments that can be closer than segment i to a pixel of its corridor: within two radii of its box
+    void gather_candidates(int i, float half_width_px, vector<int> &out) const {
+        out.clear();
+        vec2 reach = vec2(2.f * half_width_px);
+        vec2 box_min = segments[i].box_min - reach, box_max = segments[i].box_max + reach;
+        int cx0, cy0, cx1, cy1;
+        get_cell_range(box_min, box_max, cx0, cy0, cx1, cy1);
+        for (int cy = cy0; cy <= cy1; cy++)
+            for (int cx = cx0; cx <= cx1; cx++) {
+                size_t c = (size_t)cy * grid_w + cx;
+                for (int k = cell_start[c]; k < cell_start[c + 1]; k++) {
+                    int j = cell_segments[k];
+                    const SegmentPx &s = segments[j];
+                    if (j != i && s.box_max.x >= box_min.x && s.box_min.x <= box_max.x && s.box_max.y >= box_min.y && s.box_min.y <= box_max.y)
+                        out.push_back(j);
+                }
+            }
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+
+    template <typename T>
+    void rasterise_segment(const vector<vec3> &points, int i, float half_width_px, WorkerSums &sums) const {
+        const SegmentPx &s = segments[i];
+        float za = points[i].z, dz = points[i+1].z - points[i].z;
+        const T *data = static_cast<const T*>(height_source->get_raw_data());
+        float raw_to_local = height_source->get_height_scale() / (float)std::numeric_limits<T>::max();
+
+        gather_candidates(i, half_width_px, sums.candidates);
+
+        float r_sqr = half_width_px * half_width_px;
+        int x0 = std::max(0, (int)std::floor(s.box_min.x - half_width_px));
+        int x1 = std::min(width - 1, (int)std::ceil(s.box_max.x + half_width_px));
+        int y0 = std::max(0, (int)std::floor(s.box_min.y - half_width_px));
+        int y1 = std::min(height - 1, (int)std::ceil(s.box_max.y + half_width_px));
+
+        for (int y = y0; y <= y1; y++) {
+            const T *row = data + (size_t)y * width;
+            float fy = (float)y;
+
+            // only segments reaching this row can take its pixels
+            sums.row_candidates.clear();
+            for (int j : sums.candidates)
+                if (segments[j].box_min.y - half_width_px <= fy && segments[j].box_max.y + half_width_px >= fy)
+                    sums.row_candidates.push_back(j);
+
+            for (int x = x0; x <= x1; x++) {
+                int lane = x & (EARTHWORKS_LANES - 1);
+                float fx = (float)x, t, t_other;
+                float d = segment_distance_sqr(fx, fy, s.a, s.ab, s.inv_len_sqr, t);
+
+                // closest segment owns the pixel, ties go to the earlier segment
+                bool inside = d <= r_sqr;
+                for (size_t k = 0; inside && k < sums.row_candidates.size(); k++) {
+                    int j = sums.row_candidates[k];
+                    const SegmentPx &o = segments[j];
+                    float d_other = segment_distance_sqr(fx, fy, o.a, o.ab, o.inv_len_sqr, t_other);
+                    inside = d_other > d || (d_other == d && j > i);
+                }
+
+                float depth = (float)row[x] * raw_to_local - (za + dz * t);  // positive: ground above track, cut
+                float mask = inside ? 1.f : 0.f;
+                sums.cut[lane] += mask * std::max(depth, 0.f);
+                sums.fill[lane] += mask * std::max(-depth, 0.f);
+                sums.pixels[lane] += mask;
+                sums.max_cut = std::max(sums.max_cut, mask * depth);
+                sums.max_fill = std::max(sums.max_fill, -mask * depth);
+            }
+        }
+    }
+
+public:
+    Earthworks(ElevationLineDrawer *height_source, const TerrainData *terrain_data)
+        : height_source(height_source), metres_per_unit(terrain_data->get_metres_per_local_unit()) {}
+
+    // path in terrain local space, z is the designed track height; corridor width in metres
+    EarthworksVolume estimate(const vector<vec3> &points, float corridor_width) {
+        EarthworksVolume v;
+        if (!height_source->is_loaded() || points.size() < 2) return v;
+        width = height_source->get_map_width();
+        height = height_source->get_map_height();
+
+        float half_width_px = 0.5f * corridor_width / metres_per_unit * (float)width;
+        build_segments(points, half_width_px);
+
+        WorkerPool &pool = get_shared_worker_pool();
+        worker_sums.resize(pool.get_size());
+        for (WorkerSums &s : worker_sums) {
+            std::fill(s.cut, s.cut + EARTHWORKS_LANES, 0.f);
+            std::fill(s.fill, s.fill + EARTHWORKS_LANES, 0.f);
+            std::fill(s.pixels, s.pixels + EARTHWORKS_LANES, 0.f);
+            s.max_cut = s.max_fill = 0.f;
+        }
+
+        bool is_16bit = height_source->is_16bit();
+        pool.run((int)segments.size(), [&](int i, int worker) {
+            if (is_16bit) rasterise_segment<unsigned short>(points, i, half_width_px, worker_sums[worker]);
+            else rasterise_segment<unsigned char>(points, i, half_width_px, worker_sums[worker]);
+        });
+
+        float cut = 0.f, fill = 0.f, pixels = 0.f;
+        for (const WorkerSums &s : worker_sums) {
+            for (int lane = 0; lane < EARTHWORKS_LANES; lane++) { cut += s.cut[lane]; fill += s.fill[lane]; pixels += s.pixels[lane]; }
+            v.max_cut_depth = std::max(v.max_cut_depth, s.max_cut);
+            v.max_fill_depth = std::max(v.max_fill_depth, s.max_fill);
+        }
+
+        // pixel footprint and depths to metres
+        float pixel_area = (metres_per_unit / width) * (metres_per_unit / height);
+        v.cut = cut * metres_per_unit * pixel_area;
+        v.fill = fill * metres_per_unit * pixel_area;
+        v.corridor_area = pixels * pixel_area;
+        v.max_cut_depth *= metres_per_unit;
+        v.max_fill_depth *= metres_per_unit;
+        return v;
+    }
+};
+
+#endif
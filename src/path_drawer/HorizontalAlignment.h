@@ -0,0 +1,295 @@
+#ifndef HORIZONTALALIGNMENT_H
+#define HORIZONTALALIGNMENT_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "ElevationLineDrawer.h"
+#include "PathSimplifier.h"
+#include "VerticalProfile.h"
+
+using namespace glm;
+using namespace std;
+
+#define CURVE_RADIUS_SEARCH_STEPS 30        // bisection steps for the radius that fits the legs
+#define CURVE_MIN_DEFLECTION 1e-4f          // [rad] smaller bends are left straight
+#define CURVE_CLOTHOID_ANGLE_STEP .02f      // [rad] heading change per Simpson interval when integrating clothoids
+#define CURVE_PIN_MAX_KINK 1e-3f            // [rad] heading change of the last straight that takes up the end error
+#define CURVE_PIN_REFIT_NUM 3               // fits with a raised minimum radius when pinning the end shrank the curves
+
+enum AlignmentPrimitiveType {
+    PRIMITIVE_STRAIGHT, PRIMITIVE_CLOTHOID, PRIMITIVE_ARC
+};
+
+// Curvature changes linearly along the primitive: constant 0 for straights, constant 1/R for arcs.
+// Positive curvature turns left (counter clockwise in terrain xy).
+struct AlignmentPrimitive {
+    AlignmentPrimitiveType type;
+    vec2 start;
+    float heading;                          // [rad] at the start
+    float length;
+    float curvature_start, curvature_end;
+
+    float get_heading(float s) const {
+        return heading + curvature_start * s + 0.5f * (curvature_end - curvature_start) * s * s / length;
+    }
+
+    vec2 get_point(float s) const {
+        s = glm::clamp(s, 0.f, length);
+        if (type == PRIMITIVE_STRAIGHT || (std::fabs(curvature_start) < 1e-9f && std::fabs(curvature_end) < 1e-9f))
+            return start + vec2(std::cos(heading), std::sin(heading)) * s;
+        if (type == PRIMITIVE_ARC) {
+            float k = curvature_start, h = get_heading(s);
+            return start + vec2(std::sin(h) - std::sin(heading), std::cos(heading) - std::cos(h)) / k;
+        }
+        // clothoid, Fresnel integral by Simpson's rule
+        float turn = std::fabs(get_heading(s) - heading);
+        int n = 2 * std::max(2, (int)std::ceil(turn / CURVE_CLOTHOID_ANGLE_STEP));
+        float h = s / n;
+        vec2 sum = vec2(0.f);
+        for (int i = 0; i <= n; i++) {
+            float w = (i == 0 || i == n) ? 1.f : (i & 1) ? 4.f : 2.f;
+            float a = get_heading(i * h);
+            sum += w * vec2(std::cos(a), std::sin(a));
+        }
+        return start + sum * (h / 3.f);
+    }
+
+    vec2 get_end() const { return get_point(length); }
+};
+
+// Horizontal track geometry as straights joined by clothoid - arc - clothoid curves, so curvature is
+// continuous along the whole path. Stored as primitives and evaluated at any resolution.
+class HorizontalAlignment
+{
+private:
+    vector<AlignmentPrimitive> primitives;
+    vector<float> start_distance;           // distance along the alignment to the start of each primitive
+    float total_length = 0.f;
+    float min_radius_used = FLT_MAX;
+    int merged_vertex_num = 0;
+
+    void add(AlignmentPrimitiveType type, float length, float k0, float k1, vec2 &pos, float &heading) {
+        if (length <= 0.f) return;
+        AlignmentPrimitive p = { type, pos, heading, length, k0, k1 };
+        primitives.push_back(p);
+        start_distance.push_back(total_length);
+        total_length += length;
+        pos = p.get_end();
+        heading = p.get_heading(length);
+    }
+
+    // tangent length from the vertex to where the first clothoid starts, for deflection delta > 0
+    static float tangent_length(float radius, float spiral, float delta) {
+        float p = spiral * spiral / (24.f * radius) - std::pow(spiral, 4.f) / (2688.f * radius * radius * radius);
+        float k = 0.5f * spiral - spiral * spiral * spiral / (240.f * radius * radius);
+        return (radius + p) * std::tan(0.5f * delta) + k;
+    }
+
+    // transitions are shortened on small deflections so the curve is at most two clothoids
+    static float spiral_length(float radius, float spiral, float delta) {
+        return std::min(spiral, radius * delta);
+    }
+
+    // one fit at the given minimum radius, see fit
+    static HorizontalAlignment fit_once(const vector<vec3> &points, float min_radius, float max_radius, float spiral, float tolerance) {
+        HorizontalAlignment a;
+        if (points.size() < 2) return a;
+
+        vector<vec3> simplified = PathSimplifier::simplify(points, tolerance, FLT_MAX);
+        vector<vec2> v;
+        for (const vec3 &p : simplified)
+            if (v.empty() || glm::length(vec2(p) - v.back()) > 1e-7f) v.push_back(vec2(p));
+        if (v.size() < 2) return a;
+
+        /* tangent polygon, vertices are merged or dropped until every curve fits with at least min_radius */
+        auto deflection = [&](int i) {
+            vec2 d0 = glm::normalize(v[i] - v[i-1]), d1 = glm::normalize(v[i+1] - v[i]);
+            return std::atan2(d0.x * d1.y - d0.y * d1.x, dot(d0, d1));
+        };
+        // legs are shared with the neighbouring curves, the ones at the path ends are not
+        auto available = [&](int i) {
+            int n = (int)v.size();
+            return std::min(glm::length(v[i] - v[i-1]) * (i == 1 ? 1.f : .5f), glm::length(v[i+1] - v[i]) * (i + 2 == n ? 1.f : .5f));
+        };
+        auto overflow = [&](int i) {
+            float turn = std::fabs(deflection(i));
+            if (turn < CURVE_MIN_DEFLECTION) return 0.f;
+            return tangent_length(min_radius, spiral_length(min_radius, spiral, turn), turn) / available(i);
+        };
+        while (v.size() > 2) {
+            int worst = -1;
+            float worst_overflow = 1.f;
+            for (int i = 1; i + 1 < (int)v.size(); i++) {
+                float o = overflow(i);
+                if (o > worst_overflow) { worst_overflow = o; worst = i; }
+            }
+            if (worst < 0) break;
+            a.merged_vertex_num++;
+
+            // two bends the same way across a short leg become one bend where the outer legs meet
+            int n = (int)v.size();
+            bool short_prev = glm::length(v[worst] - v[worst-1]) < glm::length(v[worst+1] - v[worst]);
+            int i = short_prev ? worst - 1 : worst, j = i + 1;
+            if (i >= 1 && j + 1 < n && deflection(i) * deflection(j) > 0.f) {
+                vec2 p = v[i-1], dp = glm::normalize(v[i] - v[i-1]);
+                vec2 q = v[j+1], dq = glm::normalize(v[j] - v[j+1]);
+                float cross_pq = dp.x * dq.y - dp.y * dq.x;
+                if (std::fabs(cross_pq) > 1e-6f) {
+                    vec2 pq = q - p;
+                    float t = (pq.x * dq.y - pq.y * dq.x) / cross_pq;
+                    float u = (pq.x * dp.y - pq.y * dp.x) / cross_pq;
+                    if (t > 0.f && u > 0.f) {
+                        v[i] = p + dp * t;
+                        v.erase(v.begin() + j);
+                        continue;
+                    }
+                }
+            }
+            v.erase(v.begin() + worst);
+        }
+
+        int n = (int)v.size();
+        vec2 pos = v[0];
+        vec2 first_dir = glm::normalize(v[1] - v[0]);
+        float heading = std::atan2(first_dir.y, first_dir.x);
+        for (int i = 1; i + 1 < n; i++) {
+            vec2 d0 = glm::normalize(v[i] - v[i-1]);
+            float delta = deflection(i);
+            float turn = std::fabs(delta);
+            if (turn < CURVE_MIN_DEFLECTION) continue;
+
+            float room = available(i);
+            float radius = min_radius;
+            if (tangent_length(max_radius, spiral_length(max_radius, spiral, turn), turn) <= room) {
+                radius = max_radius;
+            }
+            else {
+                // tangent length grows with the radius, bisect in log space
+                float lo = std::log(min_radius), hi = std::log(max_radius);
+                for (int k = 0; k < CURVE_RADIUS_SEARCH_STEPS; k++) {
+                    float mid = 0.5f * (lo + hi);
+                    float r = std::exp(mid);
+                    if (tangent_length(r, spiral_length(r, spiral, turn), turn) > room) hi = mid;
+                    else lo = mid;
+                }
+                radius = std::max(min_radius, std::exp(lo));
+            }
+            a.min_radius_used = std::min(a.min_radius_used, radius);
+
+            float ls = spiral_length(radius, spiral, turn);
+            float tangent = tangent_length(radius, ls, turn);
+            float k = (delta > 0.f ? 1.f : -1.f) / radius;
+            float arc = std::max(0.f, radius * (turn - ls / radius));
+
+            // straight up to the start of the curve, measured from where the previous curve really ended
+            vec2 curve_start = v[i] - d0 * tangent;
+            a.add(PRIMITIVE_STRAIGHT, dot(curve_start - pos, d0), 0.f, 0.f, pos, heading);
+            a.add(PRIMITIVE_CLOTHOID, ls, 0.f, k, pos, heading);
+            a.add(PRIMITIVE_ARC, arc, k, k, pos, heading);
+            a.add(PRIMITIVE_CLOTHOID, ls, k, 0.f, pos, heading);
+        }
+        a.add(PRIMITIVE_STRAIGHT, dot(v[n-1] - pos, glm::normalize(v[n-1] - v[n-2])), 0.f, 0.f, pos, heading);
+        a.pin_end(v[n-1]);
+        return a;
+    }
+
+public:
+    HorizontalAlignment() {}
+
+    // Fits the polyline (terrain local space, only xy is used). The tangent polygon is the polyline simplified to
+    // tolerance, every interior vertex gets the widest curve up to max_radius that fits half of each adjacent leg.
+    // Bends too tight for min_radius are merged with a neighbouring bend or dropped, so the radius is never below it.
+    static HorizontalAlignment fit(const vector<vec3> &points, float min_radius, float max_radius, float spiral, float tolerance) {
+        HorizontalAlignment a;
+        float fit_min_radius = min_radius;
+        for (int attempt = 0; attempt < CURVE_PIN_REFIT_NUM; attempt++) {
+            a = fit_once(points, fit_min_radius, std::max(max_radius, fit_min_radius), spiral, tolerance);
+            if (a.min_radius_used >= min_radius) break;
+            fit_min_radius *= min_radius / a.min_radius_used;
+        }
+        return a;
+    }
+
+    // The curve series leave the end slightly off the last vertex. The last straight takes the error up, turned and
+    // stretched onto the target. Without one, or if it would turn by more than CURVE_PIN_MAX_KINK, a similarity
+    // transform about the start (small rotation and scale, primitives stay primitives) moves everything onto the
+    // target; when that shrinks the path the curves get tighter and fit refits with a raised minimum radius.
+    void pin_end(vec2 target) {
+        if (primitives.empty()) return;
+        AlignmentPrimitive &last = primitives.back();
+        if (last.type == PRIMITIVE_STRAIGHT) {
+            vec2 d = target - last.start;
+            float length = glm::length(d);
+            float kink = std::atan2(d.y, d.x) - last.heading;
+            kink = std::atan2(std::sin(kink), std::cos(kink));
+            if (length > 0.f && std::fabs(kink) <= CURVE_PIN_MAX_KINK) {
+                total_length += length - last.length;
+                last.length = length;
+                last.heading += kink;
+                return;
+            }
+        }
+
+        vec2 origin = primitives.front().start;
+        vec2 u = primitives.back().get_end() - origin, w = target - origin;
+        float u_len = glm::length(u), w_len = glm::length(w);
+        if (u_len <= 0.f || w_len <= 0.f) return;
+        float scale = w_len / u_len;
+        float angle = std::atan2(u.x * w.y - u.y * w.x, dot(u, w));
+        float c = std::cos(angle), s = std::sin(angle);
+        for (AlignmentPrimitive &p : primitives) {
+            vec2 r = p.start - origin;
+            p.start = origin + scale * vec2(c * r.x - s * r.y, s * r.x + c * r.y);
+            p.heading += angle;
+            p.length *= scale;
+            p.curvature_start /= scale;
+            p.curvature_end /= scale;
+        }
+        for (float &d : start_distance) d *= scale;
+        total_length *= scale;
+        if (min_radius_used != FLT_MAX) min_radius_used *= scale;
+    }
+
+    vec2 get_point_at_distance(float d) const {
+        if (primitives.empty()) return vec2(0.f);
+        int i = (int)(std::upper_bound(start_distance.begin(), start_distance.end(), d) - start_distance.begin()) - 1;
+        i = glm::clamp(i, 0, (int)primitives.size() - 1);
+        return primitives[i].get_point(d - start_distance[i]);
+    }
+
+    float get_curvature_at_distance(float d) const {
+        if (primitives.empty()) return 0.f;
+        int i = (int)(std::upper_bound(start_distance.begin(), start_distance.end(), d) - start_distance.begin()) - 1;
+        i = glm::clamp(i, 0, (int)primitives.size() - 1);
+        const AlignmentPrimitive &p = primitives[i];
+        return glm::mix(p.curvature_start, p.curvature_end, glm::clamp((d - start_distance[i]) / p.length, 0.f, 1.f));
+    }
+
+    // points every spacing (and at every primitive boundary), heights from the profile, else from the terrain if a source is given
+    vector<vec3> sample(float spacing, ElevationLineDrawer *height_source = nullptr, const VerticalProfile *profile = nullptr) const {
+        vector<vec3> out;
+        if (primitives.empty() || spacing <= 0.f) return out;
+        auto push = [&](vec2 p, float d) {
+            float z = profile ? profile->get_height_at_distance(d) : height_source ? height_source->get_height_at_local_pos(p.x, p.y) : 0.f;
+            out.push_back(vec3(p, z));
+        };
+        for (size_t i = 0; i < primitives.size(); i++) {
+            const AlignmentPrimitive &p = primitives[i];
+            int steps = std::max(1, (int)std::ceil(p.length / spacing));
+            for (int k = 0; k < steps; k++) push(p.get_point(p.length * k / steps), start_distance[i] + p.length * k / steps);
+        }
+        push(primitives.back().get_end(), total_length);
+        return out;
+    }
+
+    const vector<AlignmentPrimitive>& get_primitives() const { return primitives; }
+    int get_primitive_num() const { return (int)primitives.size(); }
+    float get_length() const { return total_length; }
+    float get_min_radius() const { return min_radius_used; }  // FLT_MAX for a straight path
+    int get_merged_vertex_num() const { return merged_vertex_num; }  // tangent polygon vertices given up for the minimum radius
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef PATHANALYTICS_H
+#define PATHANALYTICS_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+#include <iostream>
+#include "TerrainData.h"
+#include "TerrainFields.h"
+
+using namespace glm;
+using namespace std;
+
+#define PATH_ANALYTICS_LANES 8              // independent accumulators, lets the segment loop vectorise without fast-math
+#define PATH_ANALYTICS_MIN_SEGMENT 1e-6f    // [local units] shorter segments do not count towards max grade
+#define PATH_CURVATURE_BIN_NUM 8
+
+// bin i holds the length of track curved with a radius of at least this many metres (and less than bin i-1)
+const float PATH_CURVATURE_BIN_MIN_RADIUS[PATH_CURVATURE_BIN_NUM] = { 2000.f, 1000.f, 500.f, 300.f, 200.f, 100.f, 50.f, 0.f };
+
+struct PathMetrics {
+    int point_num = 0;
+    float horizontal_length = 0.f, length_3d = 0.f;             // [m]
+    float climb = 0.f, descent = 0.f;                           // [m]
+    float max_grade = 0.f, mean_grade = 0.f;                    // rise over run, mean weighted by horizontal length
+    float max_cross_slope = 0.f, mean_cross_slope = 0.f;        // terrain rise over run across the track, from the terrain fields
+    float curvature_histogram[PATH_CURVATURE_BIN_NUM] = {};     // fraction of length per radius bin
+    float blue_region_fraction[AREA_REGION_SLOT_NUM] = {};      // fraction of length per area data region
+    float green_region_fraction[AREA_REGION_SLOT_NUM] = {};
+};
+
+// Computes real world geometry metrics of committed or previewed path polylines (terrain local space)
+class PathAnalytics
+{
+private:
+    const TerrainData *terrain_data;
+    float metres_per_unit;
+
+    // region slot per area data pixel
+    vector<unsigned char> blue_slots, green_slots;
+    int area_width = 0, area_height = 0;
+
+    // scratch buffers reused between calls, the pass runs on every drag frame
+    vector<float> xs, ys, zs, segment_length;
+
+    const TerrainFields *fields = nullptr;
+
+public:
+    PathAnalytics(const TerrainData *terrain_data) : terrain_data(terrain_data) {
+        metres_per_unit = terrain_data->get_metres_per_local_unit();
+    }
+
+    // region slots from the RGB areas map the terrain painter already decoded, row 0 is local y = -0.5
+    void set_area_data(const unsigned char *areas_rgb, int width, int height) {
+        if (!areas_rgb || width <= 0 || height <= 0) {
+            std::cerr << "ERROR: No area data for path analytics." << std::endl;
+            area_width = area_height = 0;
+            return;
+        }
+        area_width = width;
+        area_height = height;
+        size_t pixel_num = (size_t)area_width * area_height;
+        blue_slots.resize(pixel_num);
+        green_slots.resize(pixel_num);
+        for (size_t i = 0; i < pixel_num; i++) {
+            green_slots[i] = (unsigned char)get_area_region_slot(areas_rgb[i*3+1]);
+            blue_slots[i] = (unsigned char)get_area_region_slot(areas_rgb[i*3+2]);
+        }
+    }
+
+    PathMetrics analyse(const vector<vec3> &points) {
+        PathMetrics m;
+        m.point_num = (int)points.size();
+        int n = (int)points.size();
+        if (n < 2) return m;
+
+        /* structure of arrays copy */
+        xs.resize(n); ys.resize(n); zs.resize(n); segment_length.resize(n-1);
+        for (int i = 0; i < n; i++) { xs[i] = points[i].x; ys[i] = points[i].y; zs[i] = points[i].z; }
+
+        /* segment pass: lengths, climb, grades */
+        float acc_h[PATH_ANALYTICS_LANES] = {}, acc_3d[PATH_ANALYTICS_LANES] = {};
+        float acc_climb[PATH_ANALYTICS_LANES] = {}, acc_descent[PATH_ANALYTICS_LANES] = {};
+        float acc_grade[PATH_ANALYTICS_LANES] = {};
+        int seg_num = n - 1;
+        int blocked_num = seg_num - seg_num % PATH_ANALYTICS_LANES;
+
+        auto segment = [&](int i, int lane) {
+            float dx = xs[i+1] - xs[i], dy = ys[i+1] - ys[i], dz = zs[i+1] - zs[i];
+            float h2 = dx*dx + dy*dy;
+            float h = std::sqrt(h2);
+            segment_length[i] = h;
+            acc_h[lane] += h;
+            acc_3d[lane] += std::sqrt(h2 + dz*dz);
+            acc_climb[lane] += std::max(dz, 0.f);
+            acc_descent[lane] += std::max(-dz, 0.f);
+            float grade = h > PATH_ANALYTICS_MIN_SEGMENT ? std::fabs(dz) / h : 0.f;
+            acc_grade[lane] = std::max(acc_grade[lane], grade);
+        };
+        for (int i = 0; i < blocked_num; i += PATH_ANALYTICS_LANES)
+            for (int lane = 0; lane < PATH_ANALYTICS_LANES; lane++) segment(i + lane, lane);
+        for (int i = blocked_num; i < seg_num; i++) segment(i, 0);
+
+        float length_h = 0.f;
+        for (int lane = 0; lane < PATH_ANALYTICS_LANES; lane++) {
+            length_h += acc_h[lane];
+            m.length_3d += acc_3d[lane];
+            m.climb += acc_climb[lane];
+            m.descent += acc_descent[lane];
+            m.max_grade = std::max(m.max_grade, acc_grade[lane]);
+        }
+        m.mean_grade = length_h > 0.f ? (m.climb + m.descent) / length_h : 0.f;
+        if (length_h <= 0.f) return m;
+
+        /* curvature histogram: turning angle per vertex spread over half of both neighbouring segments */
+        m.curvature_histogram[0] += 0.5f * (segment_length[0] + segment_length[seg_num-1]);
+        for (int i = 1; i < seg_num; i++) {
+            vec2 d0 = vec2(xs[i] - xs[i-1], ys[i] - ys[i-1]);
+            vec2 d1 = vec2(xs[i+1] - xs[i], ys[i+1] - ys[i]);
+            float weight = 0.5f * (segment_length[i-1] + segment_length[i]);
+            float angle = std::fabs(std::atan2(d0.x*d1.y - d0.y*d1.x, dot(d0, d1)));
+            float radius = angle > 0.f ? weight * metres_per_unit / angle : FLT_MAX;
+            m.curvature_histogram[get_curvature_bin(radius)] += weight;
+        }
+
+        /* area regions sampled at segment midpoints */
+        if (area_width > 0) {
+            for (int i = 0; i < seg_num; i++) {
+                size_t pixel = get_area_pixel(0.5f * (xs[i] + xs[i+1]), 0.5f * (ys[i] + ys[i+1]));
+                m.blue_region_fraction[blue_slots[pixel]] += segment_length[i];
+                m.green_region_fraction[green_slots[pixel]] += segment_length[i];
+            }
+        }
+
+        /* terrain slope across the track at segment midpoints */
+        if (fields && fields->is_computed()) {
+            float cross_sum = 0.f;
+            for (int i = 0; i < seg_num; i++) {
+                if (segment_length[i] <= PATH_ANALYTICS_MIN_SEGMENT) continue;
+                vec2 side = vec2(ys[i] - ys[i+1], xs[i+1] - xs[i]) / segment_length[i];
+                float cross = std::fabs(dot(fields->get_gradient_at_local_pos(0.5f * (xs[i] + xs[i+1]), 0.5f * (ys[i] + ys[i+1])), side));
+                m.max_cross_slope = std::max(m.max_cross_slope, cross);
+                cross_sum += cross * segment_length[i];
+            }
+            m.mean_cross_slope = cross_sum / length_h;
+        }
+
+        /* normalise and convert to metres */
+        float inv_length = 1.f / length_h;
+        for (float &f : m.curvature_histogram) f *= inv_length;
+        for (float &f : m.blue_region_fraction) f *= inv_length;
+        for (float &f : m.green_region_fraction) f *= inv_length;
+
+        m.horizontal_length = length_h * metres_per_unit;
+        m.length_3d *= metres_per_unit;
+        m.climb *= metres_per_unit;
+        m.descent *= metres_per_unit;
+        return m;
+    }
+
+    float get_metres_per_unit() const { return metres_per_unit; }
+    void set_terrain_fields(const TerrainFields *fields) { this->fields = fields; }
+
+private:
+    static int get_curvature_bin(float radius) {
+        for (int b = 0; b < PATH_CURVATURE_BIN_NUM; b++) {
+            if (radius >= PATH_CURVATURE_BIN_MIN_RADIUS[b]) return b;
+        }
+        return PATH_CURVATURE_BIN_NUM - 1;
+    }
+
+    size_t get_area_pixel(float x, float y) const {
+        int px = glm::clamp((int)((x + 0.5f) * area_width), 0, area_width - 1);
+        int py = glm::clamp((int)((y + 0.5f) * area_height), 0, area_height - 1);
+        return (size_t)py * area_width + px;
+    }
+};
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef PATHGRAPH_H
+#define PATHGRAPH_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+#define PATH_GRAPH_SLAB_SIZE 4  // track junctions rarely have more than 4 links, so one slab per node is typical
+#define DIJKSTRA_HEAP_ARITY 4
+
+/* ================================================ */
+/* DISJOINT SET (union-find) */
+
+// Keeps connected components of the path network, path compression + union by rank
+class DisjointSet
+{
+private:
+    vector<int> parent;
+    vector<unsigned char> rank;
+    int set_num = 0;
+
+public:
+    int add() {
+        parent.push_back((int)parent.size());
+        rank.push_back(0);
+        set_num++;
+        return (int)parent.size() - 1;
+    }
+
+    int find(int x) {
+        int root = x;
+        while (parent[root] != root) root = parent[root];
+        // compress the whole walked chain onto the root
+        while (parent[x] != root) {
+            int next = parent[x];
+            parent[x] = root;
+            x = next;
+        }
+        return root;
+    }
+
+    // returns the root of the merged set, or -1 if both were already in the same set
+    int unite(int a, int b) {
+        int ra = find(a), rb = find(b);
+        if (ra == rb) return -1;
+        if (rank[ra] < rank[rb]) std::swap(ra, rb);
+        parent[rb] = ra;
+        if (rank[ra] == rank[rb]) rank[ra]++;
+        set_num--;
+        return ra;
+    }
+
+    int get_set_num() const { return set_num; }
+    int size() const { return (int)parent.size(); }
+};
+
+/* ================================================ */
+/* PATH GRAPH (slab adjacency) */
+
+// fixed size block of half-edges, nodes chain slabs together when they outgrow one
+struct AdjacencySlab {
+    int count = 0;
+    int next_slab = -1;
+    int neighbour[PATH_GRAPH_SLAB_SIZE];
+    int edge[PATH_GRAPH_SLAB_SIZE];
+    float length[PATH_GRAPH_SLAB_SIZE];
+};
+
+// Undirected weighted graph over dense node indices, edges can be added at any time in O(1)
+class PathGraph
+{
+private:
+    vector<int> first_slab, last_slab;
+    vector<AdjacencySlab> slabs;
+    vector<int> edge_node_a, edge_node_b;
+    vector<float> edge_length;
+
+    void add_half_edge(int from, int to, int edge, float length) {
+        int s = last_slab[from];
+        if (s == -1 || slabs[s].count == PATH_GRAPH_SLAB_SIZE) {
+            slabs.push_back(AdjacencySlab());
+            int new_slab = (int)slabs.size() - 1;
+            if (s == -1) first_slab[from] = new_slab;
+            else slabs[s].next_slab = new_slab;
+            last_slab[from] = new_slab;
+            s = new_slab;
+        }
+        AdjacencySlab &slab = slabs[s];
+        slab.neighbour[slab.count] = to;
+        slab.edge[slab.count] = edge;
+        slab.length[slab.count] = length;
+        slab.count++;
+    }
+
+public:
+    int add_node() {
+        first_slab.push_back(-1);
+        last_slab.push_back(-1);
+        return (int)first_slab.size() - 1;
+    }
+
+    int add_edge(int a, int b, float length) {
+        int e = (int)edge_length.size();
+        edge_node_a.push_back(a);
+        edge_node_b.push_back(b);
+        edge_length.push_back(length);
+        add_half_edge(a, b, e, length);
+        if (a != b) add_half_edge(b, a, e, length);
+        return e;
+    }
+
+    // calls f(neighbour, edge, length) for every link leaving the node
+    template <typename F>
+    void for_each_neighbour(int node, F f) const {
+        for (int s = first_slab[node]; s != -1; s = slabs[s].next_slab) {
+            const AdjacencySlab &slab = slabs[s];
+            for (int i = 0; i < slab.count; i++) f(slab.neighbour[i], slab.edge[i], slab.length[i]);
+        }
+    }
+
+    int get_node_num() const { return (int)first_slab.size(); }
+    int get_edge_num() const { return (int)edge_length.size(); }
+    float get_edge_length(int e) const { return edge_length[e]; }
+    int get_edge_node_a(int e) const { return edge_node_a[e]; }
+    int get_edge_node_b(int e) const { return edge_node_b[e]; }
+};
+
+/* ================================================ */
+/* DIJKSTRA SEARCH */
+
+// Reusable Dijkstra working buffers. Arrays are only grown, never cleared - a search stamp marks
+// which entries belong to the current run, so a query only touches the nodes it actually visits.
+class DijkstraSearch
+{
+private:
+    vector<float> dist;
+    vector<int> parent_node, parent_edge;
+    vector<int> heap_pos; // -1 not queued, -2 settled, otherwise index in heap
+    vector<unsigned int> stamp;
+    unsigned int current_stamp = 0;
+    vector<int> heap;
+
+    bool touched(int v) const { return stamp[v] == current_stamp; }
+
+    void touch(int v) {
+        stamp[v] = current_stamp;
+        dist[v] = std::numeric_limits<float>::infinity();
+        parent_node[v] = -1;
+        parent_edge[v] = -1;
+        heap_pos[v] = -1;
+    }
+
+    void heap_place(int i, int v) { heap[i] = v; heap_pos[v] = i; }
+
+    void sift_up(int i) {
+        int v = heap[i];
+        while (i > 0) {
+            int p = (i - 1) / DIJKSTRA_HEAP_ARITY;
+            if (dist[heap[p]] <= dist[v]) break;
+            heap_place(i, heap[p]);
+            i = p;
+        }
+        heap_place(i, v);
+    }
+
+    void sift_down(int i) {
+        int v = heap[i];
+        int n = (int)heap.size();
+        while (true) {
+            int first = i * DIJKSTRA_HEAP_ARITY + 1;
+            if (first >= n) break;
+            int best = first;
+            int last = std::min(first + DIJKSTRA_HEAP_ARITY, n);
+            for (int c = first + 1; c < last; c++) if (dist[heap[c]] < dist[heap[best]]) best = c;
+            if (dist[heap[best]] >= dist[v]) break;
+            heap_place(i, heap[best]);
+            i = best;
+        }
+        heap_place(i, v);
+    }
+
+    int heap_pop() {
+        int top = heap[0];
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) { heap_place(0, last); sift_down(0); }
+        heap_pos[top] = -2;
+        return top;
+    }
+
+public:
+    // Runs from source until target is settled (or the whole component if target == -1).
+    // Optional masks exclude nodes / edges from the search, non-zero entries are skipped.
+    void run(const PathGraph &graph, int source, int target = -1,
+             const vector<unsigned char> *blocked_nodes = nullptr, const vector<unsigned char> *blocked_edges = nullptr) {
+        size_t n = (size_t)graph.get_node_num();
+        if (dist.size() < n) {
+            dist.resize(n); parent_node.resize(n); parent_edge.resize(n);
+            heap_pos.resize(n); stamp.resize(n, 0);
+        }
+        if (++current_stamp == 0) { // stamp wrapped around, start clean
+            std::fill(stamp.begin(), stamp.end(), 0);
+            current_stamp = 1;
+        }
+        heap.clear();
+        if (source < 0 || source >= (int)n) return;
+
+        touch(source);
+        dist[source] = 0.f;
+        heap.push_back(source); heap_pos[source] = 0;
+
+        while (!heap.empty()) {
+            int u = heap_pop();
+            if (u == target) break;
+            float du = dist[u];
+
+            graph.for_each_neighbour(u, [&](int v, int e, float length) {
+                if (blocked_edges && (*blocked_edges)[e]) return;
+                if (blocked_nodes && (*blocked_nodes)[v]) return;
+                if (!touched(v)) touch(v);
+                if (heap_pos[v] == -2) return;
+
+                float alt = du + length;
+                if (alt < dist[v]) {
+                    dist[v] = alt;
+                    parent_node[v] = u;
+                    parent_edge[v] = e;
+                    if (heap_pos[v] == -1) { heap.push_back(v); heap_pos[v] = (int)heap.size() - 1; }
+                    sift_up(heap_pos[v]);
+                }
+            });
+        }
+    }
+
+    bool reached(int v) const { return v >= 0 && v < (int)stamp.size() && touched(v) && dist[v] != std::numeric_limits<float>::infinity(); }
+    float get_distance(int v) const { return reached(v) ? dist[v] : std::numeric_limits<float>::infinity(); }
+
+    // node indices from the source to v (empty if v was not reached)
+    vector<int> get_node_path(int v) const {
+        vector<int> path;
+        if (!reached(v)) return path;
+        for (int at = v; at != -1; at = parent_node[at]) path.push_back(at);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    // edge indices from the source to v (empty if v was not reached or v is the source)
+    vector<int> get_edge_path(int v) const {
+        vector<int> path;
+        if (!reached(v)) return path;
+        for (int at = v; parent_edge[at] != -1; at = parent_node[at]) path.push_back(parent_edge[at]);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PATHSIMPLIFIER_H
+#define PATHSIMPLIFIER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <utility>
+#include "ElevationLineDrawer.h"
+
+using namespace glm;
+using namespace std;
+
+// Error bounded Douglas-Peucker simplification for terrain paths
+class PathSimplifier
+{
+public:
+    // Drops points while every removed point stays within horizontal_tolerance of the kept chord in xy and
+    // the chord height stays within height_tolerance of the terrain under it. Lines are drawn as straight
+    // segments between kept points, so the height check is what stops them cutting through ridges.
+    // Without a height source the original point heights are used as the terrain.
+    static vector<vec3> simplify(const vector<vec3> &points, float horizontal_tolerance, float height_tolerance,
+                                 ElevationLineDrawer *height_source = nullptr) {
+        int n = (int)points.size();
+        if (n < 3) return points;
+
+        vector<unsigned char> keep(n, 0);
+        keep[0] = keep[n-1] = 1;
+
+        vector<pair<int,int>> stack;
+        stack.push_back({ 0, n-1 });
+        while (!stack.empty()) {
+            int first = stack.back().first, last = stack.back().second;
+            stack.pop_back();
+            if (last - first < 2) continue;
+
+            vec2 a = vec2(points[first]), b = vec2(points[last]);
+            vec2 ab = b - a;
+            float ab_len_sq = dot(ab, ab);
+
+            // find the point with the largest error relative to its tolerance
+            float worst_error = 1.f;
+            int worst = -1;
+            for (int k = first + 1; k < last; k++) {
+                vec2 p = vec2(points[k]);
+                float t = ab_len_sq > 0.f ? glm::clamp(dot(p - a, ab) / ab_len_sq, 0.f, 1.f) : 0.f;
+                float horizontal_error = glm::length(p - (a + ab * t));
+                float chord_height = glm::mix(points[first].z, points[last].z, t);
+                float terrain_height = height_source ? height_source->get_height_at_local_pos(p.x, p.y) : points[k].z;
+                float height_error = abs(chord_height - terrain_height);
+
+                float error = glm::max(horizontal_error / horizontal_tolerance, height_error / height_tolerance);
+                if (error > worst_error) { worst_error = error; worst = k; }
+            }
+
+            if (worst != -1) {
+                keep[worst] = 1;
+                stack.push_back({ first, worst });
+                stack.push_back({ worst, last });
+            }
+        }
+
+        vector<vec3> simplified;
+        for (int i = 0; i < n; i++) if (keep[i]) simplified.push_back(points[i]);
+        return simplified;
+    }
+};
+
+#endif
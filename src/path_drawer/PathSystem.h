@@ -5,198 +5,313 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <vector>
-#include <queue>
-#include <unordered_map>
 #include <limits>
 #include <algorithm>
+#include <set>
 #include "Terrain.h"
 #include "InputHandler.h"
 #include "Line.h"
+#include "PathGraph.h"
+#include "settings/Parallel.h"
 
 using namespace glm;
 using namespace std;
 
 struct Destination {
     const char* name;
-    int id, path_system_id;
+    int id, index; // id is the interactable id, index is the dense slot inside the path system
     bool optional;
-    Destination *connected_one = nullptr;
-    Destination *connected_two = nullptr;
 };
 
 // Represents an Edge in the graph
 struct Node {
     int destination_id_a, destination_id_b;
     float link_length;
+    float max_grade = 0.f, mean_grade = 0.f;
+};
+
+// One route through the network, links index the edge list in creation order
+struct PathRoute {
+    vector<int> destination_ids;
+    vector<int> links;
+    float length = 0.f;
+    float max_grade = 0.f, mean_grade = 0.f; // mean is weighted by link length
+};
+
+// Per-thread search state, masks are kept all-zero between searches
+struct PathSearchWorker {
+    DijkstraSearch search;
+    vector<unsigned char> blocked_nodes, blocked_edges;
 };
 
 class PathSystem
 {
 private:
-    vector<Destination*> destinations;
-    vector<Node> path_system; // Functions as an edge list
-    int current_path_system_num = 0;
-
-    // Helper to build adjacency list for Dijkstra: map<node_id, vector<pair<neighbor_id, cost>>>
-    unordered_map<int, vector<pair<int, float>>> get_adjacency_list() {
-        unordered_map<int, vector<pair<int, float>>> adj;
-        for (const auto& edge : path_system) {
-            adj[edge.destination_id_a].push_back({ edge.destination_id_b, edge.link_length });
-            adj[edge.destination_id_b].push_back({ edge.destination_id_a, edge.link_length });
-        }
-        return adj;
+    vector<Destination> destinations;       // dense, indexed by Destination::index
+    vector<int> destination_index_by_id;    // interactable id -> dense index (-1 if not a destination)
+    vector<Node> path_system;               // Functions as an edge list, same order as graph edges
+
+    PathGraph graph;
+    DisjointSet path_systems;               // connected components, root index works as the path system id
+    vector<int> necessary_in_set;           // valid for set roots: number of non-optional destinations in the set
+    int necessary_destination_num = 0;
+    int first_necessary_index = -1;
+
+    DijkstraSearch search;
+    WorkerPool &pool;
+    vector<PathSearchWorker> workers;       // one per pool worker
+
+    // cached one-to-all distances, row per source index (empty = not computed or invalidated),
+    // columns past the row size belong to destinations created after it and are unreachable
+    vector<vector<float>> distance_rows;
+
+    int get_index(int id) const {
+        if (id < 0 || id >= (int)destination_index_by_id.size()) return -1;
+        return destination_index_by_id[id];
     }
 
 public:
-    PathSystem() {}
+    PathSystem(WorkerPool &pool = get_shared_worker_pool()) : pool(pool) {}
 
     bool is_traversable(int destination_id_a, int destination_id_b) {
-        Destination* a = get_destination(destination_id_a);
-        Destination* b = get_destination(destination_id_b);
-        return a && b && a->path_system_id == b->path_system_id;
+        int a = get_index(destination_id_a), b = get_index(destination_id_b);
+        return a != -1 && b != -1 && path_systems.find(a) == path_systems.find(b);
     }
 
     float find_traverse_length(int destination_id_a, int destination_id_b) {
-        // Run Dijkstra but only return distance
         if (!is_traversable(destination_id_a, destination_id_b)) return -1.0f;
-        
-        // Priority queue stores {cost, node_id}, ordered by lowest cost
-        priority_queue<pair<float, int>, vector<pair<float, int>>, greater<pair<float, int>>> pq;
-        unordered_map<int, float> dist;
-        auto adj = get_adjacency_list();
-
-        // Initialize distances
-        for (auto d : destinations) dist[d->id] = std::numeric_limits<float>::infinity();
-
-        dist[destination_id_a] = 0.0f;
-        pq.push({ 0.0f, destination_id_a });
-
-        while (!pq.empty()) {
-            float d = pq.top().first;
-            int u = pq.top().second;
-            pq.pop();
-
-            if (u == destination_id_b) return d; // Target found
-            if (d > dist[u]) continue;
-
-            for (auto& edge : adj[u]) {
-                int v = edge.first;
-                float weight = edge.second;
-                if (dist[u] + weight < dist[v]) {
-                    dist[v] = dist[u] + weight;
-                    pq.push({ dist[v], v });
-                }
-            }
-        }
-        return -1.0f; // Path not found (shouldn't happen if is_traversable is true)
+
+        // cached rows answer in O(1), the graph is undirected so either row works
+        int a = get_index(destination_id_a), b = get_index(destination_id_b);
+        if (!distance_rows[a].empty()) return get_row_distance(a, b);
+        if (!distance_rows[b].empty()) return get_row_distance(b, a);
+
+        // Run Dijkstra but only return distance
+        search.run(graph, a, b);
+        return search.reached(b) ? search.get_distance(b) : -1.0f;
     }
 
     vector<int> find_traverse_nodes(int destination_id_a, int destination_id_b) {
         if (!is_traversable(destination_id_a, destination_id_b)) return {};
 
-        priority_queue<pair<float, int>, vector<pair<float, int>>, greater<pair<float, int>>> pq;
-        unordered_map<int, float> dist;
-        unordered_map<int, int> prev; // To reconstruct path
-        auto adj = get_adjacency_list();
+        int b = get_index(destination_id_b);
+        search.run(graph, get_index(destination_id_a), b);
 
-        for (auto d : destinations) dist[d->id] = std::numeric_limits<float>::infinity();
+        vector<int> path = search.get_node_path(b);
+        for (int &p : path) p = destinations[p].id;
+        return path;
+    }
 
-        dist[destination_id_a] = 0.0f;
-        pq.push({ 0.0f, destination_id_a });
-        prev[destination_id_a] = -1;
+    bool are_necessary_destinations_connected() {
+        if (necessary_destination_num == 0) return true;
+        return necessary_in_set[path_systems.find(first_necessary_index)] == necessary_destination_num;
+    }
 
-        bool found = false;
+    bool are_all_destinations_connected() {
+        return path_systems.get_set_num() <= 1;
+    }
 
-        while (!pq.empty()) {
-            float d = pq.top().first;
-            int u = pq.top().second;
-            pq.pop();
+    void add_link(int id_1, int id_2, float length, float max_grade = 0.f, float mean_grade = 0.f) {
+        int a = get_index(id_1), b = get_index(id_2);
+        if (a == -1 || b == -1) return;
 
-            if (u == destination_id_b) {
-                found = true;
-                break;
-            }
+        path_system.push_back({ id_1, id_2, length, max_grade, mean_grade });
+        graph.add_edge(a, b, length);
+        invalidate_distance_rows(a, b, length);
+
+        // Merging Logic: union by rank, necessary destination counts follow the new root
+        int ra = path_systems.find(a), rb = path_systems.find(b);
+        int root = path_systems.unite(ra, rb);
+        if (root != -1) necessary_in_set[root] = necessary_in_set[ra] + necessary_in_set[rb];
+    }
 
-            if (d > dist[u]) continue;
+    void create_destination(int id, const char* name, bool optional = false) {
+        if (id < 0 || get_index(id) != -1) return;
 
-            for (auto& edge : adj[u]) {
-                int v = edge.first;
-                float weight = edge.second;
-                if (dist[u] + weight < dist[v]) {
-                    dist[v] = dist[u] + weight;
-                    prev[v] = u;
-                    pq.push({ dist[v], v });
-                }
-            }
+        int index = graph.add_node();
+        path_systems.add();
+        necessary_in_set.push_back(optional ? 0 : 1);
+        distance_rows.push_back({});
+        destinations.push_back({ name, id, index, optional });
+
+        if (id >= (int)destination_index_by_id.size()) destination_index_by_id.resize(id + 1, -1);
+        destination_index_by_id[id] = index;
+
+        if (!optional) {
+            necessary_destination_num++;
+            if (first_necessary_index == -1) first_necessary_index = index;
         }
+    }
+    void create_destination(Interactable* i, bool optional = false) {
+        create_destination(i->get_id(), i->name, optional);
+    }
 
-        vector<int> path;
-        if (found) {
-            for (int at = destination_id_b; at != -1; at = prev[at]) {
-                path.push_back(at);
-            }
-            std::reverse(path.begin(), path.end());
+    // pointer is valid until the next create_destination call
+    Destination* get_destination(int id) {
+        int index = get_index(id);
+        return index == -1 ? nullptr : &destinations[index];
+    }
+
+    /* Distance table */
+
+    // Fills the cached distance rows of all (or only the necessary) destinations, one Dijkstra per
+    // missing row run on the pool. After this find_traverse_length between them is a lookup.
+    void precompute_distances(bool necessary_only = true) {
+        vector<int> sources;
+        for (const Destination &d : destinations) {
+            if (necessary_only && d.optional) continue;
+            if (distance_rows[d.index].empty()) sources.push_back(d.index);
         }
-        return path;
+        if (sources.empty()) return;
+
+        prepare_workers();
+        pool.run((int)sources.size(), [&](int i, int worker) {
+            fill_distance_row(sources[i], workers[worker].search);
+        });
     }
 
-    bool are_necessary_destinations_connected() {
-        int current_path_system_id = -1;
-        for (auto x : destinations) {
-            if (!x->optional) {
-                if (current_path_system_id == -1) current_path_system_id = x->path_system_id;
-                else if (x->path_system_id != current_path_system_id) return false;
+    // Sum of travel lengths over every pair of (necessary) destinations, -1 if some pair is not connected
+    float get_total_travel_length(bool necessary_only = true) {
+        precompute_distances(necessary_only);
+
+        float total = 0.f;
+        for (size_t i = 0; i < destinations.size(); i++) {
+            if (necessary_only && destinations[i].optional) continue;
+            for (size_t j = i + 1; j < destinations.size(); j++) {
+                if (necessary_only && destinations[j].optional) continue;
+                float d = get_row_distance((int)i, (int)j);
+                if (d < 0.f) return -1.f;
+                total += d;
             }
         }
-        return true;
+        return total;
     }
 
-    bool are_all_destinations_connected() {
-        int current_path_system_id = -1;
-        for (auto x : destinations) {
-            if (current_path_system_id == -1) current_path_system_id = x->path_system_id;
-            else if (x->path_system_id != current_path_system_id) return false;
-        }
-        return true;
-    }
-
-    void add_link(int id_1, int id_2, float length) {
-        Destination* a = get_destination(id_1);
-        Destination* b = get_destination(id_2);
-
-        if (a && b) {
-            Node n = { a->id, b->id, length };
-            path_system.push_back(n);
-            
-            // Legacy pointer updates (Note: overwrites previous connections)
-            a->connected_two = b;
-            b->connected_one = a;
-
-            // Merging Logic: Propagate the smaller ID to the larger ID group
-            if (a->path_system_id != b->path_system_id) {
-                int old_id = glm::max(a->path_system_id, b->path_system_id);
-                int new_id = glm::min(a->path_system_id, b->path_system_id);
-                
-                for (auto* d : destinations) {
-                    if (d->path_system_id == old_id) {
-                        d->path_system_id = new_id;
+    /* Alternative routes */
+
+    // Up to k loopless routes from a to b ordered by length (Yen's algorithm). The spur searches of one
+    // iteration are independent, so they run on the pool with every worker reusing its own buffers.
+    vector<PathRoute> find_k_shortest(int destination_id_a, int destination_id_b, int k) {
+        vector<PathRoute> routes;
+        if (k <= 0 || !is_traversable(destination_id_a, destination_id_b)) return routes;
+        int a = get_index(destination_id_a), b = get_index(destination_id_b);
+
+        struct Candidate { vector<int> nodes, edges; float length = 0.f; };
+        vector<Candidate> accepted, candidates;
+        std::set<vector<int>> known_edge_paths;
+
+        search.run(graph, a, b);
+        accepted.push_back({ search.get_node_path(b), search.get_edge_path(b), search.get_distance(b) });
+        known_edge_paths.insert(accepted[0].edges);
+
+        while ((int)accepted.size() < k) {
+            const vector<int> &prev_nodes = accepted.back().nodes;
+            const vector<int> &prev_edges = accepted.back().edges;
+            int spur_num = (int)prev_nodes.size() - 1;
+
+            vector<float> root_length(spur_num + 1, 0.f);
+            for (int i = 0; i < spur_num; i++) root_length[i+1] = root_length[i] + graph.get_edge_length(prev_edges[i]);
+
+            vector<Candidate> spur_routes(spur_num);
+            vector<unsigned char> spur_found(spur_num, 0);
+            prepare_workers();
+
+            pool.run(spur_num, [&](int i, int worker) {
+                PathSearchWorker &w = workers[worker];
+
+                // block the next link of every accepted route sharing this root, and the root itself
+                auto set_blocks = [&](unsigned char value) {
+                    for (const Candidate &route : accepted) {
+                        if ((int)route.edges.size() > i && std::equal(prev_edges.begin(), prev_edges.begin() + i, route.edges.begin()))
+                            w.blocked_edges[route.edges[i]] = value;
                     }
+                    for (int r = 0; r < i; r++) w.blocked_nodes[prev_nodes[r]] = value;
+                };
+
+                set_blocks(1);
+                w.search.run(graph, prev_nodes[i], b, &w.blocked_nodes, &w.blocked_edges);
+                if (w.search.reached(b)) {
+                    Candidate &c = spur_routes[i];
+                    vector<int> spur_nodes = w.search.get_node_path(b);
+                    vector<int> spur_edges = w.search.get_edge_path(b);
+                    c.nodes.assign(prev_nodes.begin(), prev_nodes.begin() + i);
+                    c.nodes.insert(c.nodes.end(), spur_nodes.begin(), spur_nodes.end());
+                    c.edges.assign(prev_edges.begin(), prev_edges.begin() + i);
+                    c.edges.insert(c.edges.end(), spur_edges.begin(), spur_edges.end());
+                    c.length = root_length[i] + w.search.get_distance(b);
+                    spur_found[i] = 1;
                 }
+                set_blocks(0);
+            });
+
+            for (int i = 0; i < spur_num; i++) {
+                if (spur_found[i] && known_edge_paths.insert(spur_routes[i].edges).second)
+                    candidates.push_back(std::move(spur_routes[i]));
             }
+            if (candidates.empty()) break;
+
+            size_t best = 0;
+            for (size_t i = 1; i < candidates.size(); i++) if (candidates[i].length < candidates[best].length) best = i;
+            accepted.push_back(std::move(candidates[best]));
+            candidates[best] = std::move(candidates.back());
+            candidates.pop_back();
+        }
+
+        for (const Candidate &c : accepted) {
+            PathRoute route;
+            route.length = c.length;
+            route.links = c.edges;
+            for (int n : c.nodes) route.destination_ids.push_back(destinations[n].id);
+
+            float weighted_grade = 0.f;
+            for (int e : c.edges) {
+                route.max_grade = glm::max(route.max_grade, path_system[e].max_grade);
+                weighted_grade += path_system[e].mean_grade * path_system[e].link_length;
+            }
+            route.mean_grade = c.length > 0.f ? weighted_grade / c.length : 0.f;
+            routes.push_back(route);
         }
+        return routes;
     }
 
-    void create_destination(Interactable* i, bool optional = false) {
-        Destination* d = new Destination{ i->name, i->get_id(), current_path_system_num++, optional };
-        destinations.push_back(d);
+    int get_path_system_id(int id) {
+        int index = get_index(id);
+        return index == -1 ? -1 : path_systems.find(index);
     }
 
-    Destination* get_destination(int id) {
-        for (auto d : destinations) {
-            if (d->id == id) return d;
+private:
+    void prepare_workers() {
+        if ((int)workers.size() < pool.get_size()) workers.resize(pool.get_size());
+        for (PathSearchWorker &w : workers) {
+            if ((int)w.blocked_nodes.size() < graph.get_node_num()) w.blocked_nodes.resize(graph.get_node_num(), 0);
+            if ((int)w.blocked_edges.size() < graph.get_edge_num()) w.blocked_edges.resize(graph.get_edge_num(), 0);
+        }
+    }
+
+    void fill_distance_row(int source, DijkstraSearch &worker_search) {
+        worker_search.run(graph, source);
+        vector<float> row(destinations.size());
+        for (size_t v = 0; v < row.size(); v++) row[v] = worker_search.get_distance((int)v);
+        distance_rows[source] = std::move(row);
+    }
+
+    float get_row_distance(int source, int target) const {
+        const vector<float> &row = distance_rows[source];
+        if (target >= (int)row.size() || row[target] == std::numeric_limits<float>::infinity()) return -1.f;
+        return row[target];
+    }
+
+    // A new link a-b only changes the distances from s if it shortens the way to a or b,
+    // rows where neither end gets closer stay exact.
+    void invalidate_distance_rows(int a, int b, float length) {
+        const float inf = std::numeric_limits<float>::infinity();
+        for (vector<float> &row : distance_rows) {
+            if (row.empty()) continue;
+            float da = a < (int)row.size() ? row[a] : inf;
+            float db = b < (int)row.size() ? row[b] : inf;
+            if (da + length < db || db + length < da) row.clear();
         }
-        return nullptr;
     }
 };
 
-#endif
\ No newline at end of file
+#endif
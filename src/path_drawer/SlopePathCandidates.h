@@ -0,0 +1,152 @@
+#ifndef SLOPEPATHCANDIDATES_H
+#define SLOPEPATHCANDIDATES_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include "settings/Settings.h"
+#include "settings/Parallel.h"
+#include "ElevationLineDrawer.h"
+
+using namespace glm;
+using namespace std;
+
+struct SlopePathCandidate {
+    float direction_bias;   // [rad]
+    float slope_scale;      // multiplies the base slope, clamped to the max slope
+    float step_scale;
+};
+
+// most useful first, only the first get_candidate_num() are traced
+const SlopePathCandidate SLOPE_PATH_CANDIDATES[PATH_CANDIDATE_MAX_NUM] = {
+    { 0.f, 1.f, 1.f },
+    {  PATH_CANDIDATE_BIAS, 1.f, 1.f },
+    { -PATH_CANDIDATE_BIAS, 1.f, 1.f },
+    { 0.f, 1.f, .5f },
+    { 0.f, 1.f - PATH_CANDIDATE_SLOPE_JITTER, 1.f },
+    { 0.f, 1.f + PATH_CANDIDATE_SLOPE_JITTER, 1.f },
+    {  PATH_CANDIDATE_BIAS, 1.f, .5f },
+    { -PATH_CANDIDATE_BIAS, 1.f, .5f },
+    {  PATH_CANDIDATE_BIAS, 1.f - PATH_CANDIDATE_SLOPE_JITTER, 1.f },
+    { -PATH_CANDIDATE_BIAS, 1.f - PATH_CANDIDATE_SLOPE_JITTER, 1.f },
+    {  PATH_CANDIDATE_BIAS, 1.f + PATH_CANDIDATE_SLOPE_JITTER, 1.f },
+    { -PATH_CANDIDATE_BIAS, 1.f + PATH_CANDIDATE_SLOPE_JITTER, 1.f },
+};
+
+// Traces several slope path variants on a small worker pool and keeps the best scoring one. A candidate
+// stops once even its best possible score is worse than the score of one that already finished, so it
+// could not have won anyway; the winner does not depend on which candidate finished first.
+class SlopePathCandidates
+{
+private:
+    // running score of the prefixes of a raw path, the final path is one of its prefixes (cut nearest to the end)
+    struct ScoreBound {
+        size_t point_num = 1;
+        float length = 0.f, violation = 0.f;
+        float best_prefix = FLT_MAX;
+
+        // lowest score of any prefix traced so far or of any longer path, which at least pays for what is traced
+        float extend(const vector<vec3> &path, vec2 end, float max_slope) {
+            if (best_prefix == FLT_MAX) best_prefix = prefix_score(glm::length(end - vec2(path[0])), 0.f, 0.f);
+            for (; point_num < path.size(); point_num++) {
+                size_t i = point_num;
+                float h = glm::length(vec2(path[i]) - vec2(path[i-1]));
+                length += h;
+                if (h > 0.f) violation += std::max(std::fabs(path[i].z - path[i-1].z) / h - std::fabs(max_slope), 0.f) * h;
+                best_prefix = std::min(best_prefix, prefix_score(glm::length(end - vec2(path[i])), length, violation));
+            }
+            return std::min(best_prefix, PATH_CANDIDATE_LENGTH_WEIGHT * length + PATH_CANDIDATE_GRADE_WEIGHT * violation);
+        }
+    };
+
+    ElevationLineDrawer *height_source;
+    WorkerPool &pool;
+    int fixed_candidate_num;
+    vector<vector<vec3>> paths;
+    vector<float> scores;
+
+    // same reuse rule as ElevationLineDrawer: small cursor moves keep the last result
+    bool has_cache = false;
+    vec2 cached_start, cached_end;
+    float cached_slope = 0.f, cached_max_slope = 0.f, cached_step = 0.f;
+    vector<vec3> best_path;
+
+    static float prefix_score(float end_distance, float length, float violation) {
+        return PATH_CANDIDATE_END_WEIGHT * end_distance + PATH_CANDIDATE_LENGTH_WEIGHT * length + PATH_CANDIDATE_GRADE_WEIGHT * violation;
+    }
+
+    // scored on the raw path, in the same order as ScoreBound so a bound never exceeds the final score
+    static float score(const vector<vec3> &path, vec2 end, float max_slope) {
+        float length = 0.f, violation = 0.f;
+        for (size_t i = 1; i < path.size(); i++) {
+            float h = glm::length(vec2(path[i]) - vec2(path[i-1]));
+            length += h;
+            if (h > 0.f) violation += std::max(std::fabs(path[i].z - path[i-1].z) / h - std::fabs(max_slope), 0.f) * h;
+        }
+        return prefix_score(glm::length(end - vec2(path.back())), length, violation);
+    }
+
+public:
+    int last_best_candidate = -1;
+
+    // candidate_num 0 traces as many candidates as the pool runs at once, a fixed number keeps results
+    // independent of the core count (e.g. a solver per thread on a serial pool)
+    SlopePathCandidates(ElevationLineDrawer *height_source, WorkerPool &pool = get_shared_worker_pool(), int candidate_num = 0)
+        : height_source(height_source), pool(pool), fixed_candidate_num(candidate_num) {}
+
+    // replays: the candidate number of the recording machine, so results do not depend on the core count
+    void set_deterministic(int candidate_num) {
+        fixed_candidate_num = candidate_num;
+        has_cache = false;
+    }
+
+    // as many candidates as run at once, but always both branches
+    int get_candidate_num() const { return glm::clamp(fixed_candidate_num > 0 ? fixed_candidate_num : pool.get_size(), 2, PATH_CANDIDATE_MAX_NUM); }
+
+    // slope is the base slope of the path, max_slope limits jittered slopes and grade violations
+    const vector<vec3>& generate(vec3 start, vec2 end, float slope, float max_slope, float step, bool jitter_slope) {
+        if (has_cache &&
+            distance(vec2(start), cached_start) < 0.001f &&
+            distance(end, cached_end) < 0.05f &&
+            std::fabs(slope - cached_slope) < 0.001f &&
+            std::fabs(max_slope - cached_max_slope) < 0.001f &&
+            std::fabs(step - cached_step) < 0.001f) {
+            return best_path;
+        }
+
+        int candidate_num = get_candidate_num();
+        paths.resize(candidate_num);
+        scores.resize(candidate_num);
+        std::atomic<float> best_finished(FLT_MAX);
+
+        pool.run(candidate_num, [&](int c, int worker) {
+            const SlopePathCandidate &candidate = SLOPE_PATH_CANDIDATES[c];
+            float candidate_slope = jitter_slope ? glm::clamp(slope * candidate.slope_scale, -std::fabs(max_slope), std::fabs(max_slope)) : slope;
+            float candidate_step = step * candidate.step_scale;
+            ScoreBound bound;
+            auto cannot_win = [&](const vector<vec3> &path) { return bound.extend(path, end, max_slope) > best_finished.load(std::memory_order_relaxed); };
+            paths[c] = height_source->trace_slope_path(start, end, candidate_slope, candidate_step, candidate.direction_bias, cannot_win, false);
+            scores[c] = score(paths[c], end, max_slope);
+            float finished = best_finished.load(std::memory_order_relaxed);
+            while (scores[c] < finished && !best_finished.compare_exchange_weak(finished, scores[c], std::memory_order_relaxed)) {}
+        });
+
+        // a stopped candidate scores above a finished one, so the lowest score (first on ties) is always a full trace
+        last_best_candidate = 0;
+        for (int c = 1; c < candidate_num; c++) if (scores[c] < scores[last_best_candidate]) last_best_candidate = c;
+        best_path = paths[last_best_candidate];
+        ElevationLineDrawer::smooth_path(best_path);
+
+        has_cache = true;
+        cached_start = vec2(start); cached_end = end;
+        cached_slope = slope; cached_max_slope = max_slope; cached_step = step;
+        return best_path;
+    }
+
+    void clear_cache() { has_cache = false; }
+    void invalidate_region(vec2 box_min, vec2 box_max) { if (ElevationLineDrawer::path_touches_box(best_path, box_min, box_max)) has_cache = false; }
+};
+
+#endif
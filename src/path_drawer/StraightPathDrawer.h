@@ -23,6 +23,11 @@ public:
         : TerrainPathDrawer(terrain,w,0.f,debug_msg) { }   
 
     void recalculate_path (Line* line, vec3 start, vec3 end, float slope) override {
+        line->set_points(sample_straight_path(terrain->elevation_line_drawer, start, end));
+    }
+
+    // straight line in xy laid on the terrain, the end points keep their heights
+    static std::vector<vec3> sample_straight_path(ElevationLineDrawer &height_source, vec3 start, vec3 end) {
         float path_dist = glm::length(end-start);
         int point_num = (int)(path_dist / STRAIGHT_PATH_MINIMUM_TERRAIN_STEP) + 2;
         std::vector<vec3> segment; segment.resize(point_num);
@@ -31,10 +36,10 @@ public:
         for (int i=1; i<point_num-1; i++) {
             float t = (float)i / (point_num-1);
             segment[i] = vec3(end.x*t + start.x*(1.f-t), end.y*t + start.y*(1.f-t), 0.f);
-            segment[i].z = terrain->elevation_line_drawer.get_height_at_local_pos(segment[i].x,segment[i].y);
+            segment[i].z = height_source.get_height_at_local_pos(segment[i].x,segment[i].y);
         }
         segment[point_num-1] = end;
-        line->set_points(segment);
+        return segment;
     }
 };
 
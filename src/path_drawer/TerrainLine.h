@@ -11,8 +11,13 @@
 class TerrainLine : public Line
 {
     const TerrainData *td;
+    Texture *heightmap, *gradient_map;
+    bool follow_terrain;
 public:
-    TerrainLine(const TerrainData *td) : Line(PATH_THICKNESS), td(td) {
+    // the terrain's own heightmap and gradient textures keep lines on edited terrain, without them the heightmap is loaded again;
+    // lines not following the terrain are drawn at the height of their points
+    TerrainLine(const TerrainData *td, Texture *heightmap = nullptr, Texture *gradient_map = nullptr, bool follow_terrain = true) 
+        : Line(PATH_THICKNESS), td(td), heightmap(heightmap), gradient_map(gradient_map), follow_terrain(follow_terrain) {
     }
     
     void initialize_shader_properties() override {
@@ -24,8 +29,14 @@ public:
         shader->setVec3("min_steepness_colour", Colour::BLUE );
         shader->setBool("show_steepness", true);
         
-        shader->addTexture(new Texture(td->heightmap_path,true,true)); shader->setInt("heightmap", shader->get_last_loaded_tex_slot());
+        if (heightmap) shader->addTexture(heightmap);
+        else shader->addTexture(new Texture(td->heightmap_path,true,true), true);
+        shader->setInt("heightmap", shader->get_last_loaded_tex_slot());
+        shader->setBool("gradient_enabled", gradient_map != nullptr);
+        if (gradient_map) { shader->addTexture(gradient_map); shader->setInt("terrain_gradient", shader->get_last_loaded_tex_slot()); }
+        shader->setFloat("field_max_grade", FIELD_MAX_GRADE);
         shader->setFloat("heightmap_scale", td->vertical_scale);
+        shader->setBool("follow_terrain", follow_terrain);
         shader->setFloat("steepness_scale", STEEPNESS_SCALE);
         shader->setInt("heightmap_resolution_x", td->resolution_x);
         shader->setInt("heightmap_resolution_y", td->resolution_y);
@@ -35,7 +46,7 @@ public:
 
         shader->setFloat("max_steepness_value", 1.f);
 
-        set_shader(shader);
+        set_owned_shader(shader);
     }
 };
 
@@ -8,6 +8,10 @@
 #include "Terrain.h"
 #include "InputHandler.h"
 #include "TerrainLine.h"
+#include "SceneArena.h"
+#include "PathSimplifier.h"
+#include "HorizontalAlignment.h"
+#include "VerticalProfile.h"
 
 using namespace glm;
 using namespace std;
@@ -23,17 +27,20 @@ public:
 
     TerrainLine *current_line;
     TerrainLine *set_line;
+    // committed paths are kept as primitives, polylines are evaluated from them for rendering and metrics
+    vector<HorizontalAlignment> committed_alignments;
+    vector<VerticalProfile> committed_profiles;    // track height along each alignment
 
     TerrainPathDrawer (Terrain *terrain, World *w, float slope, bool debug_msg = false) 
         : terrain(terrain), debug_msg(debug_msg), slope(slope) {
         
-        current_line = new TerrainLine(terrain->terrain_data);
+        current_line = get_scene_arena().create<TerrainLine>(terrain->terrain_data, &terrain->heightmap_texture, terrain->gradient_texture);
         //current_line->set_colour( PATH_COLOUR );
         current_line->set_parent(terrain->terrain_obj);
         //current_line->move(CONTOUR_LINE_HEGHT_OFFSET);
         w->place(current_line);
 
-        set_line = new TerrainLine(terrain->terrain_data);
+        set_line = get_scene_arena().create<TerrainLine>(terrain->terrain_data, &terrain->heightmap_texture, terrain->gradient_texture, false);
         //set_line->set_colour( PATH_COLOUR );
         set_line->set_parent(terrain->terrain_obj);
         //set_line->move(CONTOUR_LINE_HEGHT_OFFSET);
@@ -69,12 +76,27 @@ public:
 
         if (debug_msg) std::cout << (current_line->get_point_num() > 1 ? "Path set." : "Path empty") << std::endl;
 
-        set_line->add_points ( current_line->get_points() );
+        // solver output becomes straights, clothoids and arcs ending on both handles, its heights a profile along them
+        float metres_per_unit = terrain->terrain_data->get_metres_per_local_unit();
+        const vector<vec3> solved = current_line->get_points();
+        committed_alignments.push_back(HorizontalAlignment::fit(solved, CURVE_MIN_RADIUS / metres_per_unit,
+            CURVE_MAX_RADIUS / metres_per_unit, CURVE_SPIRAL_LENGTH / metres_per_unit, CURVE_FIT_TOLERANCE / metres_per_unit));
+        const HorizontalAlignment &alignment = committed_alignments.back();
+        committed_profiles.push_back(VerticalProfile::fit_to_length(solved, alignment.get_length(), PATH_SIMPLIFY_HEIGHT_TOLERANCE));
+        vector<vec3> drawn = get_render_points((int)committed_alignments.size() - 1);
+        if (debug_msg) std::cout << "Path fitted from " << solved.size() << " points to " << alignment.get_primitive_num() << " primitives ("
+                                 << alignment.get_merged_vertex_num() << " bends merged for the minimum radius) and " << committed_profiles.back().get_vertex_num()
+                                 << " profile vertices, drawn with " << drawn.size() << " points." << std::endl;
+
+        set_line->add_points(drawn);
         current_line->clear_points();
     }
 
     virtual void recalculate_path(Line* line, vec3 start, vec3 end, float slope_value=0.f) = 0;
 
+    // terrain heights changed inside the local space box, drawer owned caches crossing it are dropped
+    virtual void invalidate_region(vec2 box_min, vec2 box_max) {}
+
     void reset() {
         if (drawing_path) current_line->clear_points();
         drawing_path = false;
@@ -82,6 +104,8 @@ public:
     void clear_path() {
         current_line->clear_points();
         set_line->clear_points();
+        committed_alignments.clear();
+        committed_profiles.clear();
     }
     
     bool is_drawing_path() {
@@ -92,11 +116,37 @@ public:
         return current_line->get_last_point();
     }
 
+    int get_committed_path_num() const { return (int)committed_alignments.size(); }
+
+    // committed path i evaluated every spacing [local units], z is the track height
+    vector<vec3> sample_committed_path(int i, float spacing) const {
+        return committed_alignments[i].sample(spacing, nullptr, &committed_profiles[i]);
+    }
+    vector<vec3> get_last_committed_path() const {
+        if (committed_alignments.empty()) return vector<vec3>();
+        return sample_committed_path((int)committed_alignments.size() - 1, CURVE_SAMPLE_SPACING / terrain->terrain_data->get_metres_per_local_unit());
+    }
+    const vector<HorizontalAlignment>& get_committed_alignments() const { return committed_alignments; }
+    const vector<VerticalProfile>& get_committed_profiles() const { return committed_profiles; }
+
+    // new track heights for committed path i, e.g. a designed profile
+    void set_committed_profile(int i, const VerticalProfile &profile) {
+        committed_profiles[i] = profile;
+        set_line->clear_points();
+        for (int k = 0; k < (int)committed_alignments.size(); k++) set_line->add_points(get_render_points(k));
+    }
+
+    // committed path i simplified to what is needed to follow its track heights when drawn
+    vector<vec3> get_render_points(int i) const {
+        return PathSimplifier::simplify(sample_committed_path(i, CURVE_SAMPLE_SPACING / terrain->terrain_data->get_metres_per_local_unit()),
+            PATH_SIMPLIFY_HORIZONTAL_TOLERANCE, PATH_SIMPLIFY_HEIGHT_TOLERANCE);
+    }
+
     void set_slope(float slope) {
         this->slope = slope;
     }
 
-    ~TerrainPathDrawer() { clear_path();  }
+    virtual ~TerrainPathDrawer() { clear_path();  }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,384 @@
+#ifndef TRACKSEGMENTTREE_H
+#define TRACKSEGMENTTREE_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+
+using namespace glm;
+using namespace std;
+
+#define TRACK_TREE_LEAF_MARGIN 1e-5f    // [local units] leaf boxes are padded so axis aligned segments still have area
+
+struct TrackHit {
+    int segment = -1;                   // index in the tree, -1 if nothing was found
+    int path_id = -1, path_segment = -1;// segment [path_segment, path_segment+1] of the committed path
+    float t = 0.f;                      // position along the segment
+    float distance = FLT_MAX;           // horizontal distance to the query point
+    vec3 point = vec3(0.f);             // closest point on the track
+};
+
+struct TrackCrossing {
+    int segment = -1;
+    int path_id = -1, path_segment = -1;
+    int candidate_segment = -1;         // segment of the queried path
+    float t_track = 0.f, t_candidate = 0.f;
+    vec3 point = vec3(0.f);             // crossing point at track height
+    float height_difference = 0.f;      // candidate height minus track height, near zero for a level crossing
+};
+
+// Dynamic AABB tree over the horizontal (xy) extent of all committed track segments.
+// Paths are inserted whole: their segments are built into a balanced subtree which is then
+// linked into the tree with the usual perimeter cost descent, ancestors are refit on the way up.
+// Removing a path unlinks its leaves one by one, each sibling takes its parent's place and the
+// ancestors are refit; freed nodes and segment slots are reused by later inserts.
+class TrackSegmentTree
+{
+private:
+    struct TreeNode {
+        vec2 min_corner, max_corner;
+        int parent = -1, left = -1, right = -1;
+        int segment = -1;               // leaf if >= 0
+    };
+
+    vector<TreeNode> nodes;
+    int root = -1;
+    vector<int> free_nodes;
+
+    // segment storage, indexed by segment, removed segments have path id -1
+    vector<vec3> segment_a, segment_b;
+    vector<int> segment_path_id, segment_path_index;
+    vector<int> segment_leaf;
+    vector<int> free_segments;
+
+    // scratch reused between queries, queries run every drag frame
+    vector<int> stack;
+    vector<int> build_order;
+
+    static float perimeter(vec2 mn, vec2 mx) { return 2.f * ((mx.x - mn.x) + (mx.y - mn.y)); }
+
+    static float box_distance_sqr(const TreeNode &n, vec2 p) {
+        float dx = std::max(std::max(n.min_corner.x - p.x, 0.f), p.x - n.max_corner.x);
+        float dy = std::max(std::max(n.min_corner.y - p.y, 0.f), p.y - n.max_corner.y);
+        return dx*dx + dy*dy;
+    }
+
+    static bool boxes_overlap(const TreeNode &n, vec2 mn, vec2 mx) {
+        return n.min_corner.x <= mx.x && n.max_corner.x >= mn.x && n.min_corner.y <= mx.y && n.max_corner.y >= mn.y;
+    }
+
+    int allocate_node() {
+        if (!free_nodes.empty()) {
+            int n = free_nodes.back();
+            free_nodes.pop_back();
+            nodes[n] = TreeNode();
+            return n;
+        }
+        nodes.push_back(TreeNode());
+        return (int)nodes.size() - 1;
+    }
+
+    int add_segment(vec3 a, vec3 b, int path_id, int path_index) {
+        if (!free_segments.empty()) {
+            int s = free_segments.back();
+            free_segments.pop_back();
+            segment_a[s] = a; segment_b[s] = b;
+            segment_path_id[s] = path_id; segment_path_index[s] = path_index;
+            return s;
+        }
+        segment_a.push_back(a); segment_b.push_back(b);
+        segment_path_id.push_back(path_id); segment_path_index.push_back(path_index);
+        segment_leaf.push_back(-1);
+        return (int)segment_a.size() - 1;
+    }
+
+    // the sibling of the leaf takes the place of their parent
+    void remove_leaf(int leaf) {
+        free_nodes.push_back(leaf);
+        if (leaf == root) { root = -1; return; }
+
+        int parent = nodes[leaf].parent, grand_parent = nodes[parent].parent;
+        int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+        free_nodes.push_back(parent);
+        nodes[sibling].parent = grand_parent;
+        if (grand_parent == -1) { root = sibling; return; }
+        if (nodes[grand_parent].left == parent) nodes[grand_parent].left = sibling;
+        else nodes[grand_parent].right = sibling;
+
+        // refit
+        for (int n = grand_parent; n != -1; n = nodes[n].parent) fit_to_children(n);
+    }
+
+    void fit_to_children(int n) {
+        TreeNode &node = nodes[n];
+        node.min_corner = glm::min(nodes[node.left].min_corner, nodes[node.right].min_corner);
+        node.max_corner = glm::max(nodes[node.left].max_corner, nodes[node.right].max_corner);
+    }
+
+    // top down median split over build_order[begin, end)
+    int build_subtree(int begin, int end) {
+        if (end - begin == 1) {
+            int s = build_order[begin];
+            int n = allocate_node();
+            nodes[n].segment = s;
+            segment_leaf[s] = n;
+            nodes[n].min_corner = glm::min(vec2(segment_a[s]), vec2(segment_b[s])) - vec2(TRACK_TREE_LEAF_MARGIN);
+            nodes[n].max_corner = glm::max(vec2(segment_a[s]), vec2(segment_b[s])) + vec2(TRACK_TREE_LEAF_MARGIN);
+            return n;
+        }
+
+        vec2 mn(FLT_MAX), mx(-FLT_MAX);
+        for (int i = begin; i < end; i++) {
+            vec2 c = get_segment_centre(build_order[i]);
+            mn = glm::min(mn, c);
+            mx = glm::max(mx, c);
+        }
+        int axis = (mx.x - mn.x) >= (mx.y - mn.y) ? 0 : 1;
+        int mid = (begin + end) / 2;
+        std::nth_element(build_order.begin() + begin, build_order.begin() + mid, build_order.begin() + end,
+            [&](int a, int b) { return get_segment_centre(a)[axis] < get_segment_centre(b)[axis]; });
+
+        int left = build_subtree(begin, mid);
+        int right = build_subtree(mid, end);
+        int n = allocate_node();
+        nodes[n].left = left;
+        nodes[n].right = right;
+        nodes[left].parent = n;
+        nodes[right].parent = n;
+        fit_to_children(n);
+        return n;
+    }
+
+    // links a built subtree next to the sibling that grows the total perimeter the least
+    void insert_subtree(int subtree) {
+        if (root == -1) { root = subtree; nodes[root].parent = -1; return; }
+
+        vec2 mn = nodes[subtree].min_corner, mx = nodes[subtree].max_corner;
+        int sibling = root;
+        while (nodes[sibling].segment < 0) {
+            const TreeNode &node = nodes[sibling];
+            float node_perimeter = perimeter(node.min_corner, node.max_corner);
+            float combined_perimeter = perimeter(glm::min(node.min_corner, mn), glm::max(node.max_corner, mx));
+            float cost_here = 2.f * combined_perimeter;
+            float inherited = 2.f * (combined_perimeter - node_perimeter);
+
+            auto descend_cost = [&](int child) {
+                const TreeNode &c = nodes[child];
+                float grown = perimeter(glm::min(c.min_corner, mn), glm::max(c.max_corner, mx));
+                if (c.segment >= 0) return grown + inherited;
+                return grown - perimeter(c.min_corner, c.max_corner) + inherited;
+            };
+            float cost_left = descend_cost(node.left), cost_right = descend_cost(node.right);
+            if (cost_here < cost_left && cost_here < cost_right) break;
+            sibling = cost_left < cost_right ? node.left : node.right;
+        }
+
+        int old_parent = nodes[sibling].parent;
+        int new_parent = allocate_node();
+        nodes[new_parent].parent = old_parent;
+        nodes[new_parent].left = sibling;
+        nodes[new_parent].right = subtree;
+        nodes[sibling].parent = new_parent;
+        nodes[subtree].parent = new_parent;
+        if (old_parent == -1) root = new_parent;
+        else if (nodes[old_parent].left == sibling) nodes[old_parent].left = new_parent;
+        else nodes[old_parent].right = new_parent;
+
+        // refit
+        for (int n = new_parent; n != -1; n = nodes[n].parent) fit_to_children(n);
+    }
+
+    vec2 get_segment_centre(int s) const { return 0.5f * (vec2(segment_a[s]) + vec2(segment_b[s])); }
+
+    // closest point parameter on segment s to p (horizontal)
+    float closest_t(int s, vec2 p) const {
+        vec2 a = vec2(segment_a[s]), ab = vec2(segment_b[s]) - a;
+        float len_sqr = dot(ab, ab);
+        return len_sqr > 0.f ? glm::clamp(dot(p - a, ab) / len_sqr, 0.f, 1.f) : 0.f;
+    }
+
+    // proper or touching intersection of two horizontal segments, parameters along both
+    static bool intersect_segments(vec2 p0, vec2 p1, vec2 q0, vec2 q1, float &t, float &u) {
+        vec2 r = p1 - p0, s = q1 - q0;
+        float denom = r.x*s.y - r.y*s.x;
+        if (denom == 0.f) return false; // parallel or collinear, overlapping track is not a crossing
+        vec2 qp = q0 - p0;
+        t = (qp.x*s.y - qp.y*s.x) / denom;
+        u = (qp.x*r.y - qp.y*r.x) / denom;
+        return t >= 0.f && t <= 1.f && u >= 0.f && u <= 1.f;
+    }
+
+public:
+    // adds every segment of a committed path, returns the number of segments added
+    int insert_path(const vector<vec3> &points, int path_id) {
+        if (points.size() < 2) return 0;
+        build_order.clear();
+        for (size_t i = 0; i + 1 < points.size(); i++) build_order.push_back(add_segment(points[i], points[i+1], path_id, (int)i));
+        insert_subtree(build_subtree(0, (int)build_order.size()));
+        return (int)build_order.size();
+    }
+
+    // drops every segment of a path (undone or replaced track), returns the number removed
+    int remove_path(int path_id) {
+        int removed = 0;
+        for (int s = 0; s < (int)segment_path_id.size(); s++) {
+            if (segment_path_id[s] != path_id) continue;
+            remove_leaf(segment_leaf[s]);
+            segment_path_id[s] = -1;
+            segment_leaf[s] = -1;
+            free_segments.push_back(s);
+            removed++;
+        }
+        return removed;
+    }
+
+    // new geometry for a committed path, e.g. after the terrain under it was edited
+    int update_path(const vector<vec3> &points, int path_id) {
+        remove_path(path_id);
+        return insert_path(points, path_id);
+    }
+
+    void clear() {
+        nodes.clear();
+        free_nodes.clear();
+        segment_a.clear(); segment_b.clear();
+        segment_path_id.clear(); segment_path_index.clear();
+        segment_leaf.clear();
+        free_segments.clear();
+        root = -1;
+    }
+
+    // nearest track within max_distance of p, hit.segment is -1 if there is none
+    TrackHit find_nearest(vec2 p, float max_distance = FLT_MAX) {
+        TrackHit hit;
+        if (root == -1) return hit;
+        float best_sqr = max_distance == FLT_MAX ? FLT_MAX : max_distance * max_distance;
+
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int n = stack.back(); stack.pop_back();
+            const TreeNode &node = nodes[n];
+            if (box_distance_sqr(node, p) > best_sqr) continue;
+
+            if (node.segment >= 0) {
+                int s = node.segment;
+                float t = closest_t(s, p);
+                vec3 q = glm::mix(segment_a[s], segment_b[s], t);
+                vec2 d = vec2(q) - p;
+                float dist_sqr = dot(d, d);
+                if (dist_sqr <= best_sqr) {
+                    best_sqr = dist_sqr;
+                    hit.segment = s; hit.t = t; hit.point = q;
+                }
+                continue;
+            }
+            // nearer child last so it is popped first and tightens the bound early
+            float dl = box_distance_sqr(nodes[node.left], p), dr = box_distance_sqr(nodes[node.right], p);
+            if (dl < dr) { stack.push_back(node.right); stack.push_back(node.left); }
+            else { stack.push_back(node.left); stack.push_back(node.right); }
+        }
+
+        if (hit.segment >= 0) {
+            hit.path_id = segment_path_id[hit.segment];
+            hit.path_segment = segment_path_index[hit.segment];
+            hit.distance = std::sqrt(best_sqr);
+        }
+        return hit;
+    }
+
+    // segments passing within radius of p
+    void query_radius(vec2 p, float radius, vector<int> &out) {
+        out.clear();
+        if (root == -1) return;
+        float radius_sqr = radius * radius;
+
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const TreeNode &node = nodes[stack.back()]; stack.pop_back();
+            if (box_distance_sqr(node, p) > radius_sqr) continue;
+            if (node.segment >= 0) {
+                vec2 d = vec2(glm::mix(segment_a[node.segment], segment_b[node.segment], closest_t(node.segment, p))) - p;
+                if (dot(d, d) <= radius_sqr) out.push_back(node.segment);
+                continue;
+            }
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+
+    // appends crossings of the segment a-b with committed track, returns the number found
+    int find_crossings(vec3 a, vec3 b, vector<TrackCrossing> &out, int candidate_segment = 0) {
+        if (root == -1) return 0;
+        vec2 a2 = vec2(a), b2 = vec2(b);
+        vec2 mn = glm::min(a2, b2), mx = glm::max(a2, b2);
+        int found = 0;
+
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const TreeNode &node = nodes[stack.back()]; stack.pop_back();
+            if (!boxes_overlap(node, mn, mx)) continue;
+            if (node.segment < 0) {
+                stack.push_back(node.left);
+                stack.push_back(node.right);
+                continue;
+            }
+
+            int s = node.segment;
+            float t, u;
+            if (!intersect_segments(a2, b2, vec2(segment_a[s]), vec2(segment_b[s]), t, u)) continue;
+            TrackCrossing c;
+            c.segment = s;
+            c.path_id = segment_path_id[s];
+            c.path_segment = segment_path_index[s];
+            c.candidate_segment = candidate_segment;
+            c.t_candidate = t;
+            c.t_track = u;
+            c.point = glm::mix(segment_a[s], segment_b[s], u);
+            c.height_difference = glm::mix(a.z, b.z, t) - c.point.z;
+            out.push_back(c);
+            found++;
+        }
+        return found;
+    }
+
+    // batched crossing test for a whole candidate path. Crossings closer than end_ignore_radius to
+    // either end of the candidate are skipped, paths starting or ending on existing track touch it there.
+    int find_path_crossings(const vector<vec3> &points, vector<TrackCrossing> &out, float end_ignore_radius = 0.f) {
+        out.clear();
+        if (root == -1 || points.size() < 2) return 0;
+
+        // whole path misses all track
+        vec2 mn(FLT_MAX), mx(-FLT_MAX);
+        for (const vec3 &p : points) { mn = glm::min(mn, vec2(p)); mx = glm::max(mx, vec2(p)); }
+        if (!boxes_overlap(nodes[root], mn, mx)) return 0;
+
+        vec2 start = vec2(points.front()), end = vec2(points.back());
+        float ignore_sqr = end_ignore_radius * end_ignore_radius;
+        for (size_t i = 0; i + 1 < points.size(); i++) {
+            size_t first = out.size();
+            find_crossings(points[i], points[i+1], out, (int)i);
+            if (ignore_sqr <= 0.f) continue;
+            // drop crossings at the path ends
+            size_t keep = first;
+            for (size_t c = first; c < out.size(); c++) {
+                vec2 d0 = vec2(out[c].point) - start, d1 = vec2(out[c].point) - end;
+                if (dot(d0, d0) > ignore_sqr && dot(d1, d1) > ignore_sqr) out[keep++] = out[c];
+            }
+            out.resize(keep);
+        }
+        return (int)out.size();
+    }
+
+    int get_segment_num() const { return (int)(segment_a.size() - free_segments.size()); }
+    int get_segment_slot_num() const { return (int)segment_a.size(); }   // valid segment indices, removed ones included
+    vec3 get_segment_start(int s) const { return segment_a[s]; }
+    vec3 get_segment_end(int s) const { return segment_b[s]; }
+    int get_segment_path_id(int s) const { return segment_path_id[s]; }
+    int get_segment_path_index(int s) const { return segment_path_index[s]; }
+};
+
+#endif
@@ -0,0 +1,277 @@
+#ifndef VERTICALALIGNMENT_H
+#define VERTICALALIGNMENT_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "settings/Settings.h"
+#include "ArcLengthPath.h"
+#include "VerticalProfile.h"
+#include "ElevationLineDrawer.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+enum AlignmentSectionType {
+    ALIGNMENT_AT_GRADE, ALIGNMENT_BRIDGE, ALIGNMENT_TUNNEL
+};
+
+struct AlignmentSection {
+    AlignmentSectionType type;
+    float start_distance, end_distance; // [m] along the path
+};
+
+struct AlignmentResult {
+    vector<vec3> points;                // input points with the designed track height as z
+    vector<float> station_heights;      // [m] designed height every ALIGNMENT_STATION_SPACING
+    vector<float> station_ground;       // [m]
+    vector<AlignmentSection> sections;
+    float station_spacing = 0.f;        // [m]
+    float cost = 0.f;
+    bool feasible = false;
+    bool end_pinned = false;            // false if the end handle is out of reach, the profile then ends where it fits best
+};
+
+struct AlignmentLattice {
+    float dh = 0.f;                     // [m] height step
+    int k_max = 0;                      // grade limit in height steps per station
+    int k_change = 0;                   // grade change limit in grade steps per station
+};
+
+// Chooses track heights along a fixed horizontal path. Dynamic programming over a height lattice
+// per station, the state also holds the last grade (in lattice steps) so both |grade| <= max_grade
+// and the grade change per metre can be enforced exactly on the lattice. Heights are searched in a
+// band around a grade limited reference profile, first on a coarse lattice and then finely around its result.
+// Deviation costs are squared and weighted separately for cut and fill.
+class VerticalAlignment
+{
+private:
+    ElevationLineDrawer *height_source;
+    float metres_per_unit;
+
+    // reused between calls
+    vector<float> cost, next_cost;
+    vector<signed char> parent_grade;  // per station and state, grade index of the previous state
+    vector<int> band_low;              // first lattice level of the band per station
+
+    float deviation_cost(float height, float ground) const {
+        float depth = ground - height;  // positive: track below ground, cut
+        return (depth > 0.f ? ALIGNMENT_CUT_WEIGHT : ALIGNMENT_FILL_WEIGHT) * depth * depth;
+    }
+
+    // [m] ground height at stations spread evenly along the path
+    vector<float> sample_ground(const ArcLengthPath &path, int station_num) const {
+        vector<float> ground(station_num);
+        for (int i = 0; i < station_num; i++) {
+            vec3 p = path.get_point_at_distance(path.get_length() * i / (station_num - 1));
+            float z = height_source ? height_source->get_height_at_local_pos(p.x, p.y) : p.z;
+            ground[i] = z * metres_per_unit;
+        }
+        return ground;
+    }
+
+    /* lattice: grade steps of one level per station, about ALIGNMENT_MAX_GRADE_STEPS each way. The step is
+       adjusted (by at most a factor of two) so the allowed grade change per station is a whole number of grade
+       steps, a limit finer than half a step leaves the grade constant. */
+    static AlignmentLattice get_lattice(float ds, float max_grade, float max_grade_change, float min_step) {
+        AlignmentLattice lattice;
+        lattice.dh = std::max(min_step, max_grade * ds / ALIGNMENT_MAX_GRADE_STEPS);
+        float change_height = std::max(0.f, max_grade_change) * ds * ds;   // [m] height of the largest grade change per station
+        if (change_height >= 0.5f * lattice.dh) {
+            lattice.k_change = std::max(1, (int)std::lround(change_height / lattice.dh));
+            lattice.dh = change_height / lattice.k_change;
+        }
+        lattice.k_max = std::max(0, (int)std::floor(max_grade * ds / lattice.dh + 1e-4f));
+        return lattice;
+    }
+
+    // Lattice at a coarse station spacing with the same grade limit as the fine one, so both reach the same end
+    // heights. The grade change limit is rounded up to whole coarse steps, the fine search enforces it exactly.
+    static AlignmentLattice get_coarse_lattice(float coarse_ds, const AlignmentLattice &fine, float ds, float max_grade_change, float min_step) {
+        AlignmentLattice lattice;
+        float grade = fine.k_max * fine.dh / ds;
+        lattice.k_max = std::max(1, (int)std::lround(grade * coarse_ds / min_step));
+        lattice.dh = grade * coarse_ds / lattice.k_max;
+        float change_height = std::max(0.f, max_grade_change) * coarse_ds * coarse_ds;
+        if (fine.k_change > 0) lattice.k_change = std::max(1, (int)std::ceil(change_height / lattice.dh - 1e-4f));
+        return lattice;
+    }
+
+    // Grade limited reference for the band: the middle of the lowest such profile above the ground and the highest
+    // one below it, kept within reach of both handles. On steep ground a band around the ground itself would leave
+    // no feasible profile.
+    static vector<float> get_reference(const vector<float> &ground, float ds, float max_grade) {
+        int station_num = (int)ground.size();
+        vector<float> above = ground, below = ground;
+        for (int i = 1; i < station_num; i++) {
+            above[i] = std::max(above[i], above[i-1] - max_grade * ds);
+            below[i] = std::min(below[i], below[i-1] + max_grade * ds);
+        }
+        for (int i = station_num - 2; i >= 0; i--) {
+            above[i] = std::max(above[i], above[i+1] - max_grade * ds);
+            below[i] = std::min(below[i], below[i+1] + max_grade * ds);
+        }
+        vector<float> reference(station_num);
+        for (int i = 0; i < station_num; i++) {
+            float from_start = max_grade * ds * i, from_end = max_grade * ds * (station_num - 1 - i);
+            reference[i] = glm::clamp(0.5f * (above[i] + below[i]), ground.back() - from_end, ground.back() + from_end);
+            reference[i] = glm::clamp(reference[i], ground[0] - from_start, ground[0] + from_start);
+        }
+        return reference;
+    }
+
+    // Dynamic programming over the levels within deviation of the reference heights, fills the result heights and
+    // cost. The track starts on the ground at the start handle and ends at the end handle if the grade limits reach it.
+    bool solve(const vector<float> &ground, const vector<float> &reference, const AlignmentLattice &lattice, float deviation, AlignmentResult &r) {
+        int station_num = (int)ground.size();
+        float dh = lattice.dh;
+        int k_max = lattice.k_max, k_change = lattice.k_change;
+        int k_num = 2 * k_max + 1;
+        int band = (int)std::ceil(deviation / dh);
+        int level_num = 2 * band + 1;
+        int state_num = level_num * k_num;
+        band_low.resize(station_num);
+        for (int i = 0; i < station_num; i++) band_low[i] = (int)std::lround(reference[i] / dh) - band;
+
+        cost.assign(state_num, FLT_MAX);
+        next_cost.resize(state_num);
+        parent_grade.assign((size_t)station_num * state_num, 0);
+
+        auto node_cost = [&](int i, int level) { return deviation_cost(level * dh, ground[i]); };
+
+        int start_l = glm::clamp((int)std::lround(ground[0] / dh) - band_low[0], 0, level_num - 1);
+        for (int k = 0; k < k_num; k++) cost[start_l * k_num + k] = node_cost(0, band_low[0] + start_l);
+
+        /* forward pass */
+        for (int i = 1; i < station_num; i++) {
+            std::fill(next_cost.begin(), next_cost.end(), FLT_MAX);
+            signed char *parents = &parent_grade[(size_t)i * state_num];
+            for (int l = 0; l < level_num; l++) {
+                int level = band_low[i] + l;
+                float c_here = node_cost(i, level);
+                for (int k = 0; k < k_num; k++) {
+                    int grade = k - k_max;
+                    int prev_l = level - grade - band_low[i-1];
+                    if (prev_l < 0 || prev_l >= level_num) continue;
+
+                    const float *prev = &cost[prev_l * k_num];
+                    int k0 = std::max(0, k - k_change), k1 = std::min(k_num - 1, k + k_change);
+                    float best = FLT_MAX; int best_k = k;
+                    for (int kp = k0; kp <= k1; kp++) if (prev[kp] < best) { best = prev[kp]; best_k = kp; }
+                    if (best == FLT_MAX) continue;
+                    next_cost[l * k_num + k] = best + c_here;
+                    parents[l * k_num + k] = (signed char)best_k;
+                }
+            }
+            std::swap(cost, next_cost);
+        }
+
+        /* backtrack, from the end handle if the grade limits can reach it */
+        int end_l = (int)std::lround(ground[station_num-1] / dh) - band_low[station_num-1];
+        int best_state = -1;
+        if (end_l >= 0 && end_l < level_num)
+            best_state = end_l * k_num + (int)(std::min_element(cost.begin() + end_l * k_num, cost.begin() + (end_l + 1) * k_num) - (cost.begin() + end_l * k_num));
+        r.end_pinned = best_state >= 0 && cost[best_state] != FLT_MAX;
+        if (!r.end_pinned) best_state = (int)(std::min_element(cost.begin(), cost.end()) - cost.begin());
+        r.feasible = cost[best_state] != FLT_MAX;
+        if (!r.feasible) return false;
+        r.cost = cost[best_state];
+        r.station_heights.resize(station_num);
+        int l = best_state / k_num, k = best_state % k_num;
+        for (int i = station_num - 1; i >= 0; i--) {
+            int level = band_low[i] + l;
+            r.station_heights[i] = level * dh;
+            if (i == 0) break;
+            int prev_k = parent_grade[(size_t)i * state_num + l * k_num + k];
+            l = level - (k - k_max) - band_low[i-1];
+            k = prev_k;
+        }
+        return true;
+    }
+
+public:
+    VerticalAlignment(ElevationLineDrawer *height_source, const TerrainData *terrain_data)
+        : height_source(height_source), metres_per_unit(terrain_data->get_metres_per_local_unit()) {}
+
+    // max_grade as rise over run, max_grade_change in grade per metre
+    AlignmentResult optimise(const vector<vec3> &path_points, float max_grade, float max_grade_change = ALIGNMENT_MAX_GRADE_CHANGE) {
+        AlignmentResult r;
+        r.points = path_points;
+        if (path_points.size() < 2) return r;
+
+        /* stations along the path */
+        ArcLengthPath path(path_points);
+        float length_m = path.get_length() * metres_per_unit;
+        int station_num = std::max(2, (int)std::ceil(length_m / ALIGNMENT_STATION_SPACING) + 1);
+        float ds = length_m / (station_num - 1);
+        r.station_spacing = ds;
+        r.station_ground = sample_ground(path, station_num);
+        max_grade = std::fabs(max_grade);
+        AlignmentLattice lattice = get_lattice(ds, max_grade, max_grade_change, ALIGNMENT_MIN_HEIGHT_STEP);
+
+        // The whole deviation band is searched with stations and height steps ALIGNMENT_COARSE_FACTOR times further
+        // apart, which keeps the grade and grade change limits, and the fine lattice only in a narrow band around
+        // that profile. If the narrow band loses the end handle, the fine lattice searches the whole band.
+        int coarse_station_num = std::max(2, (int)std::ceil((station_num - 1) / (float)ALIGNMENT_COARSE_FACTOR) + 1);
+        bool solved = false;
+        if (ALIGNMENT_COARSE_FACTOR > 1 && coarse_station_num > 2 && lattice.k_max > 0) {
+            float coarse_ds = length_m / (coarse_station_num - 1);
+            vector<float> coarse_ground = sample_ground(path, coarse_station_num);
+            AlignmentLattice coarse_lattice = get_coarse_lattice(coarse_ds, lattice, ds, max_grade_change, lattice.dh * ALIGNMENT_COARSE_FACTOR);
+            AlignmentResult coarse;
+            if (solve(coarse_ground, get_reference(coarse_ground, coarse_ds, max_grade), coarse_lattice, ALIGNMENT_MAX_DEVIATION, coarse)) {
+                vector<float> reference(station_num);
+                for (int i = 0; i < station_num; i++) {
+                    float c = i * ds / coarse_ds;
+                    int j = glm::clamp((int)c, 0, coarse_station_num - 2);
+                    reference[i] = glm::mix(coarse.station_heights[j], coarse.station_heights[j+1], glm::clamp(c - j, 0.f, 1.f));
+                }
+                solved = solve(r.station_ground, reference, lattice, ALIGNMENT_REFINE_BAND, r) && (r.end_pinned || !coarse.end_pinned);
+            }
+        }
+        if (!solved && !solve(r.station_ground, get_reference(r.station_ground, ds, max_grade), lattice, ALIGNMENT_MAX_DEVIATION, r)) return r;
+
+        /* designed heights back onto the input points */
+        const vector<float> &cumulative = path.get_cumulative_lengths();
+        for (size_t p = 0; p < r.points.size(); p++) {
+            float s = cumulative[p] * metres_per_unit / ds;
+            int i = glm::clamp((int)s, 0, station_num - 2);
+            float h = glm::mix(r.station_heights[i], r.station_heights[i+1], glm::clamp(s - i, 0.f, 1.f));
+            r.points[p].z = h / metres_per_unit;
+        }
+
+        /* bridge / tunnel sections */
+        for (int i = 0; i < station_num; i++) {
+            float deviation = r.station_heights[i] - r.station_ground[i];
+            AlignmentSectionType type = deviation > ALIGNMENT_BRIDGE_HEIGHT ? ALIGNMENT_BRIDGE
+                                      : deviation < -ALIGNMENT_TUNNEL_DEPTH ? ALIGNMENT_TUNNEL : ALIGNMENT_AT_GRADE;
+            float start = std::max(0.f, (i - 0.5f) * ds), end = std::min(length_m, (i + 0.5f) * ds);
+            if (!r.sections.empty() && r.sections.back().type == type) r.sections.back().end_distance = end;
+            else r.sections.push_back({ type, start, end });
+        }
+        return r;
+    }
+
+    // designed heights as a profile along a committed alignment of the given length [local units], stations are spread
+    // evenly over it; stations on one grade are merged
+    VerticalProfile get_profile(const AlignmentResult &r, float alignment_length) const {
+        int station_num = (int)r.station_heights.size();
+        vector<float> distances(station_num), heights(station_num);
+        for (int i = 0; i < station_num; i++) {
+            distances[i] = station_num > 1 ? alignment_length * i / (station_num - 1) : 0.f;
+            heights[i] = r.station_heights[i] / metres_per_unit;
+        }
+        return VerticalProfile::fit(distances, heights, 0.01f / metres_per_unit);
+    }
+
+    static float get_section_length(const AlignmentResult &r, AlignmentSectionType type) {
+        float total = 0.f;
+        for (const AlignmentSection &s : r.sections) if (s.type == type) total += s.end_distance - s.start_distance;
+        return total;
+    }
+};
+
+#endif
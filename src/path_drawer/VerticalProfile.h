@@ -0,0 +1,64 @@
+#ifndef VERTICALPROFILE_H
+#define VERTICALPROFILE_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cfloat>
+#include <algorithm>
+#include "PathSimplifier.h"
+
+using namespace glm;
+using namespace std;
+
+// Track height along a horizontal alignment, linear between vertices (points of vertical intersection)
+// so the grade of every stretch is kept as designed. Distances and heights in terrain local units.
+class VerticalProfile
+{
+private:
+    vector<float> distance, height;
+
+public:
+    VerticalProfile() {}
+
+    // heights at increasing distances, vertices within height_tolerance of the chord between their neighbours are dropped
+    static VerticalProfile fit(const vector<float> &distances, const vector<float> &heights, float height_tolerance) {
+        VerticalProfile profile;
+        vector<vec3> points(distances.size());
+        for (size_t i = 0; i < points.size(); i++) points[i] = vec3(distances[i], 0.f, heights[i]);
+        for (const vec3 &p : PathSimplifier::simplify(points, FLT_MAX, height_tolerance)) profile.add(p.x, p.z);
+        return profile;
+    }
+
+    // heights of a polyline with its own xy length stretched onto an alignment of the given length
+    static VerticalProfile fit_to_length(const vector<vec3> &points, float length, float height_tolerance) {
+        vector<float> distances(points.size()), heights(points.size());
+        float total = 0.f;
+        for (size_t i = 0; i < points.size(); i++) {
+            if (i > 0) total += glm::length(vec2(points[i]) - vec2(points[i-1]));
+            distances[i] = total;
+            heights[i] = points[i].z;
+        }
+        float stretch = total > 0.f ? length / total : 0.f;
+        for (float &d : distances) d *= stretch;
+        return fit(distances, heights, height_tolerance);
+    }
+
+    void add(float d, float h) {
+        if (!distance.empty() && d <= distance.back()) { height.back() = h; return; }
+        distance.push_back(d);
+        height.push_back(h);
+    }
+
+    float get_height_at_distance(float d) const {
+        if (distance.empty()) return 0.f;
+        int i = (int)(std::upper_bound(distance.begin(), distance.end(), d) - distance.begin()) - 1;
+        if (i < 0) return height.front();
+        if (i + 1 >= (int)distance.size()) return height.back();
+        return glm::mix(height[i], height[i+1], (d - distance[i]) / (distance[i+1] - distance[i]));
+    }
+
+    int get_vertex_num() const { return (int)distance.size(); }
+    bool is_empty() const { return distance.empty(); }
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include "world_objects/Object.h" // The base class for all renderable entities
 #include "shaders/Shader.h" // The base class for all renderable entities
 #include <vector>
+#include <set>
+#include <utility>
 #include <memory>   // Required for std::unique_ptr
 #include <glm/glm.hpp>
 
@@ -19,6 +21,7 @@ public:
     float screen_width, screen_height, fov, near_clip, far_clip;
     std::vector<Shader*> dependent_shaders;
     std::vector<ProjectionType> dependent_shaders_perspective_type; // each shader can be ortho or perspective
+    std::set<std::pair<Shader*, ProjectionType>> dependancy_set;    // shaders shared by many objects are updated once
     float orthographic_zoom = 2.f;
     float max_orthographic_zoom = 0.01f;
     float min_orthographic_zoom = 10.f;
@@ -30,6 +33,12 @@ public:
         fov(fov), near_clip(near_clip), 
         far_clip(far_clip) {}
 
+    void add_dependancy_once(Shader *shader, ProjectionType type) {
+        if (!dependancy_set.insert({ shader, type }).second) return;
+        dependent_shaders.push_back(shader);
+        dependent_shaders_perspective_type.push_back(type);
+    }
+
     void set_perspective(Shader *shader, bool add_dependancy = true) { 
         shader->use();
         
@@ -39,10 +48,7 @@ public:
         
         set_view_matrix(shader);
         
-        if (add_dependancy) {
-            dependent_shaders.push_back(shader);
-            dependent_shaders_perspective_type.push_back(ProjectionType::Perspective);
-        }
+        if (add_dependancy) add_dependancy_once(shader, ProjectionType::Perspective);
     }
     
     void set_orthographic(Shader *shader, bool add_dependancy = true) {
@@ -66,10 +72,7 @@ public:
 
         set_view_matrix(shader);
 
-        if (add_dependancy) {
-            dependent_shaders.push_back(shader);
-            dependent_shaders_perspective_type.push_back(ProjectionType::Orthographic);
-        }
+        if (add_dependancy) add_dependancy_once(shader, ProjectionType::Orthographic);
     }
 
     void set_view_matrix (Shader *shader) {
@@ -90,10 +93,7 @@ public:
 
         set_view_matrix(shader);
 
-        if (add_dependancy) {
-            dependent_shaders.push_back(shader);
-            dependent_shaders_perspective_type.push_back(ProjectionType::Screenspace);
-        }
+        if (add_dependancy) add_dependancy_once(shader, ProjectionType::Screenspace);
     }
 
     /* Zoom */
@@ -135,6 +135,7 @@ public:
     void clear_dependancies() {
         dependent_shaders.clear();
         dependent_shaders_perspective_type.clear();
+        dependancy_set.clear();
     }
 
 private:
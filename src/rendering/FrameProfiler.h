@@ -0,0 +1,241 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include "settings/Settings.h"
+#include "rendering/GpuTimer.h"
+#include "rendering/ResourceTracker.h"
+
+using namespace std;
+
+// Where frame time goes. CPU zones are scoped (PROFILE_ZONE) and may run on any thread, GPU zones
+// (PROFILE_PASS) also time their GL commands with GL_TIMESTAMP queries that are read back frames later.
+// Zone names must be string literals. With FRAME_PROFILER_ENABLED false every macro expands to nothing.
+#if FRAME_PROFILER_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define PROFILE_PASS(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name, true)
+#define PROFILE_FRAME_BEGIN() get_frame_profiler().begin_frame()
+#define PROFILE_FRAME_END() get_frame_profiler().end_frame()
+#else
+#define PROFILE_ZONE(name)
+#define PROFILE_PASS(name)
+#define PROFILE_FRAME_BEGIN()
+#define PROFILE_FRAME_END()
+#endif
+
+#define PROFILER_GPU_THREAD 1000   // trace thread of the GPU zones
+#define PROFILER_GPU_SLOTS 8       // frames a GPU result may arrive late and still find its start time
+
+struct ProfileEvent {
+    const char *name;
+    int thread;
+    int64_t start_us, duration_us;
+};
+
+// per frame totals of one zone over the last FRAME_PROFILER_HISTORY frames, and summed since reset_totals
+struct ZoneStats {
+    const char *name;
+    vector<float> cpu_ms, gpu_ms;
+    int cpu_next = 0, gpu_next = 0;
+    bool gpu = false;
+    double cpu_total_ms = 0.0, gpu_total_ms = 0.0;
+    int cpu_total_frames = 0, gpu_total_frames = 0;
+
+    void add(vector<float> &history, int &next, float ms) {
+        if ((int)history.size() < FRAME_PROFILER_HISTORY) history.push_back(ms);
+        else history[next] = ms;
+        next = (next + 1) % FRAME_PROFILER_HISTORY;
+    }
+    static float average(const vector<float> &history) {
+        float sum = 0.f;
+        for (float ms : history) sum += ms;
+        return history.empty() ? 0.f : sum / history.size();
+    }
+    static float maximum(const vector<float> &history) {
+        return history.empty() ? 0.f : *std::max_element(history.begin(), history.end());
+    }
+};
+
+class FrameProfiler
+{
+private:
+    struct GpuZone {
+        GpuTimer timer;
+        int64_t start_us[PROFILER_GPU_SLOTS];
+    };
+
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+    std::mutex mutex;
+    std::atomic<int> thread_num{0};
+
+    vector<ProfileEvent> frame_events;          // zones finished this frame
+    deque<vector<ProfileEvent>> trace_frames;   // finished frames for the trace export
+    vector<ProfileEvent> gpu_events;            // GPU results collected since the last end_frame
+    map<string, ZoneStats> zones;
+    vector<string> zone_order;                  // first seen first, keeps the overlay rows in place
+    map<string, GpuZone> gpu_zones;
+
+    int frame = 0;
+    int64_t frame_start_us = 0;
+
+    ZoneStats& get_zone(const char *name) {
+        auto it = zones.find(name);
+        if (it != zones.end()) return it->second;
+        zone_order.push_back(name);
+        ZoneStats &z = zones[name];
+        z.name = name;
+        return z;
+    }
+
+    void collect_gpu_results() {
+        for (auto &entry : gpu_zones) {
+            GpuZone &g = entry.second;
+            const char *name = get_zone(entry.first.c_str()).name;
+            g.timer.collect([&](int tag, float ms) {
+                gpu_events.push_back({ name, PROFILER_GPU_THREAD, g.start_us[tag % PROFILER_GPU_SLOTS], (int64_t)(ms * 1000.f) });
+            });
+        }
+    }
+
+public:
+    FrameProfiler() { get_zone("frame"); }
+
+    int64_t now_us() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    // small stable id of the calling thread, the first thread to ask is 0
+    int get_thread_index() {
+        thread_local int index = thread_num++;
+        return index;
+    }
+
+    void begin_frame() {
+        frame_start_us = now_us();
+    }
+
+    void end_frame() {
+        int64_t end_us = now_us();
+        std::lock_guard<std::mutex> lock(mutex);
+        frame_events.push_back({ "frame", get_thread_index(), frame_start_us, end_us - frame_start_us });
+
+        // CPU zones summed per frame, so zones on several workers or called repeatedly show their total
+        map<const char*, float> frame_ms;
+        for (const ProfileEvent &e : frame_events) frame_ms[get_zone(e.name).name] += e.duration_us / 1000.f;
+        for (auto &entry : frame_ms) {
+            ZoneStats &z = get_zone(entry.first);
+            z.add(z.cpu_ms, z.cpu_next, entry.second);
+            z.cpu_total_ms += entry.second;
+            z.cpu_total_frames++;
+        }
+
+        collect_gpu_results();
+        for (const ProfileEvent &e : gpu_events) {
+            ZoneStats &z = get_zone(e.name);
+            z.add(z.gpu_ms, z.gpu_next, e.duration_us / 1000.f);
+            z.gpu_total_ms += e.duration_us / 1000.0;
+            z.gpu_total_frames++;
+            frame_events.push_back(e);
+        }
+        gpu_events.clear();
+
+        trace_frames.push_back(std::move(frame_events));
+        frame_events.clear();
+        while ((int)trace_frames.size() > FRAME_PROFILER_TRACE_FRAMES) trace_frames.pop_front();
+        frame++;
+    }
+
+    void add_cpu_event(const char *name, int64_t start_us, int64_t duration_us) {
+        int thread = get_thread_index();
+        std::lock_guard<std::mutex> lock(mutex);
+        frame_events.push_back({ name, thread, start_us, duration_us });
+    }
+
+    // GL commands between the two calls are timed, main thread only
+    bool begin_gpu_zone(const char *name) {
+        GpuZone &g = gpu_zones[name];
+        get_zone(name).gpu = true;
+        GlobalResourceScope global_scope;   // the queries are kept for the whole run
+        if (!g.timer.begin(frame)) return false;
+        g.start_us[frame % PROFILER_GPU_SLOTS] = now_us();
+        return true;
+    }
+    void end_gpu_zone(const char *name) {
+        gpu_zones[name].timer.end();
+    }
+
+    // whole run statistics start over, e.g. after a warmup
+    void reset_totals() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &entry : zones) {
+            entry.second.cpu_total_ms = entry.second.gpu_total_ms = 0.0;
+            entry.second.cpu_total_frames = entry.second.gpu_total_frames = 0;
+        }
+    }
+
+    int get_frame_num() const { return frame; }
+    const vector<string>& get_zone_names() const { return zone_order; }
+    const ZoneStats& get_zone_stats(const string &name) const { return zones.at(name); }
+
+    // Chrome trace_event JSON (chrome://tracing, Perfetto) of the kept frames
+    bool write_chrome_trace(const char *path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ofstream file(path);
+        if (!file) { std::cout << "Could not write frame trace to " << path << std::endl; return false; }
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"main\"}},\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << PROFILER_GPU_THREAD << ",\"args\":{\"name\":\"GPU\"}}";
+        int event_num = 0;
+        for (const vector<ProfileEvent> &events : trace_frames) {
+            for (const ProfileEvent &e : events) {
+                file << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"" << (e.thread == PROFILER_GPU_THREAD ? "gpu" : "cpu")
+                     << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread << ",\"ts\":" << e.start_us << ",\"dur\":" << e.duration_us << "}";
+                event_num++;
+            }
+        }
+        file << "\n]}\n";
+        std::cout << "Frame trace of " << trace_frames.size() << " frames (" << event_num << " events) written to " << path << std::endl;
+        return true;
+    }
+};
+
+inline FrameProfiler& get_frame_profiler() {
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+// CPU time of the enclosing scope, and GPU time of its GL commands for passes
+class ProfileZone
+{
+private:
+    const char *name;
+    int64_t start_us;
+    bool gpu;
+
+public:
+    ProfileZone(const char *name, bool gpu = false) : name(name), gpu(gpu) {
+        if (gpu) get_frame_profiler().begin_gpu_zone(name);
+        start_us = get_frame_profiler().now_us();
+    }
+    ~ProfileZone() {
+        FrameProfiler &profiler = get_frame_profiler();
+        profiler.add_cpu_event(name, start_us, profiler.now_us() - start_us);
+        if (gpu) profiler.end_gpu_zone(name);
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef GLSTATS_H
+#define GLSTATS_H
+
+#include <glad/glad.h>
+#include "settings/Settings.h"
+
+// GL calls issued since the last reset. With GL_STATS_ENABLED the draw, bind, state and uniform calls are
+// wrapped in counting macros, so this header has to come before any code that issues them (Window.h
+// includes it right after glad). Main thread only, like the calls it counts.
+struct GlStats {
+    long long draw_calls = 0;
+    long long state_changes = 0;    // program, vertex array, buffer, texture and framebuffer binds, fixed function state
+    long long uniform_updates = 0;
+
+    void reset() { *this = GlStats(); }
+    GlStats& operator+=(const GlStats &o) {
+        draw_calls += o.draw_calls;
+        state_changes += o.state_changes;
+        uniform_updates += o.uniform_updates;
+        return *this;
+    }
+};
+
+inline GlStats& get_gl_stats() {
+    static GlStats stats;
+    return stats;
+}
+
+// glad declares every entry point as a macro naming its glad_gl function pointer, the no-op GL of the
+// benchmarks does not, so there nothing is counted
+#if GL_STATS_ENABLED && defined(glDrawArrays)
+#define GL_STATS_COUNT(counter, call) (get_gl_stats().counter++, call)
+
+#undef glDrawArrays
+#undef glDrawElements
+#define glDrawArrays(...) GL_STATS_COUNT(draw_calls, glad_glDrawArrays(__VA_ARGS__))
+#define glDrawElements(...) GL_STATS_COUNT(draw_calls, glad_glDrawElements(__VA_ARGS__))
+
+#undef glUseProgram
+#undef glBindVertexArray
+#undef glBindBuffer
+#undef glBindTexture
+#undef glActiveTexture
+#undef glBindFramebuffer
+#undef glEnable
+#undef glDisable
+#undef glBlendFunc
+#undef glDepthMask
+#undef glPolygonMode
+#undef glLineWidth
+#define glUseProgram(...) GL_STATS_COUNT(state_changes, glad_glUseProgram(__VA_ARGS__))
+#define glBindVertexArray(...) GL_STATS_COUNT(state_changes, glad_glBindVertexArray(__VA_ARGS__))
+#define glBindBuffer(...) GL_STATS_COUNT(state_changes, glad_glBindBuffer(__VA_ARGS__))
+#define glBindTexture(...) GL_STATS_COUNT(state_changes, glad_glBindTexture(__VA_ARGS__))
+#define glActiveTexture(...) GL_STATS_COUNT(state_changes, glad_glActiveTexture(__VA_ARGS__))
+#define glBindFramebuffer(...) GL_STATS_COUNT(state_changes, glad_glBindFramebuffer(__VA_ARGS__))
+#define glEnable(...) GL_STATS_COUNT(state_changes, glad_glEnable(__VA_ARGS__))
+#define glDisable(...) GL_STATS_COUNT(state_changes, glad_glDisable(__VA_ARGS__))
+#define glBlendFunc(...) GL_STATS_COUNT(state_changes, glad_glBlendFunc(__VA_ARGS__))
+#define glDepthMask(...) GL_STATS_COUNT(state_changes, glad_glDepthMask(__VA_ARGS__))
+#define glPolygonMode(...) GL_STATS_COUNT(state_changes, glad_glPolygonMode(__VA_ARGS__))
+#define glLineWidth(...) GL_STATS_COUNT(state_changes, glad_glLineWidth(__VA_ARGS__))
+
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform2fv
+#undef glUniform3fv
+#undef glUniform4fv
+#undef glUniformMatrix4fv
+#define glUniform1i(...) GL_STATS_COUNT(uniform_updates, glad_glUniform1i(__VA_ARGS__))
+#define glUniform1f(...) GL_STATS_COUNT(uniform_updates, glad_glUniform1f(__VA_ARGS__))
+#define glUniform2fv(...) GL_STATS_COUNT(uniform_updates, glad_glUniform2fv(__VA_ARGS__))
+#define glUniform3fv(...) GL_STATS_COUNT(uniform_updates, glad_glUniform3fv(__VA_ARGS__))
+#define glUniform4fv(...) GL_STATS_COUNT(uniform_updates, glad_glUniform4fv(__VA_ARGS__))
+#define glUniformMatrix4fv(...) GL_STATS_COUNT(uniform_updates, glad_glUniformMatrix4fv(__VA_ARGS__))
+#endif
+
+#endif
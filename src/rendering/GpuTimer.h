@@ -0,0 +1,70 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <glad/glad.h>
+
+// GL_TIMESTAMP queries around the timed commands, read back a few frames later so timing never waits for the GPU.
+// Every measurement carries a tag (e.g. a shader variant) it is reported under. Timestamps nest, a timer
+// started inside another one (a draw inside a profiled pass) measures as well.
+class GpuTimer
+{
+private:
+    static const int QUERY_NUM = 4;
+    unsigned int start_queries[QUERY_NUM], end_queries[QUERY_NUM];
+    int tags[QUERY_NUM];
+    bool pending[QUERY_NUM] = {};
+    bool created = false;
+    int next = 0, running = -1;
+
+public:
+    ~GpuTimer() {
+        if (!created) return;
+        glDeleteQueries(QUERY_NUM, start_queries);
+        glDeleteQueries(QUERY_NUM, end_queries);
+    }
+
+    // false when every query is still in flight, the measurement is skipped
+    bool begin(int tag) {
+        if (!created) {
+            glGenQueries(QUERY_NUM, start_queries);
+            glGenQueries(QUERY_NUM, end_queries);
+            created = true;
+        }
+        if (running >= 0 || pending[next]) return false;
+        running = next;
+        tags[running] = tag;
+        glQueryCounter(start_queries[running], GL_TIMESTAMP);
+        return true;
+    }
+
+    void end() {
+        if (running < 0) return;
+        glQueryCounter(end_queries[running], GL_TIMESTAMP);
+        pending[running] = true;
+        next = (running + 1) % QUERY_NUM;
+        running = -1;
+    }
+
+    // calls on_result(tag, ms) for every finished measurement
+    template <typename F>
+    void collect(F on_result) {
+        for (int i = 0; i < QUERY_NUM; i++) {
+            if (!pending[i]) continue;
+            GLint available = 0;   // the end timestamp lands after the start one
+            glGetQueryObjectiv(end_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 start_ns = 0, end_ns = 0;
+            glGetQueryObjectui64v(start_queries[i], GL_QUERY_RESULT, &start_ns);
+            glGetQueryObjectui64v(end_queries[i], GL_QUERY_RESULT, &end_ns);
+            pending[i] = false;
+            on_result(tags[i], (end_ns - start_ns) / 1e6f);
+        }
+    }
+
+    bool is_idle() const {
+        for (int i = 0; i < QUERY_NUM; i++) if (pending[i]) return false;
+        return running < 0;
+    }
+};
+
+#endif
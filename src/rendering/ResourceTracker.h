@@ -0,0 +1,287 @@
+#ifndef RESOURCETRACKER_H
+#define RESOURCETRACKER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include "settings/Settings.h"
+
+using namespace std;
+
+// Live GL objects and large CPU buffers with their creation site, size and owner scene. With
+// RESOURCE_TRACKER_ENABLED the glGen / glDelete entry points are wrapped in tracking macros (like GlStats,
+// only where glad declares them as macros), uploads report the storage of the object they fill with
+// TRACK_GL_BYTES and CPU buffers are registered through TrackedMemory.
+// Resources are owned by the scene running when they were created, GlobalResourceScope makes them
+// global for caches that outlive scenes. end_scene reports what a scene left behind.
+
+enum ResourceKind {
+    RESOURCE_TEXTURE, RESOURCE_BUFFER, RESOURCE_VERTEX_ARRAY, RESOURCE_FRAMEBUFFER,
+    RESOURCE_RENDERBUFFER, RESOURCE_PROGRAM, RESOURCE_QUERY, RESOURCE_CPU_MEMORY, RESOURCE_KIND_NUM
+};
+
+inline const char* get_resource_kind_name(ResourceKind kind) {
+    static const char *names[RESOURCE_KIND_NUM] = {
+        "texture", "buffer", "vertex array", "framebuffer", "renderbuffer", "program", "query", "cpu memory"
+    };
+    return kind >= 0 && kind < RESOURCE_KIND_NUM ? names[kind] : "unknown";
+}
+
+struct TrackedResource {
+    ResourceKind kind;
+    size_t bytes = 0;
+    const char *file;
+    int line;
+    int scene;                  // owner, 0 is global
+    bool mipmapped = false;
+};
+
+// bytes per texel of the internal formats used here, RGB is stored padded to four bytes
+inline size_t get_texel_bytes(GLint internal_format) {
+    switch (internal_format) {
+        case GL_RED: case GL_R8: return 1;
+        case GL_R16: return 2;
+        case GL_RG16: return 4;
+        case GL_RGB32F: return 12;
+        default: return 4;
+    }
+}
+
+// GL objects of a context that is gone (after glfwTerminate) must not be deleted anymore
+inline bool has_gl_context() {
+    return glfwGetCurrentContext() != nullptr;
+}
+
+class ResourceTracker
+{
+private:
+    std::mutex mutex;
+    map<pair<int, uint64_t>, TrackedResource> live;
+    vector<string> scene_names = { "global" };
+    int current_scene = 0;
+    uint64_t next_memory_key = 1;
+
+    // live count and bytes of a scene per kind and creation site
+    int print_scene(int scene, std::ostream &out) {
+        map<pair<int, string>, pair<int, size_t>> sites;
+        int count = 0;
+        size_t bytes = 0;
+        for (const auto &entry : live) {
+            const TrackedResource &r = entry.second;
+            if (r.scene != scene) continue;
+            pair<int, size_t> &site = sites[{ r.kind, string(r.file) + ":" + std::to_string(r.line) }];
+            site.first++;
+            site.second += r.bytes;
+            count++;
+            bytes += r.bytes;
+        }
+        out << "  " << scene_names[scene] << ": " << count << " live, " << bytes / 1048576.0 << " MB" << std::endl;
+        for (const auto &site : sites) {
+            out << "    " << site.second.first << " " << get_resource_kind_name((ResourceKind)site.first.first) << ", "
+                << site.second.second / 1048576.0 << " MB  " << site.first.second << std::endl;
+        }
+        return count;
+    }
+
+public:
+    void add(ResourceKind kind, uint64_t key, size_t bytes, const char *file, int line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        TrackedResource &r = live[{ kind, key }];
+        r.kind = kind;
+        r.bytes = bytes;
+        r.file = file;
+        r.line = line;
+        r.scene = current_scene;
+        r.mipmapped = false;
+    }
+    void remove(ResourceKind kind, uint64_t key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        live.erase({ kind, key });
+    }
+    void set_bytes(ResourceKind kind, uint64_t key, size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = live.find({ kind, key });
+        if (it != live.end()) it->second.bytes = bytes;
+    }
+
+    /* GL objects */
+
+    void add_gl(ResourceKind kind, GLsizei n, const GLuint *ids, const char *file, int line) {
+        for (GLsizei i = 0; i < n; i++) if (ids[i]) add(kind, ids[i], 0, file, line);
+    }
+    GLuint add_gl(ResourceKind kind, GLuint id, const char *file, int line) {
+        if (id) add(kind, id, 0, file, line);
+        return id;
+    }
+    void remove_gl(ResourceKind kind, GLsizei n, const GLuint *ids) {
+        for (GLsizei i = 0; i < n; i++) remove(kind, ids[i]);
+    }
+
+    // storage of an uploaded object, level 0 of textures
+    void set_gl_bytes(ResourceKind kind, GLuint id, size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = live.find({ kind, (uint64_t)id });
+        if (it == live.end()) return;
+        it->second.bytes = bytes;
+        it->second.mipmapped = false;
+    }
+    // a full mip chain adds a third
+    void add_gl_mipmaps(GLuint texture) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = live.find({ RESOURCE_TEXTURE, (uint64_t)texture });
+        if (it == live.end() || it->second.mipmapped) return;
+        it->second.bytes += it->second.bytes / 3;
+        it->second.mipmapped = true;
+    }
+
+    /* CPU buffers */
+
+    uint64_t new_memory_key() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return next_memory_key++;
+    }
+
+    /* Scenes */
+
+    void begin_scene(const char *name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        scene_names.push_back(name);
+        current_scene = (int)scene_names.size() - 1;
+    }
+    int get_current_scene() const { return current_scene; }
+    void set_current_scene(int scene) { current_scene = scene; }
+
+    // everything created during the scene should be gone by now, returns the leaked resource number
+    int end_scene() {
+        std::lock_guard<std::mutex> lock(mutex);
+        int scene = current_scene;
+        current_scene = 0;
+        if (!scene) return 0;
+        std::cout << "Resources after scene end:" << std::endl;
+        int leaked = print_scene(scene, std::cout);
+        if (leaked) std::cout << "  " << leaked << " resources of " << scene_names[scene] << " leaked" << std::endl;
+        assert((!RESOURCE_TRACKER_ASSERT_LEAKS || leaked == 0) && "scene ended with live resources, see the report above");
+        return leaked;
+    }
+
+    // live resources of every scene, global ones included
+    void print_report(std::ostream &out = std::cout) {
+        std::lock_guard<std::mutex> lock(mutex);
+        out << "Live resources:" << std::endl;
+        for (int scene = 0; scene < (int)scene_names.size(); scene++) print_scene(scene, out);
+    }
+
+    int get_live_num() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (int)live.size();
+    }
+};
+
+// never destroyed, static caches and timers still release their resources into it at exit
+inline ResourceTracker& get_resource_tracker() {
+    static ResourceTracker *tracker = new ResourceTracker();
+    return *tracker;
+}
+
+// resources created while this lives are global, e.g. caches kept for the whole session
+class GlobalResourceScope
+{
+private:
+    int previous_scene;
+
+public:
+    GlobalResourceScope() : previous_scene(get_resource_tracker().get_current_scene()) { get_resource_tracker().set_current_scene(0); }
+    ~GlobalResourceScope() { get_resource_tracker().set_current_scene(previous_scene); }
+};
+
+// A large CPU buffer of its owner: TRACK_MEMORY after every (re)allocation, released with the owner.
+// Copies are tracked on their own.
+class TrackedMemory
+{
+private:
+    uint64_t key = 0;
+    size_t bytes = 0;
+    const char *file = nullptr;
+    int line = 0;
+
+public:
+    TrackedMemory() {}
+    TrackedMemory(const TrackedMemory &o) { update(o.bytes, o.file, o.line); }
+    TrackedMemory& operator=(const TrackedMemory &o) { if (this != &o) update(o.bytes, o.file, o.line); return *this; }
+    ~TrackedMemory() { update(0, file, line); }
+
+    void update(size_t new_bytes, const char *new_file, int new_line) {
+        if (!RESOURCE_TRACKER_ENABLED) return;
+        ResourceTracker &tracker = get_resource_tracker();
+        if (bytes && !new_bytes) tracker.remove(RESOURCE_CPU_MEMORY, key);
+        else if (!bytes && new_bytes) {
+            if (!key) key = tracker.new_memory_key();
+            tracker.add(RESOURCE_CPU_MEMORY, key, new_bytes, new_file, new_line);
+        }
+        else if (new_bytes) tracker.set_bytes(RESOURCE_CPU_MEMORY, key, new_bytes);
+        bytes = new_bytes;
+        file = new_file;
+        line = new_line;
+    }
+    size_t get_bytes() const { return bytes; }
+};
+
+#define TRACK_MEMORY(tracked, bytes) (tracked).update(bytes, __FILE__, __LINE__)
+
+// after glBufferData / glTexImage2D / glRenderbufferStorage / glGenerateMipmap, with the object just filled
+#if RESOURCE_TRACKER_ENABLED
+#define TRACK_GL_BYTES(kind, id, bytes) get_resource_tracker().set_gl_bytes(kind, id, (size_t)(bytes))
+#define TRACK_GL_MIPMAPS(texture) get_resource_tracker().add_gl_mipmaps(texture)
+#else
+#define TRACK_GL_BYTES(kind, id, bytes) ((void)0)
+#define TRACK_GL_MIPMAPS(texture) ((void)0)
+#endif
+
+// allocated bytes of any number of vectors
+inline size_t get_capacity_bytes() { return 0; }
+template <typename T, typename... Rest>
+size_t get_capacity_bytes(const vector<T> &v, const Rest&... rest) { return v.capacity() * sizeof(T) + get_capacity_bytes(rest...); }
+
+// glad declares every entry point as a macro naming its glad_gl function pointer, the no-op GL of the
+// benchmarks does not, so there only CPU buffers are tracked
+#if RESOURCE_TRACKER_ENABLED && defined(glGenTextures)
+#undef glGenTextures
+#undef glGenBuffers
+#undef glGenVertexArrays
+#undef glGenFramebuffers
+#undef glGenRenderbuffers
+#undef glGenQueries
+#undef glCreateProgram
+#define glGenTextures(n, ids) (glad_glGenTextures(n, ids), get_resource_tracker().add_gl(RESOURCE_TEXTURE, n, ids, __FILE__, __LINE__))
+#define glGenBuffers(n, ids) (glad_glGenBuffers(n, ids), get_resource_tracker().add_gl(RESOURCE_BUFFER, n, ids, __FILE__, __LINE__))
+#define glGenVertexArrays(n, ids) (glad_glGenVertexArrays(n, ids), get_resource_tracker().add_gl(RESOURCE_VERTEX_ARRAY, n, ids, __FILE__, __LINE__))
+#define glGenFramebuffers(n, ids) (glad_glGenFramebuffers(n, ids), get_resource_tracker().add_gl(RESOURCE_FRAMEBUFFER, n, ids, __FILE__, __LINE__))
+#define glGenRenderbuffers(n, ids) (glad_glGenRenderbuffers(n, ids), get_resource_tracker().add_gl(RESOURCE_RENDERBUFFER, n, ids, __FILE__, __LINE__))
+#define glGenQueries(n, ids) (glad_glGenQueries(n, ids), get_resource_tracker().add_gl(RESOURCE_QUERY, n, ids, __FILE__, __LINE__))
+#define glCreateProgram() get_resource_tracker().add_gl(RESOURCE_PROGRAM, glad_glCreateProgram(), __FILE__, __LINE__)
+
+#undef glDeleteTextures
+#undef glDeleteBuffers
+#undef glDeleteVertexArrays
+#undef glDeleteFramebuffers
+#undef glDeleteRenderbuffers
+#undef glDeleteQueries
+#undef glDeleteProgram
+#define glDeleteTextures(n, ids) (get_resource_tracker().remove_gl(RESOURCE_TEXTURE, n, ids), glad_glDeleteTextures(n, ids))
+#define glDeleteBuffers(n, ids) (get_resource_tracker().remove_gl(RESOURCE_BUFFER, n, ids), glad_glDeleteBuffers(n, ids))
+#define glDeleteVertexArrays(n, ids) (get_resource_tracker().remove_gl(RESOURCE_VERTEX_ARRAY, n, ids), glad_glDeleteVertexArrays(n, ids))
+#define glDeleteFramebuffers(n, ids) (get_resource_tracker().remove_gl(RESOURCE_FRAMEBUFFER, n, ids), glad_glDeleteFramebuffers(n, ids))
+#define glDeleteRenderbuffers(n, ids) (get_resource_tracker().remove_gl(RESOURCE_RENDERBUFFER, n, ids), glad_glDeleteRenderbuffers(n, ids))
+#define glDeleteQueries(n, ids) (get_resource_tracker().remove_gl(RESOURCE_QUERY, n, ids), glad_glDeleteQueries(n, ids))
+#define glDeleteProgram(id) (get_resource_tracker().remove(RESOURCE_PROGRAM, id), glad_glDeleteProgram(id))
+
+#endif
+
+#endif
@@ -5,8 +5,11 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "rendering/GlStats.h"    // before anything that issues GL calls, so they are counted
+#include "rendering/ResourceTracker.h"    // same for the GL objects it tracks
 #include <iostream>
 #include <math.h>
+#include <stdlib.h>
 #include "world_objects/Cube.h"
 #include "world_objects/Object.h"
 #include "world_objects/Plane.h"
@@ -27,10 +30,13 @@
 #include "UIText.h"
 #include "TitleCardScene.h"
 #include "ScreenUI.h"
+#include "ProfilerOverlay.h"
+#include "rendering/FrameProfiler.h"
 #include "settings/ColourData.h"
 #include "TerrainPath.h"
 #include "Scene.h"
 #include "TerrainScene.h"
+#include "FlythroughBenchmark.h"
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -49,7 +55,15 @@ public:
     {
     }
 
-    void initGLFW() {
+    // offscreen: the window is never shown, for benchmarks on machines without a display or GPU
+    void initGLFW(bool offscreen = false) {
+#ifndef _WIN32
+        // Mesa picks llvmpipe, unless the environment already asks for something else
+        if (offscreen && FLYTHROUGH_SOFTWARE_GL) {
+            setenv("LIBGL_ALWAYS_SOFTWARE", "1", 0);
+            setenv("GALLIUM_DRIVER", "llvmpipe", 0);
+        }
+#endif
         glfwInit();
 
         // select OpenGL version 3.3
@@ -59,6 +73,11 @@ public:
         // select OpenGL Core Profile
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+        if (offscreen) {
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            if (FLYTHROUGH_EGL_CONTEXT) glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        }
+
         // enable backface culling
         //glEnable(GL_DEPTH_TEST)
         //glEnable(GL_CULL_FACE);
@@ -0,0 +1,195 @@
+#ifndef FLYTHROUGHBENCHMARK_H
+#define FLYTHROUGHBENCHMARK_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include "settings/Settings.h"
+#include "settings/Utility.h"
+#include "rendering/Camera.h"
+#include "rendering/GlStats.h"
+#include "rendering/FrameProfiler.h"
+#include "user_interaction/InputRecorder.h"
+#include "TerrainScene.h"
+
+using namespace glm;
+using namespace std;
+
+// camera state at a point of the flythrough, between keyframes it is eased
+struct CameraKeyframe {
+    float time;         // [0,1] of the timed frames
+    vec3 position;      // camera object position, xy pans the view
+    vec3 rotation;      // [deg]
+    float zoom;         // orthographic zoom
+};
+
+// Renders the terrain scene without a user: synthetic paths and handles are committed once, then the camera
+// runs a fixed course of zooms, rotations and pans with a fixed timestep. Frame times, per pass GPU times of
+// the frame profiler and GL call counts of the timed frames go to the console and a JSON report, so
+// rendering changes can be compared on machines without a GPU (software GL in a hidden window).
+class FlythroughBenchmark
+{
+private:
+    bool running = false;
+    int frame = 0;                          // frames rendered, warmup included
+    vector<CameraKeyframe> keyframes;
+    int committed_path_num = 0;
+
+    std::chrono::steady_clock::time_point frame_start;
+    vector<float> frame_ms;
+    vector<GlStats> frame_gl;
+
+    static float ease(float t) { return t * t * (3.f - 2.f * t); }
+
+    // overview, dive in, tilt, orbit, pan low across the map, back out
+    static vector<CameraKeyframe> make_default_course() {
+        return {
+            { 0.00f, vec3(0.f, 0.f, -3.f), vec3(0.f), 2.f },
+            { 0.15f, vec3(0.f, 0.f, -3.f), vec3(0.f), .5f },
+            { 0.30f, vec3(.2f, .1f, -3.f), vec3(-45.f, 0.f, 0.f), .15f },
+            { 0.45f, vec3(.2f, .1f, -3.f), vec3(-60.f, 90.f, 0.f), .3f },
+            { 0.60f, vec3(-.25f, -.2f, -3.f), vec3(-60.f, 180.f, 0.f), .2f },
+            { 0.75f, vec3(-.3f, .25f, -3.f), vec3(-30.f, 270.f, 0.f), .08f },
+            { 0.90f, vec3(0.f, 0.f, -3.f), vec3(-20.f, 360.f, 0.f), 3.f },
+            { 1.00f, vec3(0.f, 0.f, -3.f), vec3(0.f, 360.f, 0.f), 2.f },
+        };
+    }
+
+    bool is_warming_up() const { return frame < FLYTHROUGH_WARMUP_FRAMES; }
+
+public:
+    // before the scenes are created, so the path solvers see it
+    void start() {
+        running = true;
+        frame = 0;
+        keyframes = make_default_course();
+        frame_ms.reserve(FLYTHROUGH_FRAMES);
+        frame_gl.reserve(FLYTHROUGH_FRAMES);
+        std::cout << "Flythrough benchmark, " << FLYTHROUGH_WARMUP_FRAMES << " warmup and " << FLYTHROUGH_FRAMES << " timed frames" << std::endl;
+    }
+
+    bool is_running() const { return running; }
+    bool is_finished() const { return running && frame >= FLYTHROUGH_WARMUP_FRAMES + FLYTHROUGH_FRAMES; }
+
+    // random pairs of handles over the inner part of the terrain, the drawer modes take turns
+    void commit_synthetic_paths(TerrainScene *scene) {
+        if (!running || !scene) return;
+        std::mt19937 rng(FLYTHROUGH_SEED);
+        auto random_pos = [&]() { return vec2((rng() % 10000) / 10000.f - .5f, (rng() % 10000) / 10000.f - .5f) * .8f; };
+        auto start_time = std::chrono::steady_clock::now();
+        for (int p = 0; p < FLYTHROUGH_PATH_NUM; p++) {
+            vec2 start = random_pos(), end = random_pos();
+            scene->commit_path(start, end, p % scene->get_path_draw_mode_num());
+            committed_path_num++;
+        }
+        std::cout << "Flythrough committed " << committed_path_num << " paths in "
+                  << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start_time).count() << "ms" << std::endl;
+    }
+
+    // no buttons, the cursor in the middle of the screen and the fixed timestep
+    InputFrame next_input_frame(vec2 screen_size) const {
+        InputFrame f;
+        f.cursor_x = screen_size.x / 2.f;
+        f.cursor_y = screen_size.y / 2.f;
+        f.dt = FLYTHROUGH_FIXED_DT;
+        return f;
+    }
+
+    // camera at the current point of the course, the warmup frames hold the first keyframe
+    void apply_camera(Camera &camera) const {
+        if (!running || keyframes.empty()) return;
+        float t = is_warming_up() ? 0.f : (float)(frame - FLYTHROUGH_WARMUP_FRAMES) / std::max(1, FLYTHROUGH_FRAMES - 1);
+        size_t k = 0;
+        while (k + 2 < keyframes.size() && keyframes[k + 1].time <= t) k++;
+        const CameraKeyframe &a = keyframes[k], &b = keyframes[std::min(k + 1, keyframes.size() - 1)];
+        float s = b.time > a.time ? ease(glm::clamp((t - a.time) / (b.time - a.time), 0.f, 1.f)) : 0.f;
+        camera.set_position(glm::mix(a.position, b.position, s));
+        camera.set_rotation(glm::mix(a.rotation, b.rotation, s));
+        camera.set_orthographic_zoom(glm::mix(a.zoom, b.zoom, s));
+    }
+
+    void begin_frame() {
+        if (!running) return;
+        get_gl_stats().reset();
+        frame_start = std::chrono::steady_clock::now();
+    }
+
+    void end_frame() {
+        if (!running) return;
+        if (!is_warming_up()) {
+            frame_ms.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frame_start).count());
+            frame_gl.push_back(get_gl_stats());
+        }
+        if (++frame == FLYTHROUGH_WARMUP_FRAMES) get_frame_profiler().reset_totals();
+    }
+
+    // summary to the console and the full report as JSON to path
+    bool write_report(const char *path) {
+        const GLubyte *renderer = glGetString(GL_RENDERER), *version = glGetString(GL_VERSION);
+        string renderer_name = renderer ? (const char*)renderer : "unknown", version_name = version ? (const char*)version : "unknown";
+
+        float total_ms = 0.f;
+        for (float ms : frame_ms) total_ms += ms;
+        float mean_ms = frame_ms.empty() ? 0.f : total_ms / frame_ms.size();
+        GlStats gl_total, gl_max;
+        for (const GlStats &s : frame_gl) {
+            gl_total += s;
+            gl_max.draw_calls = std::max(gl_max.draw_calls, s.draw_calls);
+            gl_max.state_changes = std::max(gl_max.state_changes, s.state_changes);
+            gl_max.uniform_updates = std::max(gl_max.uniform_updates, s.uniform_updates);
+        }
+        double frames = std::max<size_t>(1, frame_gl.size());
+
+        std::cout << "Flythrough on " << renderer_name << ", " << frame_ms.size() << " frames: mean " << mean_ms << "ms, p50 "
+                  << get_percentile(frame_ms, 50.f) << "ms, p95 " << get_percentile(frame_ms, 95.f) << "ms, p99 "
+                  << get_percentile(frame_ms, 99.f) << "ms, max " << get_percentile(frame_ms, 100.f) << "ms" << std::endl;
+        std::cout << "  per frame: " << gl_total.draw_calls / frames << " draw calls, " << gl_total.state_changes / frames
+                  << " state changes, " << gl_total.uniform_updates / frames << " uniform updates" << std::endl;
+
+        std::ofstream file(path);
+        file << "{\n  \"renderer\": \"" << renderer_name << "\",\n  \"gl_version\": \"" << version_name << "\",\n"
+             << "  \"resolution\": [" << SCR_WIDTH << ", " << SCR_HEIGHT << "],\n"
+             << "  \"warmup_frames\": " << FLYTHROUGH_WARMUP_FRAMES << ",\n  \"frames\": " << frame_ms.size() << ",\n"
+             << "  \"paths\": " << committed_path_num << ",\n  \"seed\": " << FLYTHROUGH_SEED << ",\n"
+             << "  \"frame_ms\": { \"mean\": " << mean_ms << ", \"p50\": " << get_percentile(frame_ms, 50.f)
+             << ", \"p95\": " << get_percentile(frame_ms, 95.f) << ", \"p99\": " << get_percentile(frame_ms, 99.f)
+             << ", \"max\": " << get_percentile(frame_ms, 100.f) << " },\n"
+             << "  \"gl_per_frame\": { \"draw_calls\": " << gl_total.draw_calls / frames << ", \"state_changes\": " << gl_total.state_changes / frames
+             << ", \"uniform_updates\": " << gl_total.uniform_updates / frames << ", \"max_draw_calls\": " << gl_max.draw_calls
+             << ", \"max_state_changes\": " << gl_max.state_changes << ", \"max_uniform_updates\": " << gl_max.uniform_updates << " },\n"
+             << "  \"zones\": [";
+
+        // per zone means over the timed frames, GPU times only for passes
+        FrameProfiler &profiler = get_frame_profiler();
+        bool first = true;
+        for (const string &name : profiler.get_zone_names()) {
+            const ZoneStats &z = profiler.get_zone_stats(name);
+            if (!z.cpu_total_frames && !z.gpu_total_frames) continue;
+            float cpu_ms = z.cpu_total_frames ? (float)(z.cpu_total_ms / z.cpu_total_frames) : 0.f;
+            float gpu_ms = z.gpu_total_frames ? (float)(z.gpu_total_ms / z.gpu_total_frames) : 0.f;
+            if (z.gpu) std::cout << "  " << name << ": cpu " << cpu_ms << "ms, gpu " << gpu_ms << "ms" << std::endl;
+            file << (first ? "\n" : ",\n") << "    { \"name\": \"" << name << "\", \"cpu_ms\": " << cpu_ms;
+            if (z.gpu) file << ", \"gpu_ms\": " << gpu_ms << ", \"gpu_frames\": " << z.gpu_total_frames;
+            file << " }";
+            first = false;
+        }
+        file << "\n  ]\n}\n";
+        std::cout << (file ? "Flythrough report written to " : "Could not write flythrough report to ") << path << std::endl;
+        return (bool)file;
+    }
+};
+
+inline FlythroughBenchmark& get_flythrough_benchmark() {
+    static FlythroughBenchmark benchmark;
+    return benchmark;
+}
+
+#endif
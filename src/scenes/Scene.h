@@ -31,6 +31,7 @@ public:
     void end_scene() { is_active = false; }
 
     virtual Shader* get_world_pos_buffer_shader() { return NULL; }
+    virtual const char* get_name() { return "scene"; }  // resource reports
     
     virtual ~Scene() {}
 
@@ -9,9 +9,14 @@
 #include "TerrainPath.h"
 #include "AutoSlopePathDrawer.h"
 #include "PathSystem.h"
+#include "PathAnalytics.h"
+#include "TrackSegmentTree.h"
+#include "Earthworks.h"
+#include "VerticalAlignment.h"
 #include "StraightPathDrawer.h"
 #include "ToolbarPanel.h"
 #include "TextPanel.h"
+#include "rendering/FrameProfiler.h"
 
 #define curr_path_drawer terrain_path_drawer[current_path_draw_mode]
 
@@ -23,25 +28,48 @@ private:
         MODE_STRAIGHT_PATH=0, MODE_ISO_PATH=2, MODE_AUTO_SLOPE=1,
     };
     
-    InteractableManager *interactable_manager;
+    InteractableManager *interactable_manager = nullptr;
     
-    Terrain *terrain;   
+    Terrain *terrain = nullptr;   
     Plane *terrain_obj;
     const TerrainData *terrain_data;
-    TerrainPathDrawer *terrain_path_drawer[3];
+    TerrainPathDrawer *terrain_path_drawer[3] = {};
     
     float last_scroll_value = 1.f;
     int current_path_draw_mode = ButtonID::MODE_STRAIGHT_PATH;
     int draw_start_handle_id = 0;
 
-    PathSystem *path_system;
+    PathSystem *path_system = nullptr;
+    PathAnalytics *path_analytics = nullptr;
+    PathMetrics preview_metrics;
+    Earthworks *earthworks = nullptr;
+    EarthworksVolume preview_earthworks;
+    VerticalAlignment *vertical_alignment = nullptr;
+    TrackSegmentTree track_tree;
+    vector<TrackCrossing> preview_crossings;
+    int committed_path_num = 0;
     TextPanel *slope_display;
+    TextPanel *cost_display;            // earthworks of the path being drawn, then the summary of the last link
+    std::string last_link_info;
     Interactable *test_interact;
 
 public:
 
     TerrainScene (const TerrainData *terrain_data, World *w, Camera *c, ScreenUI *s, InputHandler *ih) : Scene(w,c,s,ih), terrain_data(terrain_data) {
     }
+
+    // objects placed in the world and the screen ui are theirs or the scene arena's, they go after the scene
+    ~TerrainScene() override {
+        for (TerrainPathDrawer *drawer : terrain_path_drawer) delete drawer;
+        delete path_system;
+        delete path_analytics;
+        delete earthworks;
+        delete vertical_alignment;
+        delete interactable_manager;
+        delete terrain;
+    }
+
+    const char* get_name() override { return "terrain"; }
     
     void init( ) override {
         interactable_manager = new InteractableManager(world, 
@@ -60,7 +88,7 @@ public:
         terrain_obj = terrain->get_obj();
 
         // --- Interaction Objects ---
-        test_interact = new Interactable(vec3(0.f), "test interact", InteractionType::PATH_HANDLE, INTERACTABLE_INTERACT_DISTANCE); // Position 0, will be moved by attach
+        test_interact = get_scene_pool<Interactable>().create(vec3(0.f), "test interact", InteractionType::PATH_HANDLE, INTERACTABLE_INTERACT_DISTANCE, -1, interactable_manager->get_handle_shader()); // Position 0, will be moved by attach
         terrain->attach_to_surface( test_interact, 0.5f, 0.5f ); 
         interactable_manager->add(test_interact);
         
@@ -69,9 +97,19 @@ public:
         terrain_path_drawer[ButtonID::MODE_STRAIGHT_PATH] = new StraightPathDrawer(terrain, world, true);
         terrain_path_drawer[ButtonID::MODE_AUTO_SLOPE] = new AutoSlopePathDrawer(terrain, world, 1.f, true);
         terrain_path_drawer[ButtonID::MODE_ISO_PATH] = new MatchSlopePathDrawer(terrain, world, 0.25f, true);
+        terrain->elevation_line_drawer.add_edit_listener([this](const PixelRect &r) {
+            vec2 box_min, box_max;
+            terrain->get_local_box(r, box_min, box_max);
+            for (TerrainPathDrawer *drawer : terrain_path_drawer) drawer->invalidate_region(box_min, box_max);
+        });
 
         // --- config path system ----
         path_system = new PathSystem();
+        path_analytics = new PathAnalytics(terrain_data);
+        path_analytics->set_area_data(terrain->painter.get_areas_rgb(), terrain->painter.get_map_width(), terrain->painter.get_map_height());
+        path_analytics->set_terrain_fields(&terrain->terrain_fields);
+        earthworks = new Earthworks(&terrain->elevation_line_drawer, terrain_data);
+        vertical_alignment = new VerticalAlignment(&terrain->elevation_line_drawer, terrain_data);
         for (auto i : interactable_manager->get_current_interactables()) {
             if (i->type == InteractionType::PATH_HANDLE) { path_system->create_destination(i, false);
             std::cout << "added destination: " << i->name << std::endl; }
@@ -86,21 +124,40 @@ public:
         camera_controls(dt);
 
         // update terrain path'
-        curr_path_drawer->update_path(user_input);
+        {
+            PROFILE_ZONE("path solve");
+            curr_path_drawer->update_path(user_input);
+        }
+        if (curr_path_drawer->is_drawing_path()) {
+            PROFILE_ZONE("path analytics");
+            preview_metrics = path_analytics->analyse(curr_path_drawer->current_line->get_points());
+            preview_earthworks = earthworks->estimate(curr_path_drawer->current_line->get_points(), EARTHWORKS_CORRIDOR_WIDTH);
+            track_tree.find_path_crossings(curr_path_drawer->current_line->get_points(), preview_crossings, INTERACTABLE_INTERACT_DISTANCE);
+        }
+
+        // where the auto slope drawer can get to from the handle under its current max slope
+        if (current_path_draw_mode == ButtonID::MODE_AUTO_SLOPE && curr_path_drawer->is_drawing_path())
+            terrain->show_reachability(curr_path_drawer->origin_point, ((AutoSlopePathDrawer*)curr_path_drawer)->get_current_max_slope());
+        else terrain->hide_reachability();
 
         // process interactable objects
         vec3 mouse_terrain_local_pos = vec3(glm::inverse(terrain_obj->get_transform()) * vec4(user_input->get_mouse_position_world(), 1.f));
-        interactable_manager->process_all(mouse_terrain_local_pos, user_input->is_left_mouse_clicked());
-        interactable_manager->resize_on_zoom(camera->get_current_orthographic_zoom()); 
+        terraform_controls(mouse_terrain_local_pos, dt);
+        {
+            PROFILE_ZONE("interactables");
+            interactable_manager->process_all(mouse_terrain_local_pos, user_input->is_left_mouse_clicked());
+            interactable_manager->resize_on_zoom(camera->get_current_orthographic_zoom()); 
+        }
         
         // check end drawing
         if (user_input->is_left_mouse_clicked() && curr_path_drawer->is_drawing_path() 
             && glm::length(mouse_terrain_local_pos-curr_path_drawer->origin_point) > INTERACTABLE_INTERACT_DISTANCE) {
+            PROFILE_ZONE("path link");
             Interactable* i = create_path_handle_at_pos (curr_path_drawer->get_end_point());
             if (i) { 
                 path_system->create_destination(i,true); 
-                path_system->add_link(draw_start_handle_id, i->get_id(), 10.f);
                 curr_path_drawer->end_drawing_at_pos(mouse_terrain_local_pos);
+                add_path_link(draw_start_handle_id, i->get_id());
                 //draw_start_handle_id = i->get_id();
                 //curr_path_drawer->start_drawing_at_pos(end_pos);
             }
@@ -113,8 +170,21 @@ public:
         
         /* slope value display */
         bool display_slope_info = current_path_draw_mode != ButtonID::MODE_STRAIGHT_PATH;
-        if (display_slope_info) slope_display->set_text((std::string)(current_path_draw_mode == ButtonID::MODE_AUTO_SLOPE ? "max " : "") + "slope: " + std::to_string((int)(curr_path_drawer->slope*100.f)) + "%");
-        slope_display->set_visible(display_slope_info);
+        bool display_path_info = curr_path_drawer->is_drawing_path();
+        std::string info_text = "";
+        if (display_slope_info) info_text += (std::string)(current_path_draw_mode == ButtonID::MODE_AUTO_SLOPE ? "max " : "") + "slope: " + std::to_string((int)(curr_path_drawer->slope*100.f)) + "%";
+        if (display_slope_info && display_path_info) info_text += "  |  ";
+        if (display_path_info) info_text += "length: " + std::to_string((int)preview_metrics.length_3d) + "m  max grade: " + std::to_string((int)(preview_metrics.max_grade*100.f)) + "%";
+        if (display_path_info && !preview_crossings.empty()) info_text += "  crossings: " + std::to_string(preview_crossings.size());
+        if (display_slope_info || display_path_info) slope_display->set_text(info_text);
+        slope_display->set_visible(display_slope_info || display_path_info);
+
+        /* cost display, refreshed every drag frame */
+        if (display_path_info) cost_display->set_text("cut: " + std::to_string((int)(preview_earthworks.cut / 1000.f)) + "k m3  fill: "
+            + std::to_string((int)(preview_earthworks.fill / 1000.f)) + "k m3  max cut: " + std::to_string((int)preview_earthworks.max_cut_depth)
+            + "m  max fill: " + std::to_string((int)preview_earthworks.max_fill_depth) + "m");
+        else if (!last_link_info.empty()) cost_display->set_text(last_link_info);
+        cost_display->set_visible(display_path_info || !last_link_info.empty());
         
         // prints
         if (user_input->is_left_mouse_double_clicked()) std::cout << "Left Mouse DOUBLE clicked" << std::endl;
@@ -139,7 +209,7 @@ public:
                     //user_input->reset_scroll_value();
                     curr_path_drawer->end_drawing_at_pos(interactable->position);
                     last_scroll_value = user_input->get_scroll_value();
-                    path_system->add_link(draw_start_handle_id,interactable->get_id(),10.f); // TODO len calc
+                    add_path_link(draw_start_handle_id, interactable->get_id());
 
                     std::cout << "NEW DESTINATION CONNECTED! :))) " << interactable->name << std::endl;
                     if(path_system->are_necessary_destinations_connected()) 
@@ -179,7 +249,62 @@ public:
         return i;
     }
 
+    // handles at both ends and the link between them as if drawn by the user, draw_mode is a toolbar button id
+    void commit_path(vec2 start_local_pos, vec2 end_local_pos, int draw_mode) {
+        Interactable *start = create_path_handle_at_pos(vec3(start_local_pos, 0.f));
+        Interactable *end = create_path_handle_at_pos(vec3(end_local_pos, 0.f));
+        path_system->create_destination(start, true);
+        path_system->create_destination(end, true);
+        int previous_mode = current_path_draw_mode;
+        current_path_draw_mode = draw_mode;
+        curr_path_drawer->start_drawing_at_pos(start->position);
+        curr_path_drawer->end_drawing_at_pos(end->position);
+        add_path_link(start->get_id(), end->get_id());
+        current_path_draw_mode = previous_mode;
+    }
+    int get_path_draw_mode_num() const { return sizeof(terrain_path_drawer) / sizeof(terrain_path_drawer[0]); }
+
 private:
+    // The path just committed by the current drawer gets a grade limited designed profile when one reaches both handles,
+    // sections far off the ground become bridges and tunnels. The link weight is the real 3D length of the track.
+    void add_path_link(int start_id, int end_id) {
+        int path_index = curr_path_drawer->get_committed_path_num() - 1;
+        AlignmentResult design = vertical_alignment->optimise(curr_path_drawer->get_last_committed_path(), ALIGNMENT_MAX_GRADE);
+        bool designed = design.feasible && design.end_pinned;
+        if (designed) curr_path_drawer->set_committed_profile(path_index,
+            vertical_alignment->get_profile(design, curr_path_drawer->get_committed_alignments()[path_index].get_length()));
+
+        const vector<vec3> committed = curr_path_drawer->get_last_committed_path();
+        PathMetrics m = path_analytics->analyse(committed);
+        EarthworksVolume v = earthworks->estimate(committed, EARTHWORKS_CORRIDOR_WIDTH);
+        int crossing_num = track_tree.find_path_crossings(committed, preview_crossings, INTERACTABLE_INTERACT_DISTANCE);
+        track_tree.insert_path(committed, committed_path_num++);
+        preview_crossings.clear();
+        path_system->add_link(start_id, end_id, m.length_3d, m.max_grade, m.mean_grade);
+
+        float bridges = designed ? VerticalAlignment::get_section_length(design, ALIGNMENT_BRIDGE) : 0.f;
+        float tunnels = designed ? VerticalAlignment::get_section_length(design, ALIGNMENT_TUNNEL) : 0.f;
+        last_link_info = "last link: " + std::to_string((int)m.length_3d) + "m  max grade: " + std::to_string((int)(m.max_grade*100.f))
+            + "%  crossings: " + std::to_string(crossing_num) + "  cut: " + std::to_string((int)(v.cut / 1000.f)) + "k m3  fill: "
+            + std::to_string((int)(v.fill / 1000.f)) + "k m3" + (designed ? "  bridges: " + std::to_string((int)bridges) + "m  tunnels: "
+            + std::to_string((int)tunnels) + "m" : "  (no designed profile)");
+        if (curr_path_drawer->debug_msg) std::cout << "Link added, length: " << m.length_3d << "m, climb: " << m.climb << "m, descent: " << m.descent
+            << "m, max grade: " << m.max_grade*100.f << "%, max cross slope: " << m.max_cross_slope*100.f << "%, crossings: " << crossing_num
+            << ", cut: " << v.cut << "m3, fill: " << v.fill << "m3, " << (designed ? "designed profile, bridges: " + std::to_string(bridges)
+            + "m, tunnels: " + std::to_string(tunnels) + "m" : std::string("solver profile, no grade limited design reaches both handles")) << std::endl;
+    }
+
+    // middle mouse raises the terrain under the cursor, with shift it lowers it
+    void terraform_controls(vec3 mouse_terrain_local_pos, float dt) {
+        bool on_terrain = std::abs(mouse_terrain_local_pos.x) <= 0.5f && std::abs(mouse_terrain_local_pos.y) <= 0.5f;
+        if (user_input->is_middle_mouse_held() && on_terrain && !curr_path_drawer->is_drawing_path()) {
+            TerraformMode mode = user_input->is_holding_shift() ? TERRAFORM_LOWER : TERRAFORM_RAISE;
+            terrain->terraform(vec2(mouse_terrain_local_pos), TERRAFORM_BRUSH_RADIUS, TERRAFORM_BRUSH_SPEED * dt, mode);
+        }
+        else if (terrain->terraform_brush.is_in_stroke()) terrain->end_terraform_stroke();
+        terrain->update_drainage();
+    }
+
     void camera_controls(float dt) {
         /* Zoom control */
         if (!curr_path_drawer->is_drawing_path()){
@@ -209,6 +334,11 @@ private:
         slope_display->set_anchor( UIAnchor::BOTTOM_LEFT, vec2(30,30) );
         screen_ui->place( slope_display );
 
+        cost_display = new TextPanel("cut: ---", 0.75f, Colour::WHITE, Colour::DARK_GREY, vec2(400, 85), true, true);
+        cost_display->set_anchor( UIAnchor::BOTTOM_LEFT, vec2(30,130) );
+        cost_display->set_visible(false);
+        screen_ui->place( cost_display );
+
         /* toolbar panel */
         ToolbarPanel* toolbar = new ToolbarPanel(vec2(400, 100), 50.0f, 10.0f, vec4(0.2f, 0.2f, 0.2f, 1.0f), Colour::WHITE);        
         toolbar->set_anchor(UIAnchor::BOTTOM_CENTER, vec2(0,30));
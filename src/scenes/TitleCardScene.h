@@ -47,6 +47,8 @@ public:
     void loop(float dt) override {
     }
 
+    const char* get_name() override { return "title card"; }
+
     void on_ui_button_clicked(int button_id, bool state) {
         std::cout << "BUTTON NR " << button_id << " SET TO STATE: " << state << std::endl;
 
@@ -0,0 +1,118 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+// number of workers worth starting for task_num independent tasks
+inline int get_worker_num(int task_num) {
+    int hw = (int)std::thread::hardware_concurrency();
+    return std::max(1, std::min(hw > 0 ? hw : 1, task_num));
+}
+
+// Runs f(i, worker) for every i in [begin, end). Tasks are claimed one at a time so uneven tasks balance,
+// worker is in [0, get_worker_num(end-begin)) and can index per-thread scratch buffers.
+// The calling thread works as worker 0, runs serially when there is only one task or one core.
+template <typename F>
+void parallel_for(int begin, int end, F f) {
+    int worker_num = get_worker_num(end - begin);
+    if (worker_num <= 1) {
+        for (int i = begin; i < end; i++) f(i, 0);
+        return;
+    }
+
+    std::atomic<int> next_task(begin);
+    auto work = [&](int worker) {
+        for (int i = next_task++; i < end; i = next_task++) f(i, worker);
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < worker_num; w++) threads.emplace_back(work, w);
+    work(0);
+    for (auto &t : threads) t.join();
+}
+
+// Persistent threads for small jobs that run every frame, where starting threads per call would cost
+// as much as the work. run() blocks like parallel_for, the calling thread again works as worker 0.
+class WorkerPool
+{
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable work_ready, work_done;
+    std::function<void(int, int)> job;
+    std::atomic<int> next_task{0};
+    int task_end = 0;
+    int busy_num = 0;
+    unsigned int generation = 0;
+    bool quit = false;
+
+    void work(int worker) {
+        for (int i = next_task++; i < task_end; i = next_task++) job(i, worker);
+    }
+
+    void thread_loop(int worker) {
+        unsigned int seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_ready.wait(lock, [&] { return quit || generation != seen; });
+                if (quit) return;
+                seen = generation;
+            }
+            work(worker);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy_num == 0) work_done.notify_one();
+        }
+    }
+
+public:
+    WorkerPool(int worker_num = get_worker_num(1 << 16)) {
+        for (int w = 1; w < worker_num; w++) threads.emplace_back(&WorkerPool::thread_loop, this, w);
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        work_ready.notify_all();
+        for (auto &t : threads) t.join();
+    }
+
+    int get_size() const { return (int)threads.size() + 1; }
+
+    // runs f(i, worker) for every i in [0, task_num)
+    template <typename F>
+    void run(int task_num, F f) {
+        if (threads.empty() || task_num <= 1) {
+            for (int i = 0; i < task_num; i++) f(i, 0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = f;
+            task_end = task_num;
+            next_task = 0;
+            busy_num = (int)threads.size();
+            generation++;
+        }
+        work_ready.notify_all();
+        work(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [&] { return busy_num == 0; });
+    }
+};
+
+// one pool shared by everything that runs per frame on the main thread, run() must not be nested
+inline WorkerPool& get_shared_worker_pool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+#endif
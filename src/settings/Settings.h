@@ -27,6 +27,10 @@
 #define CONTOUR_LINE_COLOUR vec4(0.f,0.f,0.f,0.7f)
 #define CONTOUR_LINE_HEGHT_OFFSET V3_Z * 0.0025f
 #define CONTOUR_LINE_SCALING 1.01f
+#define CONTOUR_MINOR_SPACING 10.f      // [m] same spacing as the minor lines in fragmentContourMap.fs
+#define CONTOUR_MEDIUM_MULTIPLIER 5     // every x minors there is a medium line
+#define CONTOUR_MAJOR_MULTIPLIER 20     // every x minors there is a major line
+#define CONTOUR_TILE_SIZE 64            // [px] marching squares tile, unit of caching and parallel work
 
 // contour map elevation data
 #define ELEVATION_GRADIENT_MAX_HEIGHT 2500.f
@@ -58,8 +62,82 @@
 #define INTERACTABLE_HIGHLIGHTED_COLOUR Colour::GREY
 #define INTERACTABLE_HIGHLIGHTED_OBJECT_ALPHA INTERACTABLE_OBJECT_ALPHA*.7f
 #define INTERACTABLE_INTERACT_DISTANCE 0.02f
+#define INTERACTABLE_GRID_CELL_SIZE 0.04f       // [local units] spatial grid over the terrain, covers [-.5,.5]
 
 #define PATH_DRAW_SLOPE_CHANGE_SPEED .1f
 #define PATH_COLOUR Colour::PURPLE
 #define PATH_THICKNESS 8.f
-#define PATH_TERRAIN_OFFSET_DIST .01f
\ No newline at end of file
+#define PATH_TERRAIN_OFFSET_DIST .01f
+#define PATH_SIMPLIFY_HORIZONTAL_TOLERANCE .0005f // [local units] ~half a heightmap pixel
+#define PATH_SIMPLIFY_HEIGHT_TOLERANCE .0004f   // [local units] ~2m on the transalpine map
+#define PATH_CANDIDATE_MAX_NUM 12               // candidates are cut down to the worker count, but never below 2
+#define PATH_CANDIDATE_BIAS .5f                 // [rad] left / right branch step direction bias
+#define PATH_CANDIDATE_SLOPE_JITTER .15f        // relative slope change of jittered candidates
+#define PATH_CANDIDATE_END_WEIGHT 10.f          // score = weighted end distance + length + grade violation
+#define PATH_CANDIDATE_LENGTH_WEIGHT 1.f
+#define PATH_CANDIDATE_GRADE_WEIGHT 20.f
+#define EARTHWORKS_CORRIDOR_WIDTH 12.f          // [m] formation width of single track used for cut and fill
+#define ALIGNMENT_MAX_GRADE .05f                // grade limit of the designed profile of committed links
+#define ALIGNMENT_STATION_SPACING 20.f          // [m] vertical alignment stations along the path
+#define ALIGNMENT_MIN_HEIGHT_STEP .25f          // [m] finest height lattice step, rounded so the grade change limit is whole steps
+#define ALIGNMENT_MAX_GRADE_STEPS 6             // lattice steps per station at max grade, coarsens the lattice for steep limits
+#define ALIGNMENT_MAX_DEVIATION 100.f           // [m] searched band above and below the ground
+#define ALIGNMENT_COARSE_FACTOR 5               // station spacing and height step of the first, whole band search; 1 searches the band finely
+#define ALIGNMENT_REFINE_BAND 10.f              // [m] fine lattice band around the coarse profile
+#define ALIGNMENT_MAX_GRADE_CHANGE .0005f       // grade change per metre, 1% per station
+#define ALIGNMENT_CUT_WEIGHT 1.f
+#define ALIGNMENT_FILL_WEIGHT .7f
+#define ALIGNMENT_BRIDGE_HEIGHT 10.f            // [m] track this far above ground is a bridge
+#define ALIGNMENT_TUNNEL_DEPTH 15.f             // [m] track this far below ground is a tunnel
+
+#define CURVE_MIN_RADIUS 150.f                  // [m] horizontal curves of committed links
+#define CURVE_MAX_RADIUS 3000.f
+#define CURVE_SPIRAL_LENGTH 60.f                // [m] clothoid transition into and out of every curve
+#define CURVE_FIT_TOLERANCE 8.f                 // [m] tangent polygon simplification of the solver path
+#define CURVE_SAMPLE_SPACING 10.f               // [m] evaluation step before the committed path is simplified
+#define REACH_FIELD_RESOLUTION 256              // [cells] longest side of the reachability field, downsampled so a rebuild fits in a frame (a 1024 field takes ~100ms)
+#define REACH_CLIMB_WEIGHT 10.f                 // extra cost per metre climbed per metre of run
+#define REACH_DESCENT_WEIGHT 4.f
+#define REACH_DISPLAY_DISTANCE 20000.f          // [m] weighted distance at the far end of the overlay gradient
+#define REACH_COLOUR Colour::GREEN
+#define HYDRO_TILE_SIZE 512                     // [px] tiles flooded in parallel for depression filling
+#define HYDRO_RIVER_MIN_AREA 1e5f               // [m^2] upstream area where river strength starts
+#define HYDRO_RIVER_FULL_AREA 1e8f              // [m^2] upstream area of full river strength
+#define HYDRO_LAKE_MIN_CELLS 64                 // smaller filled depressions are not reported as lakes
+#define HYDRO_LAKE_FULL_DEPTH 30.f              // [m] lake depth painted with the deep end of the water gradient
+#define HYDRO_RIVER_GRADIENT_POS .3f            // where on the water gradient river colour is sampled
+#define HYDRO_RIVER_OPACITY .8f
+#define PAINTER_TILE_SIZE 128                   // [px] colour texture tiles re-baked after terrain edits
+#define TERRAFORM_BRUSH_RADIUS 300.f            // [m]
+#define TERRAFORM_BRUSH_SPEED 40.f              // [m/s] raise / lower rate at the brush centre
+#define FIELD_MAX_GRADE 4.f                     // gradient range of the terrain field rasters and RG16 texture
+#define FIELD_MAX_CURVATURE .1f                 // [1/m] curvature range of the terrain field raster
+#define TERRAIN_SHADER_BAKED_COLOUR true        // terrain colour from the painter texture instead of per fragment gradients
+#define TERRAIN_SHADER_CONTOURS true
+#define TERRAIN_SHADER_CURSOR true
+#define TERRAIN_SHADER_PROFILE_FRAMES 0         // >0 times every terrain shader variant over that many frames
+#define FRAME_PROFILER_ENABLED false            // false compiles the profiling zones out
+#define FRAME_PROFILER_HISTORY 120              // [frames] window of the overlay statistics
+#define FRAME_PROFILER_TRACE_FRAMES 600         // [frames] kept for the trace export
+#define FRAME_PROFILER_OVERLAY_ROWS 12
+#define FRAME_PROFILER_OVERLAY_INTERVAL 15      // [frames] between overlay text updates
+#define FRAME_PROFILER_TRACE_PATH "frame_trace.json"
+#define INPUT_RECORDING_MODE 0                  // 0 off, 1 record, 2 replay, see InputRecorder
+#define INPUT_RECORDING_PATH "input_recording.ltir"
+#define INPUT_REPLAY_FIXED_DT 0.f               // [s] 0 replays the recorded frame times, a fixed step is for timing runs only and drifts from the recording
+#define INPUT_REPLAY_TIMINGS_PATH "replay_frame_times.csv"
+#define GL_STATS_ENABLED false                  // counts draw calls and state changes, see GlStats
+#define FLYTHROUGH_BENCHMARK false              // hidden window, synthetic paths and a scripted camera instead of the game, see FlythroughBenchmark (zones and GL counts need the profiler and GL stats enabled)
+#define FLYTHROUGH_FRAMES 600                   // [frames] timed, after the warmup
+#define FLYTHROUGH_WARMUP_FRAMES 60
+#define FLYTHROUGH_FIXED_DT (1.f / 60.f)        // [s] timestep the scene is updated with
+#define FLYTHROUGH_PATH_NUM 12                  // committed before the flythrough, drawer modes take turns
+#define FLYTHROUGH_PATH_CANDIDATE_NUM 4         // fixed auto slope candidates so the paths are the same on every machine
+#define FLYTHROUGH_SEED 1
+#define FLYTHROUGH_SOFTWARE_GL true             // asks Mesa for llvmpipe, for machines without a GPU
+#define FLYTHROUGH_EGL_CONTEXT false            // EGL context creation instead of GLX / WGL
+#define FLYTHROUGH_REPORT_PATH "flythrough_report.json"
+#define RESOURCE_TRACKER_ENABLED false          // GL objects and large CPU buffers with creation site and owner scene, see ResourceTracker
+#define RESOURCE_TRACKER_ASSERT_LEAKS false     // debug builds assert when a scene ends with resources still alive
+#define SCENE_ARENA_BLOCK_BYTES (1 << 20)       // scene arena grows by blocks of this, the first one is kept between scenes
+#define SCENE_POOL_CHUNK_SLOTS 256              // objects per contiguous chunk of a scene object pool
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <cmath>
+#include <algorithm>
 
 #define V3_ONE glm::vec3(1.0f,1.0f,1.0f)
 #define V3_X glm::vec3(1.0f,0.0f,0.0f)
@@ -28,6 +30,15 @@ void print_v3 (glm::vec3 v, const char* name = "Vector") {
     std::cout << name << ": (" << v.x << ", " << v.y << ", " << v.z << ")" << std::endl;
 }
 
+// nearest rank on the sorted values, p in [0,100], 0 for no values
+template <typename T>
+T get_percentile(std::vector<T> values, double p) {
+    if (values.empty()) return T(0);
+    std::sort(values.begin(), values.end());
+    int index = (int)std::ceil(p / 100.0 * values.size()) - 1;
+    return values[std::max(0, std::min((int)values.size() - 1, index))];
+}
+
 // #define print (a) std::cout << a << std::endl;
 // #define print2 (a,b) std::cout << a << b << std::endl;
 // #define print3 (a,b,c) std::cout << a << b << c << std::endl;
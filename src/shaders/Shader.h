@@ -7,10 +7,15 @@
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <utility>
+#include <map>
+#include <functional>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "textures/Texture.h"
+#include "rendering/ResourceTracker.h"
 #include "Settings.h"
 
 // Zakładam istnienie tych plików, jeśli nie masz, usuń include'y poniżej
@@ -25,26 +30,24 @@ class Shader
 public:
     unsigned int ID;
     std::vector<Texture*> textures;
+    std::vector<Texture*> owned_textures;   // deleted with the shader
     bool heightmap_enabled;
     bool uses_texture = false;
 
     // --- Globalne zmienne renderera (zostawiam bez zmian) ---
-    GLuint worldPosFBO;          
-    GLuint worldPosTexture;      
-    GLuint worldPosDepthRBO;    
+    GLuint worldPosFBO = 0;
+    GLuint worldPosTexture = 0;
+    GLuint worldPosDepthRBO = 0;
 
     // Konstruktor teraz przyjmuje opcjonalny 3. argument
+    // defines are injected after #version, e.g. {"TERRAIN_CONTOURS"} -> #define TERRAIN_CONTOURS
     // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr) 
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr, const std::vector<std::string> &defines = {}) 
         : heightmap_enabled(false)
     {
         textures.clear();
         
         // 1. Retrieve the vertex/fragment/geometry source code
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::string geometryCode;
-
         std::ifstream vShaderFile;
         std::ifstream fShaderFile;
         std::ifstream gShaderFile;
@@ -88,86 +91,106 @@ public:
             std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
         }
 
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
-
-        // 2. Compile shaders
-        unsigned int vertex, fragment, geometry;
+        // 2. Compile the program, sources are kept for variants
+        add_variant(defines);
+    }
 
-        // Vertex Shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
+    // one owner per GL program, moves hand it over
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+    Shader(Shader &&o) noexcept
+        : ID(o.ID), textures(std::move(o.textures)), owned_textures(std::move(o.owned_textures)), heightmap_enabled(o.heightmap_enabled),
+          uses_texture(o.uses_texture), worldPosFBO(std::exchange(o.worldPosFBO, 0)), worldPosTexture(std::exchange(o.worldPosTexture, 0)),
+          worldPosDepthRBO(std::exchange(o.worldPosDepthRBO, 0)), vertexCode(std::move(o.vertexCode)), fragmentCode(std::move(o.fragmentCode)),
+          geometryCode(std::move(o.geometryCode)), programs(std::move(o.programs)), variant_defines(std::move(o.variant_defines)),
+          pending_uniforms(std::move(o.pending_uniforms)),
+          draw_variant(o.draw_variant), world_pos_variant(o.world_pos_variant), in_world_pos_pass(o.in_world_pos_pass) {
+        o.programs.clear();
+        o.owned_textures.clear();
+    }
 
-        // Fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
+    ~Shader() {
+        for (Texture *t : owned_textures) delete t;
+        if (!has_gl_context()) return;
+        for (unsigned int p : programs) glDeleteProgram(p);
+        if (worldPosFBO) glDeleteFramebuffers(1, &worldPosFBO);
+        if (worldPosTexture) glDeleteTextures(1, &worldPosTexture);
+        if (worldPosDepthRBO) glDeleteRenderbuffers(1, &worldPosDepthRBO);
+    }
 
-        // Geometry Shader (Optional)
-        if (geometryPath != nullptr)
-        {
-            const char* gShaderCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gShaderCode, NULL);
-            glCompileShader(geometry);
-            checkCompileErrors(geometry, "GEOMETRY");
-        }
+    /* Variants */
+    // The same sources compiled with another set of defines. Variants share the textures, set* calls reach the
+    // current program at once and the other variants the next time they are used. Uniforms set before a variant
+    // exists are not replayed to it, so add variants first. Returns the variant index, 0 is the constructor's.
+    int add_variant(const std::vector<std::string> &defines) {
+        unsigned int program = compile_program(defines);
+        programs.push_back(program);
+        variant_defines.push_back(defines);
+        pending_uniforms.emplace_back();
+        if (programs.size() == 1) ID = program;
+        return (int)programs.size() - 1;
+    }
 
-        // Shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if (geometryPath != nullptr)
-            glAttachShader(ID, geometry);
-            
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+    // variant used by the normal pass
+    void set_draw_variant(int variant) {
+        if (variant < 0 || variant >= (int)programs.size()) return;
+        draw_variant = variant;
+        if (!in_world_pos_pass) ID = programs[variant];
+    }
+    // variant used while rendering to the world position buffer, -1 keeps the draw variant with u_renderWorldPos
+    void set_world_pos_variant(int variant) {
+        if (variant >= (int)programs.size()) return;
+        world_pos_variant = variant;
+    }
 
-        // Delete the shaders as they're linked now
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (geometryPath != nullptr)
-            glDeleteShader(geometry);
+    int get_variant_num() const { return (int)programs.size(); }
+    int get_draw_variant() const { return draw_variant; }
+    int get_world_pos_variant() const { return world_pos_variant; }
+    bool is_in_world_pos_pass() const { return in_world_pos_pass; }
+    const std::vector<std::string>& get_variant_defines(int variant) const { return variant_defines[variant]; }
+    std::string get_variant_name(int variant) const {
+        std::string name;
+        for (const std::string &d : variant_defines[variant]) name += (name.empty() ? "" : " ") + d;
+        return name.empty() ? "base" : name;
     }
 
     void use() 
     { 
         glUseProgram(ID); 
+        apply_pending_uniforms();
         for (int i=0; i<textures.size(); i++) textures[i]->use(i);
     }
 
     void setBool(const std::string &name, bool value) const
     {          
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        set_uniform(name, [=](GLint location) { glUniform1i(location, (int)value); });
     }
     void setInt(const std::string &name, int value) const
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        set_uniform(name, [=](GLint location) { glUniform1i(location, value); });
     }
     void setFloat(const std::string &name, float value) const
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        set_uniform(name, [=](GLint location) { glUniform1f(location, value); });
     }
     void setVec2(const std::string &name, const glm::vec2 &value) const
     { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value)); 
+        set_uniform(name, [=](GLint location) { glUniform2fv(location, 1, glm::value_ptr(value)); });
     }
     void setVec3(const std::string &name, const glm::vec3 &value) const
     { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value)); 
+        set_uniform(name, [=](GLint location) { glUniform3fv(location, 1, glm::value_ptr(value)); });
     }
     void setVec4(const std::string &name, const glm::vec4&value) const
     { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value)); 
+        set_uniform(name, [=](GLint location) { glUniform4fv(location, 1, glm::value_ptr(value)); });
     }
     void setMatrix(const std::string &name, glm::mat4 matrix){
-        unsigned int loc = glGetUniformLocation(ID, name.c_str());
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(matrix));
+        set_uniform(name, [=](GLint location) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix)); });
     }
-    void addTexture(Texture* new_tex){
+    // take_ownership: the texture was made for this shader only and goes with it
+    void addTexture(Texture* new_tex, bool take_ownership = false){
+        if (take_ownership) owned_textures.push_back(new_tex);
         if (textures.size() >= MAX_TEXTURE_SLOTS) {
             std::cout<< "Max number of textures loaded reached!" << std::endl;
             return;
@@ -189,6 +212,7 @@ public:
         glBindTexture(GL_TEXTURE_2D, worldPosTexture);
         // **IMPORTANT:** Use a high-precision format! GL_RGB32F stores 3 floats (x, y, z).
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGB, GL_FLOAT, NULL);
+        TRACK_GL_BYTES(RESOURCE_TEXTURE, worldPosTexture, (size_t)SCR_WIDTH * SCR_HEIGHT * get_texel_bytes(GL_RGB32F));
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         // Attach this texture to the FBO
@@ -198,6 +222,7 @@ public:
         glGenRenderbuffers(1, &worldPosDepthRBO);
         glBindRenderbuffer(GL_RENDERBUFFER, worldPosDepthRBO);
         glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, SCR_WIDTH, SCR_HEIGHT);
+        TRACK_GL_BYTES(RESOURCE_RENDERBUFFER, worldPosDepthRBO, (size_t)SCR_WIDTH * SCR_HEIGHT * get_texel_bytes(GL_DEPTH_COMPONENT24));
         // Attach this RBO to the FBO
         glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, worldPosDepthRBO);
 
@@ -211,6 +236,8 @@ public:
     }
 
     void bind_world_pos_buffer () {
+        in_world_pos_pass = false;
+        ID = programs[draw_variant];
         use();
         setBool("u_renderWorldPos", false);
         glActiveTexture(GL_TEXTURE15);
@@ -218,6 +245,8 @@ public:
         setInt("world_pos_texture", 15);
     }
     void render_to_world_pos_buffer() {
+        in_world_pos_pass = true;
+        if (world_pos_variant >= 0) ID = programs[world_pos_variant];
         use();
         setBool("u_renderWorldPos", true);
     }
@@ -228,6 +257,99 @@ public:
     }
 
 private:
+    std::string vertexCode;
+    std::string fragmentCode;
+    std::string geometryCode;
+    std::vector<unsigned int> programs;
+    std::vector<std::vector<std::string>> variant_defines;
+    int draw_variant = 0;
+    int world_pos_variant = -1;
+    bool in_world_pos_pass = false;
+
+    // values set while another variant was bound, by uniform name, applied when the variant is used
+    mutable std::vector<std::map<std::string, std::function<void(GLint)>>> pending_uniforms;
+
+    // uniforms are per program: the bound one is set now, the other variants keep the latest value until used
+    template <typename F>
+    void set_uniform(const std::string &name, F f) const {
+        f(glGetUniformLocation(ID, name.c_str()));
+        if (programs.size() <= 1) return;
+        for (size_t i = 0; i < programs.size(); i++)
+            if (programs[i] != ID) pending_uniforms[i][name] = f;
+            else pending_uniforms[i].erase(name);
+    }
+    void apply_pending_uniforms() {
+        if (programs.size() <= 1) return;
+        for (size_t i = 0; i < programs.size(); i++) {
+            if (programs[i] != ID || pending_uniforms[i].empty()) continue;
+            for (auto &u : pending_uniforms[i]) u.second(glGetUniformLocation(ID, u.first.c_str()));
+            pending_uniforms[i].clear();
+        }
+    }
+
+    // #line keeps compiler messages pointing at the lines of the file
+    static std::string inject_defines(const std::string &code, const std::vector<std::string> &defines) {
+        if (defines.empty()) return code;
+        size_t version = code.find("#version");
+        size_t line_end = version == std::string::npos ? std::string::npos : code.find('\n', version);
+        if (line_end == std::string::npos) return code;
+        std::string block;
+        for (const std::string &d : defines) block += "#define " + d + "\n";
+        int version_line = (int)std::count(code.begin(), code.begin() + line_end, '\n') + 1;
+        block += "#line " + std::to_string(version_line + 1) + "\n";
+        return code.substr(0, line_end + 1) + block + code.substr(line_end + 1);
+    }
+
+    unsigned int compile_program(const std::vector<std::string> &defines) {
+        std::string vertexSource = inject_defines(vertexCode, defines);
+        std::string fragmentSource = inject_defines(fragmentCode, defines);
+        std::string geometrySource = inject_defines(geometryCode, defines);
+        const char* vShaderCode = vertexSource.c_str();
+        const char* fShaderCode = fragmentSource.c_str();
+        bool has_geometry = !geometryCode.empty();
+
+        unsigned int vertex, fragment, geometry;
+
+        // Vertex Shader
+        vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glCompileShader(vertex);
+        checkCompileErrors(vertex, "VERTEX");
+
+        // Fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glCompileShader(fragment);
+        checkCompileErrors(fragment, "FRAGMENT");
+
+        // Geometry Shader (Optional)
+        if (has_geometry)
+        {
+            const char* gShaderCode = geometrySource.c_str();
+            geometry = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(geometry, 1, &gShaderCode, NULL);
+            glCompileShader(geometry);
+            checkCompileErrors(geometry, "GEOMETRY");
+        }
+
+        // Shader Program
+        unsigned int program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        if (has_geometry)
+            glAttachShader(program, geometry);
+            
+        glLinkProgram(program);
+        checkCompileErrors(program, "PROGRAM");
+
+        // Delete the shaders as they're linked now
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        if (has_geometry)
+            glDeleteShader(geometry);
+        return program;
+    }
+
     void checkCompileErrors(unsigned int shader, std::string type)
     {
         int success;
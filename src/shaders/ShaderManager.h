@@ -6,6 +6,8 @@
 #include "textures/TextureData.h"
 #include "Heightmap.h"
 #include <glm/glm.hpp>
+#include <vector>
+#include <string>
 
 #define DEFAULT_WORLD_SHADER Shader(VERTEX_BASIC_PATH, FRAGMENT_BASIC_PATH)
 #define WORLD_UI_SHADER Shader(VERTEX_BASIC_PATH, FRAGMENT_UI_PATH)
@@ -25,14 +27,41 @@ public:
     //     return shader;
     // }
     
-    static Shader& get_terrain_shader(Texture *heightmap_tex, float heightmap_scale, Texture *texture = &TEXTURE_MISSING) {
-        static Shader shader = Shader(VERTEX_TERRAIN_PATH, FRAGMENT_TERRAIN_PATH);
-        shader.use();
-        shader.addTexture(texture); shader.setInt("texture", shader.get_last_loaded_tex_slot());
-        shader.addTexture(heightmap_tex); shader.setInt("heightmap", shader.get_last_loaded_tex_slot());
+    // one per terrain, the caller owns it: the textures it samples belong to that terrain
+    static Shader* new_terrain_shader(Texture *heightmap_tex, float heightmap_scale, Texture *texture) {
+        Shader *shader = new Shader(create_terrain_shader());
+        shader->use();
+        shader->addTexture(texture); shader->setInt("colour_texture", shader->get_last_loaded_tex_slot());
+        shader->addTexture(heightmap_tex); shader->setInt("heightmap", shader->get_last_loaded_tex_slot());
         return shader;
     }
+
+    static std::vector<std::string> get_terrain_variant_defines(bool baked_colour, bool contours, bool cursor) {
+        std::vector<std::string> defines = { "TERRAIN_VARIANT" };
+        if (baked_colour) defines.push_back("TERRAIN_BAKED_COLOUR");
+        if (contours) defines.push_back("TERRAIN_CONTOURS");
+        if (cursor) defines.push_back("TERRAIN_CURSOR");
+        return defines;
+    }
     
+private:
+    // draw variant from the settings and a world position only variant for the first pass,
+    // the remaining combinations only when they are timed against each other
+    static Shader create_terrain_shader() {
+        Shader shader(VERTEX_TERRAIN_PATH, FRAGMENT_TERRAIN_PATH, nullptr,
+            get_terrain_variant_defines(TERRAIN_SHADER_BAKED_COLOUR, TERRAIN_SHADER_CONTOURS, TERRAIN_SHADER_CURSOR));
+        shader.set_world_pos_variant(shader.add_variant({ "TERRAIN_VARIANT", "TERRAIN_WORLD_POS_ONLY" }));
+        if (TERRAIN_SHADER_PROFILE_FRAMES > 0) {
+            for (int f = 0; f < 8; f++) {
+                bool baked_colour = f & 1, contours = f & 2, cursor = f & 4;
+                if (baked_colour == TERRAIN_SHADER_BAKED_COLOUR && contours == TERRAIN_SHADER_CONTOURS && cursor == TERRAIN_SHADER_CURSOR) continue;
+                shader.add_variant(get_terrain_variant_defines(baked_colour, contours, cursor));
+            }
+            shader.add_variant({});     // the full shader with the runtime world position switch, for reference
+        }
+        return shader;
+    }
+
     // static Shader& get_screen_ui_shader() {
     //     static Shader shader = Shader(VERTEX_UI_PATH, FRAGMENT_UI_PATH);
     //     return shader;
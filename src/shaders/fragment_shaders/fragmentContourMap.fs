@@ -1,5 +1,17 @@
 #version 330 core
 
+// Variants (Shader::add_variant), built with TERRAIN_VARIANT the features are opt in:
+//   TERRAIN_WORLD_POS_ONLY - world position pass, nothing else
+//   TERRAIN_BAKED_COLOUR   - colour from the painter's texture instead of the gradients below
+//   TERRAIN_CONTOURS       - iso lines
+//   TERRAIN_CURSOR         - mouse cursor from the world position buffer
+// without it everything is drawn and u_renderWorldPos picks the pass
+#ifndef TERRAIN_VARIANT
+#define TERRAIN_CONTOURS
+#define TERRAIN_CURSOR
+#define TERRAIN_RUNTIME_WORLD_POS
+#endif
+
 in vec2 TexCoord;
 in vec3 v_worldPos;
 out vec4 FragColor;
@@ -10,7 +22,7 @@ uniform sampler2D world_pos_texture; // Tekstura z Pass 1
 uniform vec2 u_mouseCoords;        // Mysz w [0, 1]
 uniform float u_circleOuterRadius; // np. 10.0
 uniform float u_circleInnerRadius; // np. 8.0
-uniform sampler2D Texture;
+uniform sampler2D colour_texture;   // baked by TerrainPainter
 
  // --- Terrain height data ---
 uniform float terrain_max_height;
@@ -37,6 +49,9 @@ uniform float steepness_scale;
 // --- Terrain textures ---
 uniform sampler2D heightmap;
 uniform sampler2D terrain_area_data;
+uniform sampler2D terrain_gradient;     // grade per axis, RG16 from TerrainFields
+uniform float field_max_grade;
+uniform float grade_steepness_scale;    // grade to the 0-1 steepness of the gradients
 
 // --- Terrain water parameters ---
 uniform vec3 water_inside_colour;    
@@ -49,6 +64,11 @@ uniform float snow_level_height;
 uniform float snow_falloff_range;
 uniform float snow_max_steepness;
 
+// --- Reachability from the active path handle ---
+uniform bool reachability_enabled;
+uniform sampler2D reachability_map;     // weighted distance, 1.0 is out of reach
+uniform vec3 reachability_colour;
+
 /* Colours */
 const vec3 cursor_colour = vec3(0.0, 0.2, 1.0); // blue
 
@@ -56,12 +76,18 @@ const vec3 cursor_colour = vec3(0.0, 0.2, 1.0); // blue
 float gridLayer(float height, float spacing, float thickness, float zoom_fade_start);
 
 void main(){
+#ifdef TERRAIN_WORLD_POS_ONLY
+    FragColor = vec4(v_worldPos, 1.0);
+#else
+#ifdef TERRAIN_RUNTIME_WORLD_POS
     /* Render to depth buffer */
     if (u_renderWorldPos) {
         FragColor = vec4(v_worldPos, 1.0);
         return;
     }
+#endif
 
+#ifndef TERRAIN_BAKED_COLOUR
     /* Check if height map edge -> boundary colour */
     float texel_x = 1.f / heightmap_resolution_x;
     float texel_y = 1.f / heightmap_resolution_y;
@@ -71,18 +97,22 @@ void main(){
         FragColor = vec4(terrain_boundary_colour, 1.f);
         return;
     }  
+#endif
 
-    /* Get pixel height, elevation, and steepness (finite diff) */
+    /* Get pixel height, elevation, and steepness (shared terrain fields) */
     float local_height = texture(heightmap, TexCoord).r;
     float current_elevation = terrain_min_height + local_height * (terrain_max_height-terrain_min_height);
-    const int px_offset = 2;
-    float dx = textureOffset(heightmap, TexCoord, ivec2(px_offset,0)).r - textureOffset(heightmap, TexCoord, ivec2(-px_offset,0)).r;
-    float dy = textureOffset(heightmap, TexCoord, ivec2(0,px_offset)).r - textureOffset(heightmap, TexCoord, ivec2(0,-px_offset)).r;
-    float steepness = clamp(length(vec2(dx,dy)) * 0.5 * steepness_scale, 0.0, 1.0);
-    vec3 colour = vec3(0.0,0.0,0.0);
+    vec2 grade = (texture(terrain_gradient, TexCoord).rg * 2.0 - 1.0) * field_max_grade;
+    float steepness = clamp(length(grade) * grade_steepness_scale, 0.0, 1.0);
 
     /* Check pixel area */
     bool sea_pixel = current_elevation < water_level_height;
+
+#ifdef TERRAIN_BAKED_COLOUR
+    /* Colour, boundary, water and snow baked on the CPU */
+    vec3 colour = texture(colour_texture, TexCoord).rgb;
+#else
+    vec3 colour = vec3(0.0,0.0,0.0);
     bool dry_pixel = !sea_pixel;
     bool snow_pixel = current_elevation > snow_level_height;
 
@@ -112,7 +142,16 @@ void main(){
             colour = mix(colour, snow_colour.rgb, snow_transition*snow_colour.a);
         }
     }
+#endif
+
+    /* Reachability overlay */
+    if (reachability_enabled) {
+        float reach = texture(reachability_map, TexCoord).r;
+        if (reach > 0.999) colour *= 0.45;
+        else colour = mix(colour, reachability_colour, 0.5 * (1.0 - reach));
+    }
 
+#ifdef TERRAIN_CONTOURS
     /* Draw iso lines */
     if (!sea_pixel) {
         float base_spacing = 10.0; 
@@ -124,14 +163,18 @@ void main(){
         if (steepness < 0.001) total_line = 0.0;
         colour = mix(colour, iso_line_colour.rgb, total_line*iso_line_colour.a);
     }
+#endif
 
+#ifdef TERRAIN_CURSOR
     /* Draw mouse cursor on Terrain */
     vec3 mouseWorldPos = texture(world_pos_texture, u_mouseCoords).rgb;
     float dist = distance(v_worldPos, mouseWorldPos);
     colour = dist > u_circleInnerRadius && dist < u_circleOuterRadius ? cursor_colour : colour;
+#endif
 
     /* Final Colour */
     FragColor = vec4(colour, 1.0);
+#endif
 }
 
 float gridLayer(float height, float spacing, float thickness, float zoom_fade_start) {
@@ -11,30 +11,24 @@ uniform mat4 transform;
 uniform float terrain_offset_distance; 
 uniform int heightmap_resolution_x; 
 uniform int heightmap_resolution_y; 
+uniform sampler2D terrain_gradient;     // grade per axis, RG16 from TerrainFields
+uniform bool gradient_enabled;
+uniform float field_max_grade;
+uniform bool follow_terrain;            // false: points carry their own height (designed track, bridges and tunnels)
 
 vec2 local_to_uv (vec2 local) { return vec2(local.x + 0.5, local.y + 0.5); }
 
+// local space normal from the terrain gradient, taken to world space with the terrain transform
 vec3 calculate_terrain_normal(vec2 uv) {
-    float step_x = 1.f / heightmap_resolution_x;
-    float step_y = 1.f / heightmap_resolution_y;
-    float hL = texture(heightmap, uv - vec2(step_x, 0)).r * heightmap_scale; // Lewo
-    float hR = texture(heightmap, uv + vec2(step_x, 0)).r * heightmap_scale; // Prawo
-    float hD = texture(heightmap, uv - vec2(0, step_y)).r * heightmap_scale; // Dół
-    float hU = texture(heightmap, uv + vec2(0, step_y)).r * heightmap_scale; // Góra
-
-    vec3 normal = normalize(vec3(
-        hL - hR,
-        (step_x+step_y) * heightmap_scale * 20.0,
-        hD - hU
-    ));
-    return normal;
+    vec2 grade = gradient_enabled ? (texture(terrain_gradient, uv).rg * 2.0 - 1.0) * field_max_grade : vec2(0.0);
+    return normalize(mat3(transform) * vec3(-grade, 1.0));
 }
 
 void main()
 {
     vec2 local_pos = aPos.xy;
     vec2 uv = local_to_uv(local_pos);
-    float local_height = texture(heightmap, uv).r * heightmap_scale;
+    float local_height = follow_terrain ? texture(heightmap, uv).r * heightmap_scale : aPos.z;
     
     vec3 normal = calculate_terrain_normal(uv);
 
@@ -0,0 +1,331 @@
+#ifndef CONTOUREXTRACTOR_H
+#define CONTOUREXTRACTOR_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <iostream>
+#include "settings/Settings.h"
+#include "settings/Parallel.h"
+#include "rendering/ResourceTracker.h"
+#include "ElevationLineDrawer.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+enum ContourRank {
+    CONTOUR_MINOR = 0, CONTOUR_MEDIUM = 1, CONTOUR_MAJOR = 2
+};
+
+struct ContourLine {
+    float elevation;                    // [m]
+    int level;                          // elevation = level * spacing
+    ContourRank rank;
+    bool closed;                        // closed lines repeat their first point at the end
+    vector<vec3> points;                // terrain local space
+    vec2 min_corner, max_corner;
+};
+
+struct ContourSet {
+    float spacing = 0.f;
+    int first_level = 0;
+    vector<ContourLine> lines;          // ordered by level
+    vector<int> level_first_line;       // lines of level k are [level_first_line[k-first_level], level_first_line[k-first_level+1])
+};
+
+// CPU marching squares over the heightmap. Tiles run in parallel and their cell segments are cached
+// per (tile, spacing), segments are stitched into polylines per level through shared grid edge ids:
+// the segment ends of a level are sorted by edge id, so stitching memory follows the segment count
+// of the level and not the map size.
+class ContourExtractor
+{
+private:
+    // one cell crossing, ends are global grid edge ids
+    struct CellSegment {
+        int level;
+        int edge_a, edge_b;
+    };
+
+    ElevationLineDrawer *height_source;
+    const TerrainData *terrain_data;
+    bool debug_msg;
+
+    int width = 0, height = 0;          // heightmap pixels = grid nodes
+    int tiles_x = 0, tiles_y = 0;
+    bool range_loaded = false;
+    float min_elevation = 0.f, max_elevation = 0.f;
+    float min_reach = 0.f, reach = 0.f;  // [m] elevation of a [0,1] map height is min_reach + h * reach
+
+    unordered_map<long long, vector<CellSegment>> tile_cache;
+    unordered_map<int, ContourSet> set_cache;  // stitched sets by spacing key
+    vector<vector<uint64_t>> worker_edge_ends;  // per worker scratch, (edge id, segment end) of the level being stitched
+    TrackedMemory tracked_edge_ends;
+
+    // elevations are read from the shared heightmap, only their range is kept
+    void load_range() {
+        if (range_loaded || !height_source->is_loaded()) return;
+        width = height_source->get_map_width();
+        height = height_source->get_map_height();
+        tiles_x = (width - 2) / CONTOUR_TILE_SIZE + 1;
+        tiles_y = (height - 2) / CONTOUR_TILE_SIZE + 1;
+
+        min_reach = terrain_data->minimum_height_reach;
+        reach = terrain_data->maximum_height_reach - terrain_data->minimum_height_reach;
+        min_elevation = FLT_MAX;
+        max_elevation = -FLT_MAX;
+        for (size_t i = 0; i < (size_t)width * height; i++) {
+            float e = min_reach + height_source->get_pixel_height_unchecked(i) * reach;
+            min_elevation = std::min(min_elevation, e);
+            max_elevation = std::max(max_elevation, e);
+        }
+        range_loaded = true;
+    }
+
+    static int get_spacing_key(float spacing) { return (int)std::lround(spacing * 1000.f); }
+    static long long get_tile_key(int tile, float spacing) { return ((long long)get_spacing_key(spacing) << 32) | (unsigned int)tile; }
+
+    float get_elevation(int x, int y) const { return min_reach + height_source->get_pixel_height_unchecked((size_t)y * width + x) * reach; }
+
+    int get_h_edge(int x, int y) const { return 2 * (y * width + x); }     // (x,y) - (x+1,y)
+    int get_v_edge(int x, int y) const { return 2 * (y * width + x) + 1; } // (x,y) - (x,y+1)
+
+    // marching squares over the cells of one tile, a corner counts as inside when it is at or above the level
+    void extract_tile(int tile, float spacing, vector<CellSegment> &out) const {
+        out.clear();
+        int x_begin = (tile % tiles_x) * CONTOUR_TILE_SIZE, y_begin = (tile / tiles_x) * CONTOUR_TILE_SIZE;
+        int x_end = std::min(x_begin + CONTOUR_TILE_SIZE, width - 1), y_end = std::min(y_begin + CONTOUR_TILE_SIZE, height - 1);
+
+        for (int y = y_begin; y < y_end; y++) {
+            for (int x = x_begin; x < x_end; x++) {
+                float h[4] = { get_elevation(x, y), get_elevation(x+1, y), get_elevation(x+1, y+1), get_elevation(x, y+1) };
+                float cell_min = std::min(std::min(h[0], h[1]), std::min(h[2], h[3]));
+                float cell_max = std::max(std::max(h[0], h[1]), std::max(h[2], h[3]));
+                // levels with cell_min < level <= cell_max cross this cell
+                int first = (int)std::floor(cell_min / spacing) + 1, last = (int)std::floor(cell_max / spacing);
+                if (first > last) continue;
+
+                // bottom, right, top, left
+                int edges[4] = { get_h_edge(x, y), get_v_edge(x+1, y), get_h_edge(x, y+1), get_v_edge(x, y) };
+                for (int k = first; k <= last; k++) {
+                    float level = k * spacing;
+                    int c = (h[0] >= level) | (h[1] >= level) << 1 | (h[2] >= level) << 2 | (h[3] >= level) << 3;
+                    if (c == 5 || c == 10) {
+                        // saddle, the cell centre decides which corners are connected
+                        bool centre_inside = 0.25f * (h[0] + h[1] + h[2] + h[3]) >= level;
+                        if ((c == 5) == centre_inside) {
+                            out.push_back({ k, edges[0], edges[1] });
+                            out.push_back({ k, edges[2], edges[3] });
+                        } else {
+                            out.push_back({ k, edges[3], edges[0] });
+                            out.push_back({ k, edges[1], edges[2] });
+                        }
+                        continue;
+                    }
+                    // otherwise exactly two edges change side
+                    int found[2], n = 0;
+                    for (int e = 0; e < 4; e++) {
+                        bool a = (c >> e) & 1, b = (c >> ((e + 1) & 3)) & 1;
+                        if (a != b) found[n++] = edges[e];
+                    }
+                    out.push_back({ k, found[0], found[1] });
+                }
+            }
+        }
+    }
+
+    vec3 get_edge_point(int edge, float level) const {
+        int node = edge >> 1;
+        int x0 = node % width, y0 = node / width;
+        int x1 = x0 + ((edge & 1) ? 0 : 1), y1 = y0 + ((edge & 1) ? 1 : 0);
+        float h0 = get_elevation(x0, y0), h1 = get_elevation(x1, y1);
+        float t = h1 != h0 ? glm::clamp((level - h0) / (h1 - h0), 0.f, 1.f) : 0.f;
+        float raw = (level - terrain_data->minimum_height_reach) / (terrain_data->maximum_height_reach - terrain_data->minimum_height_reach);
+        return vec3(glm::mix((float)x0, (float)x1, t) / width - 0.5f, glm::mix((float)y0, (float)y1, t) / height - 0.5f,
+                    raw * height_source->get_height_scale());
+    }
+
+    // joins the segments of one level into polylines, open lines (ending on the map border) first
+    void stitch_level(int level, float spacing, const vector<CellSegment*> &segments, vector<uint64_t> &edge_ends, vector<ContourLine> &out) const {
+        int n = (int)segments.size();
+        if (n == 0) return;
+
+        // each grid edge is shared by at most two segment ends of one level, after sorting they are neighbours
+        edge_ends.resize(2 * n);
+        for (int end = 0; end < 2 * n; end++) {
+            int edge = (end & 1) ? segments[end >> 1]->edge_b : segments[end >> 1]->edge_a;
+            edge_ends[end] = (uint64_t)(uint32_t)edge << 32 | (uint32_t)end;
+        }
+        std::sort(edge_ends.begin(), edge_ends.end());
+        vector<int> partner(2 * n, -1);
+        for (int i = 0; i + 1 < 2 * n; i++) {
+            if (edge_ends[i] >> 32 != edge_ends[i+1] >> 32) continue;
+            int a = (int)(uint32_t)edge_ends[i], b = (int)(uint32_t)edge_ends[i+1];
+            partner[a] = b;
+            partner[b] = a;
+            i++;
+        }
+
+        float level_elevation = level * spacing;
+        vector<unsigned char> used(n, 0);
+        auto get_end_edge = [&](int end) { return (end & 1) ? segments[end >> 1]->edge_b : segments[end >> 1]->edge_a; };
+        auto walk = [&](int start_end, bool closed) {
+            ContourLine line;
+            line.elevation = level_elevation;
+            line.level = level;
+            line.rank = get_rank(level_elevation);
+            line.closed = closed;
+            line.points.push_back(get_edge_point(get_end_edge(start_end), level_elevation));
+            for (int end = start_end; ; ) {
+                used[end >> 1] = 1;
+                int other_end = end ^ 1;
+                line.points.push_back(get_edge_point(get_end_edge(other_end), level_elevation));
+                int next = partner[other_end];
+                if (next == -1 || used[next >> 1]) break;
+                end = next;
+            }
+            line.min_corner = vec2(FLT_MAX); line.max_corner = vec2(-FLT_MAX);
+            for (const vec3 &p : line.points) { line.min_corner = glm::min(line.min_corner, vec2(p)); line.max_corner = glm::max(line.max_corner, vec2(p)); }
+            out.push_back(std::move(line));
+        };
+
+        for (int end = 0; end < 2 * n; end++)
+            if (partner[end] == -1 && !used[end >> 1]) walk(end, false);
+        for (int i = 0; i < n; i++)
+            if (!used[i]) walk(2 * i, true);
+    }
+
+    static float distance_to_line(const ContourLine &line, vec2 p) {
+        float best = FLT_MAX;
+        for (size_t i = 0; i + 1 < line.points.size(); i++) {
+            vec2 a = vec2(line.points[i]), ab = vec2(line.points[i+1]) - a;
+            float len_sqr = dot(ab, ab);
+            float t = len_sqr > 0.f ? glm::clamp(dot(p - a, ab) / len_sqr, 0.f, 1.f) : 0.f;
+            best = std::min(best, glm::length(a + ab * t - p));
+        }
+        return best;
+    }
+
+public:
+    float last_extraction_ms = 0.f;
+
+    ContourExtractor(ElevationLineDrawer *height_source, const TerrainData *terrain_data, bool debug_msg = false)
+        : height_source(height_source), terrain_data(terrain_data), debug_msg(debug_msg) {}
+
+    // minor / medium / major like the shader grid layers
+    static ContourRank get_rank(float elevation) {
+        float minors = elevation / CONTOUR_MINOR_SPACING;
+        long m = std::lround(minors);
+        if (std::fabs(minors - (float)m) > 1e-3f) return CONTOUR_MINOR;
+        if (m % CONTOUR_MAJOR_MULTIPLIER == 0) return CONTOUR_MAJOR;
+        if (m % CONTOUR_MEDIUM_MULTIPLIER == 0) return CONTOUR_MEDIUM;
+        return CONTOUR_MINOR;
+    }
+
+    // all contour lines at multiples of spacing [m], tiles not in the cache are extracted in parallel
+    const ContourSet& extract(float spacing) {
+        auto cached_set = set_cache.find(get_spacing_key(spacing));
+        if (cached_set != set_cache.end()) return cached_set->second;
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        ContourSet &set = set_cache[get_spacing_key(spacing)];
+        set.spacing = spacing;
+        load_range();
+        if (!range_loaded || spacing <= 0.f) return set;
+
+        /* marching squares per tile */
+        int tile_num = tiles_x * tiles_y;
+        vector<int> missing;
+        for (int t = 0; t < tile_num; t++) if (!tile_cache.count(get_tile_key(t, spacing))) missing.push_back(t);
+        vector<vector<CellSegment>> extracted(missing.size());
+        parallel_for(0, (int)missing.size(), [&](int i, int worker) { extract_tile(missing[i], spacing, extracted[i]); });
+        for (size_t i = 0; i < missing.size(); i++) tile_cache[get_tile_key(missing[i], spacing)] = std::move(extracted[i]);
+
+        /* bucket segments by level */
+        set.first_level = (int)std::floor(min_elevation / spacing) + 1;
+        int level_num = std::max(0, (int)std::floor(max_elevation / spacing) - set.first_level + 1);
+        vector<vector<CellSegment*>> by_level(level_num);
+        for (int t = 0; t < tile_num; t++)
+            for (CellSegment &s : tile_cache[get_tile_key(t, spacing)]) by_level[s.level - set.first_level].push_back(&s);
+
+        /* stitch levels in parallel */
+        vector<vector<ContourLine>> level_lines(level_num);
+        worker_edge_ends.resize(std::max((int)worker_edge_ends.size(), get_worker_num(level_num)));
+        parallel_for(0, level_num, [&](int l, int worker) {
+            stitch_level(set.first_level + l, spacing, by_level[l], worker_edge_ends[worker], level_lines[l]);
+        });
+        size_t edge_end_bytes = 0;
+        for (const vector<uint64_t> &ends : worker_edge_ends) edge_end_bytes += get_capacity_bytes(ends);
+        TRACK_MEMORY(tracked_edge_ends, edge_end_bytes);
+
+        set.level_first_line.resize(level_num + 1);
+        for (int l = 0; l < level_num; l++) {
+            set.level_first_line[l] = (int)set.lines.size();
+            for (ContourLine &line : level_lines[l]) set.lines.push_back(std::move(line));
+        }
+        set.level_first_line[level_num] = (int)set.lines.size();
+
+        last_extraction_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+        if (debug_msg) std::cout << "Contours at " << spacing << "m: " << set.lines.size() << " lines in " << level_num
+            << " levels, extracted in " << last_extraction_ms << "ms (" << missing.size() << " tiles)." << std::endl;
+        return set;
+    }
+
+    // the line of the level closest to the elevation at local_pos that passes nearest to it, nullptr if none
+    const ContourLine* find_contour_through(vec2 local_pos, float spacing, float max_distance = FLT_MAX) {
+        const ContourSet &set = extract(spacing);
+        if (set.lines.empty() || std::fabs(local_pos.x) > 0.5f || std::fabs(local_pos.y) > 0.5f) return nullptr;
+
+        float px = glm::clamp((local_pos.x + 0.5f) * width, 0.f, (float)width - 1.001f);
+        float py = glm::clamp((local_pos.y + 0.5f) * height, 0.f, (float)height - 1.001f);
+        int x = (int)px, y = (int)py;
+        float sx = px - x, sy = py - y;
+        float h = glm::mix(glm::mix(get_elevation(x, y), get_elevation(x+1, y), sx), glm::mix(get_elevation(x, y+1), get_elevation(x+1, y+1), sx), sy);
+
+        int l = (int)std::lround(h / spacing) - set.first_level;
+        if (l < 0 || l >= (int)set.level_first_line.size() - 1) return nullptr;
+
+        const ContourLine *best = nullptr;
+        float best_distance = max_distance;
+        for (int i = set.level_first_line[l]; i < set.level_first_line[l+1]; i++) {
+            const ContourLine &line = set.lines[i];
+            float dx = std::max(std::max(line.min_corner.x - local_pos.x, 0.f), local_pos.x - line.max_corner.x);
+            float dy = std::max(std::max(line.min_corner.y - local_pos.y, 0.f), local_pos.y - line.max_corner.y);
+            if (dx*dx + dy*dy > best_distance*best_distance) continue;
+            float d = distance_to_line(line, local_pos);
+            if (d <= best_distance) { best_distance = d; best = &line; }
+        }
+        return best;
+    }
+
+    // drops cached tiles touching the pixel rectangle [x0,x1]x[y0,y1] and all stitched sets, for heightmap edits
+    void invalidate_pixels(int x0, int y0, int x1, int y1) {
+        set_cache.clear();
+        if (!range_loaded) return;
+        int tx0 = glm::clamp((x0 - 1) / CONTOUR_TILE_SIZE, 0, tiles_x - 1), tx1 = glm::clamp(x1 / CONTOUR_TILE_SIZE, 0, tiles_x - 1);
+        int ty0 = glm::clamp((y0 - 1) / CONTOUR_TILE_SIZE, 0, tiles_y - 1), ty1 = glm::clamp(y1 / CONTOUR_TILE_SIZE, 0, tiles_y - 1);
+        for (auto it = tile_cache.begin(); it != tile_cache.end(); ) {
+            int tile = (int)(it->first & 0xffffffffLL);
+            int tx = tile % tiles_x, ty = tile / tiles_x;
+            if (tx >= tx0 && tx <= tx1 && ty >= ty0 && ty <= ty1) it = tile_cache.erase(it);
+            else ++it;
+        }
+        // widen the range by the edited pixels only, it can only grow so no level is lost
+        for (int y = std::max(0, y0); y <= std::min(height - 1, y1); y++) {
+            for (int x = std::max(0, x0); x <= std::min(width - 1, x1); x++) {
+                float e = get_elevation(x, y);
+                min_elevation = std::min(min_elevation, e);
+                max_elevation = std::max(max_elevation, e);
+            }
+        }
+    }
+
+    void clear_cache() { tile_cache.clear(); set_cache.clear(); }
+};
+
+#endif
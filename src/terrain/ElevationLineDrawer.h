@@ -2,6 +2,7 @@
 #define ELEVATIONLINEDRAWER_H
 
 #include "textures/Texture.h"
+#include "rendering/ResourceTracker.h"
 #include "settings/Settings.h"
 #include "Heightmap.h" 
 #include "world_objects/Line.h"
@@ -10,12 +11,33 @@
 #include <algorithm>
 #include <glm/glm.hpp>
 #include <cfloat>
+#include <functional>
 
 // Helper for high-precision math
 #define PI 3.14159265359f
+
+// heightmap pixel reads are counted per thread (see get_thread_height_sample_num) when this is set before
+// the include, off by default so the sampling stays free
+#ifndef HEIGHT_SAMPLE_COUNTING
+#define HEIGHT_SAMPLE_COUNTING 0
+#endif
 using namespace glm;
 using namespace std;
 
+// inclusive rectangle of heightmap pixels
+struct PixelRect {
+    int x0, y0, x1, y1;
+
+    bool is_empty() const { return x1 < x0 || y1 < y0; }
+    void include(const PixelRect &r) {
+        if (r.is_empty()) return;
+        if (is_empty()) { *this = r; return; }
+        x0 = std::min(x0, r.x0); y0 = std::min(y0, r.y0);
+        x1 = std::max(x1, r.x1); y1 = std::max(y1, r.y1);
+    }
+    static PixelRect empty() { return { 0, 0, -1, -1 }; }
+};
+
 struct CachedPathData {
     vec2 start, end;
     float slope, step;
@@ -30,9 +52,12 @@ private:
     bool is_16bit_data;
     int hmap_width, hmap_height;
     bool height_data_loaded = false;
+    vector<unsigned short> memory_data;     // heights given in memory, height_data points into it
+    TrackedMemory tracked_heights;
 
     vector<vec3> cached_path;
     CachedPathData cached_path_data;
+    vector<std::function<void(const PixelRect&)>> edit_listeners;
 
 public:
     ElevationLineDrawer(const char* heightmap_path, float heightmap_scale, bool use_16bit = false) 
@@ -51,11 +76,22 @@ public:
             std::cerr << "ERROR: Failed to load heightmap data." << std::endl;
         } else {
             height_data_loaded = true;
+            TRACK_MEMORY(tracked_heights, (size_t)width * height * (is_16bit_data ? 2 : 1));
         }
     }
 
+    // 16 bit heights from memory (e.g. synthetic maps), rows bottom up like a flipped load
+    ElevationLineDrawer(vector<unsigned short> &&heights, int width, int height, float heightmap_scale)
+        : heightmap_scale(heightmap_scale), is_16bit_data(true), hmap_width(width), hmap_height(height), memory_data(std::move(heights))
+    {
+        height_data = memory_data.data();
+        height_data_loaded = width > 0 && height > 0 && memory_data.size() == (size_t)width * height;
+        if (!height_data_loaded) std::cerr << "ERROR: Heightmap data does not match its size." << std::endl;
+        TRACK_MEMORY(tracked_heights, get_capacity_bytes(memory_data));
+    }
+
     ~ElevationLineDrawer() {
-        if (height_data_loaded && height_data) {
+        if (height_data_loaded && height_data && memory_data.empty()) {
             stbi_image_free(height_data);
         }
     }
@@ -76,8 +112,60 @@ public:
     }
     glm::vec2 local_to_uv(glm::vec2 local) { return glm::vec2(local.x-0.5f,local.y-0.5f); }
 
+    /* raw heightmap access, [0,1] height per pixel */
+    bool is_loaded() const { return height_data_loaded; }
+    int get_map_width() const { return hmap_width; }
+    int get_map_height() const { return hmap_height; }
+    float get_height_scale() const { return heightmap_scale; }
+    float get_pixel_height(int x, int y) { return get_raw_height(x, y); }
+    bool is_16bit() const { return is_16bit_data; }
+    static long long& get_thread_height_sample_num() { thread_local long long sample_num = 0; return sample_num; }
+    const void* get_raw_data() const { return height_data; }
+    // [0,1] height of an in bounds pixel index, for loops over the shared map that do their own bounds checks
+    float get_pixel_height_unchecked(size_t index) const {
+        return is_16bit_data ? (float)static_cast<const unsigned short*>(height_data)[index] / 65535.0f
+                             : (float)static_cast<const unsigned char*>(height_data)[index] / 255.0f;
+    }
+
+    // [0,1] height, stored at the precision of the loaded map. rounding_offset in [0,1) is added before truncating,
+    // .5 rounds to nearest; a varying offset lets steps smaller than the map precision add up on average
+    void set_pixel_height(int x, int y, float h, float rounding_offset = .5f) {
+        if (!height_data_loaded || x < 0 || x >= hmap_width || y < 0 || y >= hmap_height) return;
+        size_t index = (size_t)y * hmap_width + x;
+        h = glm::clamp(h, 0.f, 1.f);
+        if (is_16bit_data) static_cast<unsigned short*>(height_data)[index] = (unsigned short)std::min(65535.f, std::floor(h * 65535.f + rounding_offset));
+        else static_cast<unsigned char*>(height_data)[index] = (unsigned char)std::min(255.f, std::floor(h * 255.f + rounding_offset));
+    }
+
+    // Heights are edited in place, whoever edits them reports the changed pixels once per edit. The drawer drops
+    // its own cached path, then every listener (textures, derived fields, caches) updates the rectangle.
+    void add_edit_listener(std::function<void(const PixelRect&)> listener) { edit_listeners.push_back(std::move(listener)); }
+    void notify_edited(const PixelRect &r) {
+        if (r.is_empty()) return;
+        vec2 box_min, box_max;
+        get_local_box(r, box_min, box_max);
+        invalidate_region(box_min, box_max);
+        for (const std::function<void(const PixelRect&)> &listener : edit_listeners) listener(r);
+    }
+
+    // local space box covering the pixel rectangle
+    void get_local_box(const PixelRect &r, vec2 &box_min, vec2 &box_max) const {
+        vec2 size = vec2(hmap_width, hmap_height);
+        box_min = vec2(r.x0, r.y0) / size - vec2(0.5f);
+        box_max = vec2(r.x1 + 1, r.y1 + 1) / size - vec2(0.5f);
+    }
+
+    // true if the xy bounds of the path overlap the local space box
+    static bool path_touches_box(const vector<vec3> &path, vec2 box_min, vec2 box_max) {
+        if (path.empty()) return false;
+        vec2 lo = vec2(path[0]), hi = vec2(path[0]);
+        for (const vec3 &p : path) { lo = glm::min(lo, vec2(p)); hi = glm::max(hi, vec2(p)); }
+        return lo.x <= box_max.x && hi.x >= box_min.x && lo.y <= box_max.y && hi.y >= box_min.y;
+    }
+
     /* Line drawing algorithm */
     void clear_cache() { cached_path.clear(); }
+    void invalidate_region(vec2 box_min, vec2 box_max) { if (path_touches_box(cached_path, box_min, box_max)) cached_path.clear(); }
     vector<vec3> generate_constant_slope_path(vec3 start, vec2 end, float slope, float step, bool direction = true) {
         
         if (!cached_path.empty() && 
@@ -90,47 +178,7 @@ public:
         }
         
         cached_path_data = { vec2(start), end, slope, step, 0 };
-        cached_path.clear();
-        cached_path.push_back(start);
-
-        int max_safety_steps = 2000;
-        float min_dist_to_end = length(end - vec2(start));
-        int min_dist_index = 0;
-
-        for(int i = 0; i < max_safety_steps; i++) {
-            /* get target direction */
-            vec2 end_dir = (end-vec2(cached_path.back()));
-            vec2 end_dir_normalise = end_dir / length(end_dir);
-            
-            /* add new point */
-            float target_height = cached_path.back().z + step*slope;
-            vec2 next_point = follow_slope_gradient(vec2(cached_path.back()) + end_dir_normalise*step, target_height);
-            cached_path.push_back( vec3(next_point, get_height_at_local_pos(next_point.x,next_point.y)) );
-
-            /* calculate final distances */
-            float dist = length(end-vec2(cached_path.back()));
-            float points_dist = length(vec2(cached_path.back())-vec2(cached_path[cached_path.size()-2]));
-            if (dist < min_dist_to_end) {
-                min_dist_to_end = dist;
-                min_dist_index = cached_path.size()-1;
-            }
-
-            /* exit conditions */
-            if (points_dist < 0.5*step) break;
-            if (dist > min_dist_to_end + step*20.f) break; // heuristic
-            if (dist < step) break;
-        }
-
-        /* Path smoothing */
-        if (cached_path.size() > 2) {
-            vector<vec3> smoothed = cached_path;
-            for(int i = 1; i < cached_path.size() - 1; i++) {
-                smoothed[i] = (cached_path[i-1] + cached_path[i] + cached_path[i+1]) / 3.0f;
-            }
-            cached_path = smoothed;
-        }
-
-        if (min_dist_index < cached_path.size() - 1) cached_path.resize(min_dist_index+1);
+        cached_path = trace_slope_path(start, end, slope, step);
         return cached_path;
     }
     vector<vec3> generate_auto_slope_path(vec3 start, vec2 end, float max_slope, float step, bool direction = true) {
@@ -145,35 +193,56 @@ public:
         }
         
         cached_path_data = { vec2(start), end, max_slope, step, 1 };
-        cached_path.clear();
-        cached_path.push_back(start);
+        cached_path = trace_slope_path(start, end, get_auto_slope(start, end, max_slope), step);
+        return cached_path;
+    }
 
-        // Calculate automatic slope
+    // slope needed to reach the end height in a straight line, clamped to the max slope
+    float get_auto_slope(vec3 start, vec2 end, float max_slope) {
         float end_z = get_height_at_local_pos(end.x, end.y);
         float total_dist = length(end - vec2(start));
         float needed_slope = (end_z - start.z) / (total_dist > 0.001f ? total_dist : 1.f);
-        float actual_slope = glm::clamp(needed_slope, -max_slope, max_slope);
+        return glm::clamp(needed_slope, -max_slope, max_slope);
+    }
+
+    // Steps towards end holding the slope, every step is projected back onto the target height along the gradient.
+    // direction_bias [rad] turns the step direction to one side, fading out as the path nears the end, so paths
+    // can be pushed around either side of a hill. Does not touch the cache and only reads the heightmap,
+    // so candidates can be traced from several threads. stop sees the raw path before every step and ends
+    // the trace when it returns true; without smoothing the raw path is returned, cut at its point nearest to end.
+    vector<vec3> trace_slope_path(vec3 start, vec2 end, float slope, float step, float direction_bias = 0.f,
+                                  const std::function<bool(const vector<vec3>&)> &stop = nullptr, bool smooth = true) {
+        vector<vec3> path;
+        path.push_back(start);
 
         int max_safety_steps = 2000;
-        float min_dist_to_end = length(end - vec2(start));
+        float start_dist = length(end - vec2(start));
+        float min_dist_to_end = start_dist;
         int min_dist_index = 0;
 
         for(int i = 0; i < max_safety_steps; i++) {
+            if (stop && stop(path)) break;
+
             /* get target direction */
-            vec2 end_dir = (end-vec2(cached_path.back()));
+            vec2 end_dir = (end-vec2(path.back()));
             vec2 end_dir_normalise = end_dir / length(end_dir);
+            if (direction_bias != 0.f) {
+                float angle = direction_bias * glm::clamp(length(end_dir) / (start_dist > 0.f ? start_dist : 1.f), 0.f, 1.f);
+                float c = cos(angle), s = sin(angle);
+                end_dir_normalise = vec2(c*end_dir_normalise.x - s*end_dir_normalise.y, s*end_dir_normalise.x + c*end_dir_normalise.y);
+            }
             
             /* add new point */
-            float target_height = cached_path.back().z + step*actual_slope;
-            vec2 next_point = follow_slope_gradient(vec2(cached_path.back()) + end_dir_normalise*step, target_height);
-            cached_path.push_back( vec3(next_point, get_height_at_local_pos(next_point.x,next_point.y)) );
+            float target_height = path.back().z + step*slope;
+            vec2 next_point = follow_slope_gradient(vec2(path.back()) + end_dir_normalise*step, target_height);
+            path.push_back( vec3(next_point, get_height_at_local_pos(next_point.x,next_point.y)) );
 
             /* calculate final distances */
-            float dist = length(end-vec2(cached_path.back()));
-            float points_dist = length(vec2(cached_path.back())-vec2(cached_path[cached_path.size()-2]));
+            float dist = length(end-vec2(path.back()));
+            float points_dist = length(vec2(path.back())-vec2(path[path.size()-2]));
             if (dist < min_dist_to_end) {
                 min_dist_to_end = dist;
-                min_dist_index = cached_path.size()-1;
+                min_dist_index = path.size()-1;
             }
 
             /* exit conditions */
@@ -182,18 +251,21 @@ public:
             if (dist < step) break;
         }
 
-        /* Path smoothing */
-        if (cached_path.size() > 2) {
-            vector<vec3> smoothed = cached_path;
-            for(int i = 1; i < cached_path.size() - 1; i++) {
-                smoothed[i] = (cached_path[i-1] + cached_path[i] + cached_path[i+1]) / 3.0f;
-            }
-            cached_path = smoothed;
-        }
+        if (smooth) smooth_path(path);
 
         //points.pop_back(); // last point was further from end than second to last, remove it
-        if (min_dist_index < cached_path.size() - 1) cached_path.resize(min_dist_index+1);
-        return cached_path;
+        if (min_dist_index < path.size() - 1) path.resize(min_dist_index+1);
+        return path;
+    }
+
+    // every inner point moves to the mean of itself and its neighbours
+    static void smooth_path(vector<vec3> &path) {
+        if (path.size() <= 2) return;
+        vector<vec3> smoothed = path;
+        for(int i = 1; i < path.size() - 1; i++) {
+            smoothed[i] = (path[i-1] + path[i] + path[i+1]) / 3.0f;
+        }
+        path = smoothed;
     }
 
 private:
@@ -216,6 +288,9 @@ private:
     }
 
     float get_raw_height(int x, int y) {
+        #if HEIGHT_SAMPLE_COUNTING
+            get_thread_height_sample_num()++;
+        #endif
         if (x < 0 || x >= hmap_width || y < 0 || y >= hmap_height) return 0.0f;
         size_t index = (size_t)y * hmap_width + x;
 
@@ -3,6 +3,7 @@
 #ifndef HEIGHTMAP_H
 #define HEIGHTMAP_H
 
+#include <utility>
 #include "textures/Texture.h"
 #include "settings/Settings.h"
 
@@ -14,7 +15,7 @@ public:
     const char* map_name;
 
     Heightmap(Texture height_data, float min_height, float max_height, float scale, const char* map_name = "Default Heightmap")
-        : height_data(height_data), min_height(min_height), max_height(max_height), scale(scale), water_level_height(WATER_LEVEL_HEIGHT_DEFAULT), map_name(map_name)
+        : height_data(std::move(height_data)), min_height(min_height), max_height(max_height), scale(scale), water_level_height(WATER_LEVEL_HEIGHT_DEFAULT), map_name(map_name)
     { }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,543 @@
+#ifndef HYDROLOGY_H
+#define HYDROLOGY_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <future>
+#include "settings/Settings.h"
+#include "settings/Parallel.h"
+#include "rendering/ResourceTracker.h"
+#include "ElevationLineDrawer.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+#define HYDRO_LEVEL_NUM 65536               // heights are quantised to 16 bit levels, one queue bucket per level
+#define HYDRO_LABEL_OCEAN 1                 // watershed label of everything draining off the map or into the sea
+
+struct HydrologyLake {
+    float level;                            // [m] water surface
+    float area;                             // [m^2]
+    float max_depth;                        // [m]
+    int cell_num;
+    vec2 bbox_min, bbox_max;                // terrain local space
+    vector<vec2> outline;                   // outer shore, terrain local space, closed (last point != first)
+};
+
+// Drainage of the heightfield: priority-flood depression filling, D8 flow directions and flow accumulation.
+// Filling follows Barnes' parallel priority-flood: every tile is flooded from its own border with a bucketed
+// queue, labelling which border cell each cell drains through, the labels are then joined across tiles by
+// their lowest spill heights and every cell is raised to the level its label spills at.
+class Hydrology
+{
+private:
+    ElevationLineDrawer *height_source;
+    const TerrainData *terrain_data;
+    float metres_per_unit;
+    bool debug_msg;
+
+    int width = 0, height = 0;
+    int sea_level = -1;                     // height level of the sea, -1 without one
+    const uint16_t *dem = nullptr;          // height levels, the shared 16 bit heightmap itself or dem_copy
+    vector<uint16_t> dem_copy, filled;      // dem_copy: 8 bit maps widened to 16 bit levels, or the heights of an async pass
+    vector<int> label;
+    vector<signed char> receiver;           // D8 index of the downstream neighbour, -1 drains off the map or into the sea
+    vector<float> accumulation;             // cells upstream of and including the cell
+    vector<unsigned char> river_strength;
+    vector<int> lake_id;                    // -1 outside lakes
+    vector<HydrologyLake> lakes;
+    TrackedMemory tracked_fields;
+
+    std::unique_ptr<Hydrology> pending;     // pass running on another thread, its result replaces this one
+    std::future<void> pending_done;
+    bool rerun = false;                     // heights changed again while the pending pass ran
+
+    const int dx[8] = { 1, 1, 0, -1, -1, -1, 0, 1 }, dy[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+    struct SpillEdge {
+        int a, b;
+        uint16_t level;
+    };
+
+    inline bool inside(int x, int y) const { return x >= 0 && y >= 0 && x < width && y < height; }
+
+    /* Filling */
+
+    // flood of one tile from its border, spill edges between labels met inside the tile go to edges
+    void flood_tile(int x0, int y0, int x1, int y1, int first_label, vector<vector<int>> &buckets, vector<SpillEdge> &edges) {
+        int next_label = first_label;
+        int lowest = HYDRO_LEVEL_NUM;
+        auto push = [&](int c, uint16_t level) {
+            buckets[level].push_back(c);
+            lowest = std::min(lowest, (int)level);
+        };
+
+        // border of the tile and sea cells are the seeds, the map border and the sea drain to the ocean
+        for (int y = y0; y < y1; y++) {
+            for (int x = x0; x < x1; x++) {
+                int c = y * width + x;
+                bool tile_border = x == x0 || y == y0 || x == x1 - 1 || y == y1 - 1;
+                bool ocean = is_outlet(c);
+                label[c] = ocean ? HYDRO_LABEL_OCEAN : 0;
+                if (!tile_border && !ocean) continue;
+                filled[c] = dem[c];
+                push(c, dem[c]);
+                if (!ocean) label[c] = -1; // seeded, gets its own label when popped
+            }
+        }
+
+        unordered_map<uint64_t, uint16_t> spill;
+        for (int level = lowest; level < HYDRO_LEVEL_NUM; level++) {
+            vector<int> &bucket = buckets[level];
+            for (size_t q = 0; q < bucket.size(); q++) { // cells raised to this level are appended and handled in order
+                int c = bucket[q];
+                if (label[c] == -1) label[c] = next_label++;
+                int x = c % width, y = c / width;
+                for (int k = 0; k < 8; k++) {
+                    int nx = x + dx[k], ny = y + dy[k];
+                    if (nx < x0 || ny < y0 || nx >= x1 || ny >= y1) continue;
+                    int n = ny * width + nx;
+                    if (label[n] == 0) {
+                        label[n] = label[c];
+                        filled[n] = std::max(dem[n], (uint16_t)level);
+                        if (filled[n] == level) bucket.push_back(n);
+                        else push(n, filled[n]);
+                    }
+                    else if (label[n] > 0 && label[n] != label[c]) {
+                        int a = std::min(label[n], label[c]), b = std::max(label[n], label[c]);
+                        uint16_t spill_level = std::max(filled[c], filled[n]);
+                        uint64_t key = ((uint64_t)a << 32) | (uint32_t)b;
+                        auto it = spill.find(key);
+                        if (it == spill.end()) spill[key] = spill_level;
+                        else it->second = std::min(it->second, spill_level);
+                    }
+                }
+            }
+            bucket.clear();
+        }
+        for (auto &e : spill) edges.push_back({ (int)(e.first >> 32), (int)(e.first & 0xffffffffu), e.second });
+    }
+
+    void fill_depressions() {
+        int tile = HYDRO_TILE_SIZE;
+        int tiles_x = (width + tile - 1) / tile, tiles_y = (height + tile - 1) / tile, tile_num = tiles_x * tiles_y;
+        int label_stride = 4 * tile; // only border cells start labels
+
+        filled.assign((size_t)width * height, 0);
+        label.assign((size_t)width * height, 0);
+        vector<vector<SpillEdge>> tile_edges(tile_num);
+        vector<vector<vector<int>>> worker_buckets(get_worker_num(tile_num));
+
+        auto tile_bounds = [&](int t, int &x0, int &y0, int &x1, int &y1) {
+            x0 = (t % tiles_x) * tile; y0 = (t / tiles_x) * tile;
+            x1 = std::min(width, x0 + tile); y1 = std::min(height, y0 + tile);
+        };
+
+        parallel_for(0, tile_num, [&](int t, int worker) {
+            vector<vector<int>> &buckets = worker_buckets[worker];
+            if (buckets.empty()) buckets.resize(HYDRO_LEVEL_NUM);
+            int x0, y0, x1, y1;
+            tile_bounds(t, x0, y0, x1, y1);
+            flood_tile(x0, y0, x1, y1, HYDRO_LABEL_OCEAN + 1 + t * label_stride, buckets, tile_edges[t]);
+        });
+        worker_buckets.clear();
+
+        // spill edges across tile borders, each tile looks right and down
+        parallel_for(0, tile_num, [&](int t, int worker) {
+            int x0, y0, x1, y1;
+            tile_bounds(t, x0, y0, x1, y1);
+            unordered_map<uint64_t, uint16_t> spill;
+            auto link = [&](int c, int n) {
+                if (label[c] == label[n]) return;
+                int a = std::min(label[c], label[n]), b = std::max(label[c], label[n]);
+                uint16_t spill_level = std::max(filled[c], filled[n]);
+                uint64_t key = ((uint64_t)a << 32) | (uint32_t)b;
+                auto it = spill.find(key);
+                if (it == spill.end()) spill[key] = spill_level;
+                else it->second = std::min(it->second, spill_level);
+            };
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) {
+                    bool right = x == x1 - 1 && x1 < width, down = y == y1 - 1 && y1 < height;
+                    if (!right && !down) continue;
+                    int c = y * width + x;
+                    for (int k = 0; k < 8; k++) {
+                        int nx = x + dx[k], ny = y + dy[k];
+                        if (!inside(nx, ny) || (nx < x1 && ny < y1) || nx < x0 || ny < y0) continue;
+                        link(c, ny * width + nx);
+                    }
+                    // the lower left diagonal crosses into the tile below from the left column too
+                    if (down && x == x0 && x0 > 0) link(c, (y + 1) * width + x - 1);
+                }
+            }
+            for (auto &e : spill) tile_edges[t].push_back({ (int)(e.first >> 32), (int)(e.first & 0xffffffffu), e.second });
+        });
+
+        /* spill levels of all labels, a minimax flood over the label graph from the ocean */
+        int label_num = HYDRO_LABEL_OCEAN + 1 + tile_num * label_stride;
+        vector<int> first_edge(label_num + 1, 0);
+        size_t edge_num = 0;
+        for (const vector<SpillEdge> &edges : tile_edges)
+            for (const SpillEdge &e : edges) { first_edge[e.a + 1]++; first_edge[e.b + 1]++; edge_num += 2; }
+        for (int l = 0; l < label_num; l++) first_edge[l + 1] += first_edge[l];
+        vector<pair<int, uint16_t>> adjacent(edge_num);
+        vector<int> fill_pos(first_edge.begin(), first_edge.end() - 1);
+        for (const vector<SpillEdge> &edges : tile_edges) {
+            for (const SpillEdge &e : edges) {
+                adjacent[fill_pos[e.a]++] = { e.b, e.level };
+                adjacent[fill_pos[e.b]++] = { e.a, e.level };
+            }
+        }
+        tile_edges.clear();
+
+        vector<uint16_t> label_level(label_num, HYDRO_LEVEL_NUM - 1);
+        vector<unsigned char> done(label_num, 0);
+        vector<pair<int,int>> queue; // (level, label) min heap
+        label_level[HYDRO_LABEL_OCEAN] = 0;
+        queue.push_back({ 0, HYDRO_LABEL_OCEAN });
+        while (!queue.empty()) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<pair<int,int>>());
+            int l = queue.back().second;
+            queue.pop_back();
+            if (done[l]) continue;
+            done[l] = 1;
+            for (int e = first_edge[l]; e < first_edge[l + 1]; e++) {
+                int n = adjacent[e].first;
+                uint16_t level = std::max(label_level[l], adjacent[e].second);
+                if (done[n] || level >= label_level[n]) continue;
+                label_level[n] = level;
+                queue.push_back({ level, n });
+                std::push_heap(queue.begin(), queue.end(), std::greater<pair<int,int>>());
+            }
+        }
+
+        parallel_for(0, height, [&](int y, int worker) {
+            for (int x = 0; x < width; x++) {
+                int c = y * width + x;
+                filled[c] = std::max(filled[c], label_level[label[c]]);
+            }
+        });
+        label = vector<int>();
+    }
+
+    /* Flow */
+
+    // steepest descent on the filled surface, flats drain towards their lowest edge by a breadth first search
+    void compute_flow_directions() {
+        receiver.assign((size_t)width * height, -1);
+        float metres_x = metres_per_unit / width, metres_y = metres_per_unit / height;
+        float inv_step_length[8];
+        for (int k = 0; k < 8; k++) inv_step_length[k] = 1.f / std::sqrt(dx[k] * dx[k] * metres_x * metres_x + dy[k] * dy[k] * metres_y * metres_y);
+
+        parallel_for(0, height, [&](int y, int worker) {
+            for (int x = 0; x < width; x++) {
+                int c = y * width + x;
+                if (is_outlet(c)) continue;
+                float best = 0.f;
+                for (int k = 0; k < 8; k++) {
+                    int n = (y + dy[k]) * width + x + dx[k];
+                    if (filled[n] >= filled[c]) continue;
+                    float drop = (filled[c] - filled[n]) * inv_step_length[k];
+                    if (drop > best) { best = drop; receiver[c] = (signed char)k; }
+                }
+            }
+        });
+
+        // every flat cell drains to a same level neighbour that is closer to a way down,
+        // the search starts from the cells next to flats that already drain
+        int n = width * height;
+        vector<unsigned char> reached(n);
+        parallel_for(0, height, [&](int y, int worker) {
+            for (int x = 0; x < width; x++) reached[y * width + x] = receiver[y * width + x] >= 0 || is_outlet(y * width + x);
+        });
+        vector<unsigned char> seed(n, 0);
+        parallel_for(0, height, [&](int y, int worker) {
+            for (int x = 0; x < width; x++) {
+                int c = y * width + x;
+                if (!reached[c]) continue;
+                for (int k = 0; k < 8; k++) {
+                    int nx = x + dx[k], ny = y + dy[k];
+                    if (inside(nx, ny) && !reached[ny * width + nx] && filled[ny * width + nx] == filled[c]) { seed[c] = 1; break; }
+                }
+            }
+        });
+        vector<int> queue;
+        for (int c = 0; c < n; c++) if (seed[c]) queue.push_back(c);
+        for (size_t q = 0; q < queue.size(); q++) {
+            int c = queue[q], x = c % width, y = c / width;
+            for (int k = 0; k < 8; k++) {
+                int nx = x + dx[k], ny = y + dy[k];
+                if (!inside(nx, ny)) continue;
+                int m = ny * width + nx;
+                if (reached[m] || filled[m] != filled[c]) continue;
+                reached[m] = 1;
+                receiver[m] = (signed char)((k + 4) & 7); // back towards c
+                queue.push_back(m);
+            }
+        }
+    }
+
+    // map border and the sea
+    bool is_outlet(int c) const {
+        int x = c % width, y = c / width;
+        return x == 0 || y == 0 || x == width - 1 || y == height - 1 || (sea_level >= 0 && dem[c] <= sea_level);
+    }
+
+    // upstream cell count, cells are handled once all their donors are
+    void compute_accumulation() {
+        int n = width * height;
+        accumulation.assign(n, 1.f);
+        vector<unsigned char> donor_num(n, 0);
+        for (int c = 0; c < n; c++) if (receiver[c] >= 0) donor_num[downstream(c)]++;
+        vector<int> stack;
+        for (int c = 0; c < n; c++) if (donor_num[c] == 0) stack.push_back(c);
+        while (!stack.empty()) {
+            int c = stack.back();
+            stack.pop_back();
+            if (receiver[c] < 0) continue;
+            int d = downstream(c);
+            accumulation[d] += accumulation[c];
+            if (--donor_num[d] == 0) stack.push_back(d);
+        }
+
+        float cell_area = (metres_per_unit / width) * (metres_per_unit / height);
+        float range = std::log(HYDRO_RIVER_FULL_AREA / HYDRO_RIVER_MIN_AREA);
+        river_strength.resize(n);
+        parallel_for(0, height, [&](int y, int worker) {
+            for (int x = 0; x < width; x++) {
+                int c = y * width + x;
+                float strength = std::log(std::max(accumulation[c] * cell_area / HYDRO_RIVER_MIN_AREA, 1.f)) / range;
+                river_strength[c] = (unsigned char)(glm::clamp(strength, 0.f, 1.f) * 255.f);
+            }
+        });
+    }
+
+    inline int downstream(int c) const { return c + dy[receiver[c]] * width + dx[receiver[c]]; }
+
+    /* Lakes */
+
+    void find_lakes() {
+        int n = width * height;
+        lake_id.assign(n, -1);
+        lakes.clear();
+        float cell_area = (metres_per_unit / width) * (metres_per_unit / height);
+        float level_to_metres = (terrain_data->maximum_height_reach - terrain_data->minimum_height_reach) / (HYDRO_LEVEL_NUM - 1);
+
+        vector<int> queue;
+        for (int start = 0; start < n; start++) {
+            if (lake_id[start] != -1 || filled[start] <= dem[start]) continue;
+            // 4-connected cells under water
+            int id = (int)lakes.size();
+            queue.assign(1, start);
+            lake_id[start] = id;
+            int max_depth = 0;
+            for (size_t q = 0; q < queue.size(); q++) {
+                int c = queue[q], x = c % width, y = c / width;
+                max_depth = std::max(max_depth, filled[c] - dem[c]);
+                for (int k = 0; k < 8; k += 2) {
+                    int nx = x + dx[k], ny = y + dy[k];
+                    if (!inside(nx, ny)) continue;
+                    int m = ny * width + nx;
+                    if (lake_id[m] == -1 && filled[m] > dem[m]) { lake_id[m] = id; queue.push_back(m); }
+                }
+            }
+            if ((int)queue.size() < HYDRO_LAKE_MIN_CELLS) {
+                for (int c : queue) lake_id[c] = -2; // too small, but already visited
+                continue;
+            }
+
+            HydrologyLake lake;
+            lake.level = terrain_data->minimum_height_reach + filled[start] * level_to_metres;
+            lake.cell_num = (int)queue.size();
+            lake.area = lake.cell_num * cell_area;
+            lake.max_depth = max_depth * level_to_metres;
+            lake.outline = trace_outline(start, id);
+            lake.bbox_min = vec2(1.f); lake.bbox_max = vec2(-1.f);
+            for (vec2 p : lake.outline) { lake.bbox_min = glm::min(lake.bbox_min, p); lake.bbox_max = glm::max(lake.bbox_max, p); }
+            lakes.push_back(lake);
+        }
+        for (int &id : lake_id) if (id == -2) id = -1;
+    }
+
+    // follows the cell edges around the lake keeping it on the right, start is its first cell in scan order
+    vector<vec2> trace_outline(int start, int id) const {
+        vector<vec2> outline;
+        auto is_lake = [&](int x, int y) { return inside(x, y) && lake_id[y * width + x] == id; };
+        int first_x = start % width, first_y = start / width;
+        int x = first_x, y = first_y, dir_x = 1, dir_y = 0;
+        do { // the first corner has no other lake cell around it, so the walk only comes back to it at the end
+            int right_x = -dir_y, right_y = dir_x;
+            // cells ahead of the corner, cell (x,y) spans corners (x,y) to (x+1,y+1)
+            bool ahead_right = is_lake(x + (dir_x + right_x - 1) / 2, y + (dir_y + right_y - 1) / 2);
+            bool ahead_left = is_lake(x + (dir_x - right_x - 1) / 2, y + (dir_y - right_y - 1) / 2);
+            int next_x = dir_x, next_y = dir_y;
+            if (!ahead_right) { next_x = right_x; next_y = right_y; }
+            else if (ahead_left) { next_x = -right_x; next_y = -right_y; }
+            if (next_x != dir_x || next_y != dir_y || outline.empty())
+                outline.push_back(vec2((float)x / width - 0.5f, (float)y / height - 0.5f));
+            dir_x = next_x; dir_y = next_y;
+            x += dir_x; y += dir_y;
+        } while (x != first_x || y != first_y);
+        return outline;
+    }
+
+    /* Passes */
+
+    // copy: the pass does not read the shared heightmap, so it can run while the map is edited
+    void load_heights(bool copy) {
+        width = height_source->get_map_width();
+        height = height_source->get_map_height();
+        size_t n = (size_t)width * height;
+        if (height_source->is_16bit() && !copy) {
+            dem = static_cast<const uint16_t*>(height_source->get_raw_data());
+            dem_copy = vector<uint16_t>();
+        }
+        else if (height_source->is_16bit()) {
+            const uint16_t *raw = static_cast<const uint16_t*>(height_source->get_raw_data());
+            dem_copy.assign(raw, raw + n);
+            dem = dem_copy.data();
+        }
+        else {
+            const unsigned char *raw = static_cast<const unsigned char*>(height_source->get_raw_data());
+            dem_copy.resize(n);
+            for (size_t c = 0; c < n; c++) dem_copy[c] = (uint16_t)(raw[c] * 257);   // 255 -> 65535
+            dem = dem_copy.data();
+        }
+        float sea_raw = (terrain_data->water_level_height - terrain_data->minimum_height_reach)
+                      / (terrain_data->maximum_height_reach - terrain_data->minimum_height_reach);
+        sea_level = sea_raw >= 0.f ? (int)(std::min(sea_raw, 1.f) * (HYDRO_LEVEL_NUM - 1)) : -1;
+    }
+
+    void solve() {
+        if (!height_source->is_loaded()) return;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        fill_depressions();
+        compute_flow_directions();
+        compute_accumulation();
+        find_lakes();
+        TRACK_MEMORY(tracked_fields, get_capacity_bytes(dem_copy, filled, label, receiver, accumulation, river_strength, lake_id));
+
+        last_compute_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+        if (debug_msg) std::cout << "Hydrology of " << width << "x" << height << ": " << lakes.size() << " lakes, computed in "
+                                 << last_compute_ms << "ms." << std::endl;
+    }
+
+    // tiles where rivers or lakes of next differ from the current result, all of them if the sizes differ
+    vector<PixelRect> get_changed_tiles(const Hydrology &next, int tile_size) const {
+        int tiles_x = (next.width + tile_size - 1) / tile_size, tiles_y = (next.height + tile_size - 1) / tile_size;
+        bool same_size = width == next.width && height == next.height && river_strength.size() == next.river_strength.size();
+        vector<unsigned char> differs(tiles_x * tiles_y, !same_size);
+        if (same_size) parallel_for(0, tiles_x * tiles_y, [&](int t, int worker) {
+            int x0 = (t % tiles_x) * tile_size, y0 = (t / tiles_x) * tile_size;
+            int x1 = std::min(width, x0 + tile_size), y1 = std::min(height, y0 + tile_size);
+            for (int y = y0; y < y1 && !differs[t]; y++)
+                for (int x = x0; x < x1; x++) {
+                    size_t c = (size_t)y * width + x;
+                    if (river_strength[c] != next.river_strength[c] || (lake_id[c] >= 0) != (next.lake_id[c] >= 0)) { differs[t] = 1; break; }
+                }
+        });
+        vector<PixelRect> tiles;
+        for (int t = 0; t < tiles_x * tiles_y; t++) {
+            if (!differs[t]) continue;
+            int x0 = (t % tiles_x) * tile_size, y0 = (t / tiles_x) * tile_size;
+            tiles.push_back({ x0, y0, std::min(next.width, x0 + tile_size) - 1, std::min(next.height, y0 + tile_size) - 1 });
+        }
+        return tiles;
+    }
+
+    // takes over the result of a finished pass, dem keeps pointing into the swapped dem_copy
+    void adopt(Hydrology &next) {
+        width = next.width; height = next.height;
+        sea_level = next.sea_level;
+        dem = next.dem;
+        dem_copy.swap(next.dem_copy);
+        filled.swap(next.filled);
+        receiver.swap(next.receiver);
+        accumulation.swap(next.accumulation);
+        river_strength.swap(next.river_strength);
+        lake_id.swap(next.lake_id);
+        lakes.swap(next.lakes);
+        last_compute_ms = next.last_compute_ms;
+        TRACK_MEMORY(tracked_fields, get_capacity_bytes(dem_copy, filled, label, receiver, accumulation, river_strength, lake_id));
+    }
+
+public:
+    float last_compute_ms = 0.f;
+
+    Hydrology(ElevationLineDrawer *height_source, const TerrainData *terrain_data, bool debug_msg = false)
+        : height_source(height_source), terrain_data(terrain_data), metres_per_unit(terrain_data->get_metres_per_local_unit()), debug_msg(debug_msg) {}
+
+    // full pass over the current heightmap
+    void compute() {
+        load_heights(false);
+        solve();
+    }
+
+    // Full pass on another thread over a copy of the current heights, the getters keep the last result until
+    // poll_compute picks the new one up. Started again while a pass runs, it runs once more after that one.
+    void start_compute_async() {
+        if (pending) { rerun = true; return; }
+        if (!height_source->is_loaded()) return;
+        pending.reset(new Hydrology(height_source, terrain_data, debug_msg));
+        pending->load_heights(true);
+        pending_done = std::async(std::launch::async, [p = pending.get()]() { p->solve(); });
+    }
+
+    // true once an async pass replaced the result, changed_tiles are the tile_size tiles whose rivers or lakes differ
+    bool poll_compute(int tile_size, vector<PixelRect> &changed_tiles) {
+        if (!pending || pending_done.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+        pending_done.get();
+        changed_tiles = get_changed_tiles(*pending, tile_size);
+        adopt(*pending);
+        pending.reset();
+        if (rerun) { rerun = false; start_compute_async(); }
+        return true;
+    }
+
+    bool is_computing() const { return pending != nullptr; }
+
+    bool is_computed() const { return !river_strength.empty(); }
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+
+    // 0-255 log scaled upstream area between HYDRO_RIVER_MIN_AREA and HYDRO_RIVER_FULL_AREA, one byte per heightmap pixel
+    const vector<unsigned char>& get_river_strength() const { return river_strength; }
+    float get_river_strength_at_pixel(int x, int y) const {
+        if (!is_computed()) return 0.f;
+        return river_strength[(size_t)glm::clamp(y, 0, height - 1) * width + glm::clamp(x, 0, width - 1)] / 255.f;
+    }
+    float get_river_strength_at_local_pos(float x, float y) const {
+        return get_river_strength_at_pixel((int)((x + 0.5f) * width), (int)((y + 0.5f) * height));
+    }
+
+    // [m^2] area draining through the pixel
+    float get_upstream_area_at_pixel(int x, int y) const {
+        if (!is_computed()) return 0.f;
+        return accumulation[(size_t)glm::clamp(y, 0, height - 1) * width + glm::clamp(x, 0, width - 1)]
+             * (metres_per_unit / width) * (metres_per_unit / height);
+    }
+
+    // [m] from the ground up to the filled surface, 0 outside depressions (and where the ground was raised since compute)
+    float get_water_depth_at_pixel(int x, int y) const {
+        if (!is_computed() || !inside(x, y)) return 0.f;
+        size_t c = (size_t)y * width + x;
+        return std::max((int)filled[c] - (int)dem[c], 0) * (terrain_data->maximum_height_reach - terrain_data->minimum_height_reach) / (HYDRO_LEVEL_NUM - 1);
+    }
+
+    const vector<HydrologyLake>& get_lakes() const { return lakes; }
+    int get_lake_at_pixel(int x, int y) const {
+        if (!is_computed() || !inside(x, y)) return -1;
+        return lake_id[(size_t)y * width + x];
+    }
+};
+
+#endif
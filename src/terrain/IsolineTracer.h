@@ -0,0 +1,258 @@
+#ifndef ISOLINETRACER_H
+#define ISOLINETRACER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "ElevationLineDrawer.h"
+
+using namespace glm;
+using namespace std;
+
+#define ISO_TRACER_MAX_CELLS 4096           // cells walked per direction
+#define ISO_TRACER_MIN_STEP 1e-4f           // [px] crossings closer than this to the entry point are the entry itself
+
+// Walks the bilinear heightfield cell by cell along a path of constant grade (an isoline for slope 0).
+// Inside a cell the path goes straight from the entry point to the point on the cell border where
+// height == entry height + slope * distance, so there is no drift and every cell costs two new height samples.
+class IsolineTracer
+{
+private:
+    struct Crossing {
+        int edge;       // 0 bottom, 1 right, 2 top, 3 left
+        vec2 px;        // pixel coordinates
+        float h;        // local height
+    };
+
+    ElevationLineDrawer *height_source;
+    int width = 0, height = 0;
+    float scale = 1.f;
+
+    // both directions from the last start, re-used while only the end moves
+    bool has_cache = false;
+    vec2 cached_start;
+    float cached_slope = 0.f;
+    vector<vec3> branch[2];
+
+    vector<Crossing> candidates;
+    int height_sample_num = 0;
+
+    void load_size() {
+        width = height_source->get_map_width();
+        height = height_source->get_map_height();
+        scale = height_source->get_height_scale();
+    }
+
+    // corners c[0] (i,j), c[1] (i+1,j), c[2] (i+1,j+1), c[3] (i,j+1)
+    void load_cell(int i, int j, float c[4]) {
+        c[0] = height_source->get_pixel_height(i, j) * scale;
+        c[1] = height_source->get_pixel_height(i+1, j) * scale;
+        c[2] = height_source->get_pixel_height(i+1, j+1) * scale;
+        c[3] = height_source->get_pixel_height(i, j+1) * scale;
+        height_sample_num += 4;
+    }
+
+    // moving across exit edge e the two corners of that edge are shared, only the far side is sampled
+    void load_next_cell(int i, int j, int e, float c[4]) {
+        float n[4];
+        switch (e) {
+            case 0: n[3] = c[0]; n[2] = c[1]; n[0] = height_source->get_pixel_height(i, j) * scale;   n[1] = height_source->get_pixel_height(i+1, j) * scale; break;
+            case 1: n[0] = c[1]; n[3] = c[2]; n[1] = height_source->get_pixel_height(i+1, j) * scale; n[2] = height_source->get_pixel_height(i+1, j+1) * scale; break;
+            case 2: n[0] = c[3]; n[1] = c[2]; n[3] = height_source->get_pixel_height(i, j+1) * scale; n[2] = height_source->get_pixel_height(i+1, j+1) * scale; break;
+            default: n[1] = c[0]; n[2] = c[3]; n[0] = height_source->get_pixel_height(i, j) * scale; n[3] = height_source->get_pixel_height(i, j+1) * scale; break;
+        }
+        for (int k = 0; k < 4; k++) c[k] = n[k];
+        height_sample_num += 2;
+    }
+
+    static void get_edge(int i, int j, int e, const float c[4], vec2 &a, vec2 &b, float &ha, float &hb) {
+        switch (e) {
+            case 0: a = vec2(i, j);   b = vec2(i+1, j);   ha = c[0]; hb = c[1]; break;
+            case 1: a = vec2(i+1, j); b = vec2(i+1, j+1); ha = c[1]; hb = c[2]; break;
+            case 2: a = vec2(i, j+1); b = vec2(i+1, j+1); ha = c[3]; hb = c[2]; break;
+            default: a = vec2(i, j);  b = vec2(i, j+1);   ha = c[0]; hb = c[3]; break;
+        }
+    }
+
+    vec3 to_local(vec2 px, float h) const { return vec3(px.x / width - 0.5f, px.y / height - 0.5f, h); }
+
+    // points on edge e with h(t) == level + slope * |P(t) - from|, both solved in closed form
+    void solve_edge(int i, int j, const float c[4], int e, vec2 from, float level, float slope) {
+        vec2 a, b; float ha, hb;
+        get_edge(i, j, e, c, a, b, ha, hb);
+
+        if (slope == 0.f) {
+            // same inside / outside rule as the contour extractor, a corner on the level belongs to one edge only
+            if ((ha >= level) == (hb >= level)) return;
+            float t = (level - ha) / (hb - ha);
+            candidates.push_back({ e, glm::mix(a, b, t), level });
+            return;
+        }
+
+        // height along the edge is linear, A + B t, and the distance is sqrt(q^2 + L^2 (t - tm)^2) in local units.
+        // Squaring A + B t = slope * distance gives a quadratic, its roots count where A + B t has the sign of slope.
+        vec2 edge_dir = (b - a) / vec2(width, height);
+        double edge_len_sqr = dot(edge_dir, edge_dir);
+        vec2 from_rel = (from - a) / vec2(width, height);
+        double tm = dot(from_rel, edge_dir) / edge_len_sqr;
+        vec2 normal_offset = from_rel - edge_dir * (float)tm;
+        double q_sqr = dot(normal_offset, normal_offset);
+        double A = ha - level, B = hb - ha, s_sqr = (double)slope * slope;
+
+        double qa = B * B - s_sqr * edge_len_sqr;
+        double qb = 2.0 * (A * B + s_sqr * edge_len_sqr * tm);
+        double qc = A * A - s_sqr * (q_sqr + edge_len_sqr * tm * tm);
+        double roots[2];
+        int root_num = 0;
+        if (std::fabs(qa) < 1e-12 * std::max(B * B, s_sqr * edge_len_sqr)) {
+            if (qb != 0.0) roots[root_num++] = -qc / qb;
+        }
+        else {
+            double disc = qb * qb - 4.0 * qa * qc;
+            if (disc < 0.0) return;
+            // stable form, no cancellation between -qb and the root
+            double k = -0.5 * (qb + (qb >= 0.0 ? 1.0 : -1.0) * std::sqrt(disc));
+            roots[root_num++] = k / qa;
+            if (k != 0.0) roots[root_num++] = qc / k;
+        }
+        for (int r = 0; r < root_num; r++) {
+            double t = roots[r];
+            if (t < 0.0 || t > 1.0 || (A + B * t) * slope < 0.0) continue;
+            candidates.push_back({ e, glm::mix(a, b, (float)t), glm::mix(ha, hb, (float)t) });
+        }
+    }
+
+    // all exits of cell (i,j) reachable from the point, except through the entry edge
+    void find_exits(int i, int j, const float c[4], int entry_edge, vec2 from, float level, float slope) {
+        candidates.clear();
+        for (int e = 0; e < 4; e++) {
+            if (e == entry_edge) continue;
+            solve_edge(i, j, c, e, from, level, slope);
+        }
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+            [&](const Crossing &x) { return glm::length(x.px - from) < ISO_TRACER_MIN_STEP; }), candidates.end());
+    }
+
+    // for a level path in a saddle cell keep only crossings on the hyperbola branch of the point
+    void keep_branch_of(int i, int j, const float c[4], vec2 point_px) {
+        float d = c[0] - c[1] - c[3] + c[2];
+        if (candidates.size() <= 2 || std::fabs(d) < 1e-12f) return;
+        float u_centre = -(c[3] - c[0]) / d;
+        bool side = point_px.x - i >= u_centre;
+        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+            [&](const Crossing &x) { return (x.px.x - i >= u_centre) != side; }), candidates.end());
+    }
+
+    int pick_straightest(vec2 from, vec2 dir) const {
+        int best = 0;
+        float best_dot = -FLT_MAX;
+        for (int k = 0; k < (int)candidates.size(); k++) {
+            vec2 step = candidates[k].px - from;
+            float len = glm::length(step);
+            float dot_value = len > 0.f ? dot(step / len, dir) : -FLT_MAX;
+            if (dot_value > best_dot) { best_dot = dot_value; best = k; }
+        }
+        return best;
+    }
+
+    // walks from the first exit of the start cell until the map border, a dead end or back to the start
+    void walk(int start_i, int start_j, const float start_cell[4], vec2 start_px, Crossing exit, float slope, vector<vec3> &out) {
+        int i = start_i, j = start_j;
+        vec2 from = start_px;
+        float c[4] = { start_cell[0], start_cell[1], start_cell[2], start_cell[3] };
+        for (int step = 0; step < ISO_TRACER_MAX_CELLS; step++) {
+            out.push_back(to_local(exit.px, exit.h));
+            vec2 dir = glm::normalize(exit.px - from);
+
+            // neighbour across the exit edge
+            static const int di[4] = { 0, 1, 0, -1 }, dj[4] = { -1, 0, 1, 0 }, opposite[4] = { 2, 3, 0, 1 };
+            i += di[exit.edge]; j += dj[exit.edge];
+            if (i < 0 || j < 0 || i > width - 2 || j > height - 2) return;
+            if (slope == 0.f && i == start_i && j == start_j) { // closed contour
+                out.push_back(to_local(start_px, out.front().z));
+                return;
+            }
+
+            int entry_edge = opposite[exit.edge];
+            from = exit.px;
+            load_next_cell(i, j, exit.edge, c);
+            find_exits(i, j, c, entry_edge, from, exit.h, slope);
+            if (candidates.empty()) return; // grade can not be held any further
+            if (slope == 0.f) keep_branch_of(i, j, c, from);
+            exit = candidates[pick_straightest(from, dir)];
+        }
+    }
+
+    void trace_branches(vec2 start_local, float slope) {
+        branch[0].clear(); branch[1].clear();
+        vec2 start_px = vec2((start_local.x + 0.5f) * width, (start_local.y + 0.5f) * height);
+        int i = glm::clamp((int)start_px.x, 0, width - 2), j = glm::clamp((int)start_px.y, 0, height - 2);
+        start_px = glm::clamp(start_px, vec2(i, j), vec2(i + 1, j + 1));
+
+        float c[4];
+        load_cell(i, j, c);
+        float u = start_px.x - i, v = start_px.y - j;
+        float start_h = glm::mix(glm::mix(c[0], c[1], u), glm::mix(c[3], c[2], u), v);
+
+        find_exits(i, j, c, -1, start_px, start_h, slope);
+        if (slope == 0.f) keep_branch_of(i, j, c, start_px);
+        if (candidates.empty()) return;
+
+        // the two directions leave the start cell as far apart as possible
+        vector<Crossing> exits = candidates;
+        Crossing first = exits[0];
+        vec2 first_dir = first.px - start_px;
+        Crossing second = first;
+        float lowest_dot = FLT_MAX;
+        for (const Crossing &x : exits) {
+            float d = dot(x.px - start_px, first_dir);
+            if (d < lowest_dot) { lowest_dot = d; second = x; }
+        }
+
+        walk(i, j, c, start_px, first, slope, branch[0]);
+        if (lowest_dot < 0.f) walk(i, j, c, start_px, second, slope, branch[1]);
+    }
+
+public:
+    IsolineTracer(ElevationLineDrawer *height_source) : height_source(height_source) {}
+
+    // path of constant slope (rise over horizontal run) from start in whichever direction gets closest to end,
+    // cut at the point nearest to end
+    vector<vec3> trace(vec3 start, vec2 end, float slope) {
+        vector<vec3> path;
+        path.push_back(start);
+        if (!height_source->is_loaded()) return path;
+        if (width == 0) load_size();
+
+        if (!has_cache || cached_start != vec2(start) || cached_slope != slope) {
+            height_sample_num = 0;
+            trace_branches(vec2(start), slope);
+            has_cache = true;
+            cached_start = vec2(start);
+            cached_slope = slope;
+        }
+
+        int best_branch = -1, best_index = -1;
+        float best_distance = glm::length(end - vec2(start));
+        for (int b = 0; b < 2; b++) {
+            for (int k = 0; k < (int)branch[b].size(); k++) {
+                float d = glm::length(end - vec2(branch[b][k]));
+                if (d < best_distance) { best_distance = d; best_branch = b; best_index = k; }
+            }
+        }
+        if (best_branch >= 0) path.insert(path.end(), branch[best_branch].begin(), branch[best_branch].begin() + best_index + 1);
+        return path;
+    }
+
+    void clear_cache() { has_cache = false; }
+    void invalidate_region(vec2 box_min, vec2 box_max) {
+        if (ElevationLineDrawer::path_touches_box(branch[0], box_min, box_max) || ElevationLineDrawer::path_touches_box(branch[1], box_min, box_max)) has_cache = false;
+    }
+
+    // height samples taken by the last full trace of both directions
+    int get_height_sample_num() const { return height_sample_num; }
+};
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef REACHABILITYFIELD_H
+#define REACHABILITYFIELD_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <chrono>
+#include <algorithm>
+#include "settings/Settings.h"
+#include "rendering/ResourceTracker.h"
+#include "ElevationLineDrawer.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+#define REACH_UNREACHABLE_TEXEL 255         // texel value of cells the grade limit cuts off, reachable cells use 0-254
+
+// Cost distance from a path handle over a downsampled heightfield, bucketed Dijkstra on the 8-neighbour grid.
+// Steps steeper than the grade limit are impassable, the rest cost their length plus a climb / descent
+// penalty (so the field is anisotropic). A new handle or grade limit recomputes the whole field: repairing it
+// for a limit change needs a full scan of the steps and the path tree and came out slower than the rebuild.
+class ReachabilityField
+{
+private:
+    ElevationLineDrawer *height_source;
+    float metres_per_unit;
+    int resolution;                         // [cells] longest side of the field
+    int width = 0, height = 0, factor = 1;  // cells, heightmap pixels per cell
+    vector<float> ground;                   // [m] per cell
+
+    vector<float> cost;                     // [m] weighted distance from the start cell, FLT_MAX if unreachable
+    vector<unsigned char> texels;
+    int start_cell = -1;
+    float grade_limit = -1.f;
+
+    int dx[8] = { 1, -1, 0, 0, 1, 1, -1, -1 }, dy[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+    float step_length[8], inv_step_length[8]; // [m]
+    int offset[8];
+
+    // reused between updates
+    vector<pair<float,int>> seeds;
+    vector<vector<int>> buckets;
+    TrackedMemory tracked_fields;
+
+    void load_ground() {
+        if (!ground.empty() || !height_source->is_loaded()) return;
+        int map_width = height_source->get_map_width(), map_height = height_source->get_map_height();
+        factor = std::max(1, (std::max(map_width, map_height) + resolution - 1) / resolution);
+        width = map_width / factor;
+        height = map_height / factor;
+        float scale = height_source->get_height_scale() * metres_per_unit;
+        ground.resize((size_t)width * height);
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+                ground[(size_t)y * width + x] = height_source->get_pixel_height(x * factor + factor / 2, y * factor + factor / 2) * scale;
+
+        float cell_x = metres_per_unit / width, cell_y = metres_per_unit / height;
+        for (int k = 0; k < 8; k++) {
+            step_length[k] = std::sqrt(dx[k] * dx[k] * cell_x * cell_x + dy[k] * dy[k] * cell_y * cell_y);
+            inv_step_length[k] = 1.f / step_length[k];
+            offset[k] = dy[k] * width + dx[k];
+        }
+        cost.assign(ground.size(), FLT_MAX);
+        texels.assign(ground.size(), REACH_UNREACHABLE_TEXEL);
+        start_cell = -1;
+        TRACK_MEMORY(tracked_fields, get_capacity_bytes(ground, cost, texels));
+    }
+
+    // Dijkstra with a ring of cost buckets no wider than the cheapest step: a cell can not be improved by another
+    // cell of its own bucket, so whole buckets settle in any order and the queue is O(1). Seeds keep their cost
+    // and enter the ring when it gets to them.
+    void propagate() {
+        std::sort(seeds.begin(), seeds.end());
+        float bucket_width = std::min(step_length[0], step_length[2]);
+        float max_step = std::max(step_length[4], step_length[0]) * (1.f + std::max(REACH_CLIMB_WEIGHT, REACH_DESCENT_WEIGHT) * grade_limit);
+        int ring_size = (int)std::ceil(max_step / bucket_width) + 2;
+        if ((int)buckets.size() < ring_size) buckets.resize(ring_size);
+        for (vector<int> &b : buckets) b.clear();
+
+        size_t next_seed = 0, queued = 0;
+        long long current = seeds.empty() ? 0 : (long long)(seeds[0].first / bucket_width);
+        while (queued > 0 || next_seed < seeds.size()) {
+            if (queued == 0) current = std::max(current, (long long)(seeds[next_seed].first / bucket_width));
+            vector<int> &bucket = buckets[current % ring_size];
+            while (next_seed < seeds.size() && (long long)(seeds[next_seed].first / bucket_width) <= current) {
+                bucket.push_back(seeds[next_seed++].second);
+                queued++;
+            }
+            queued -= bucket.size();
+            for (size_t q = 0; q < bucket.size(); q++) {
+                int a = bucket[q];
+                if ((long long)(cost[a] / bucket_width) != current) continue; // improved since it was queued
+                int ax = a % width, ay = a / width;
+                for (int k = 0; k < 8; k++) {
+                    if ((unsigned)(ax + dx[k]) >= (unsigned)width || (unsigned)(ay + dy[k]) >= (unsigned)height) continue;
+                    int b = a + offset[k];
+                    float g = (ground[b] - ground[a]) * inv_step_length[k];
+                    if (std::fabs(g) > grade_limit) continue;
+                    float c = cost[a] + step_length[k] * (1.f + (g > 0.f ? REACH_CLIMB_WEIGHT * g : -REACH_DESCENT_WEIGHT * g));
+                    if (c >= cost[b]) continue;
+                    cost[b] = c;
+                    buckets[(long long)(c / bucket_width) % ring_size].push_back(b);
+                    queued++;
+                }
+            }
+            bucket.clear();
+            current++;
+        }
+        seeds.clear();
+    }
+
+    void recompute(int new_start) {
+        std::fill(cost.begin(), cost.end(), FLT_MAX);
+        start_cell = new_start;
+        cost[start_cell] = 0.f;
+        seeds.assign(1, { 0.f, start_cell });
+        propagate();
+    }
+
+    void fill_texels() {
+        int n = width * height;
+        float to_texel = (REACH_UNREACHABLE_TEXEL - 1) / REACH_DISPLAY_DISTANCE;
+        for (int c = 0; c < n; c++)
+            texels[c] = cost[c] == FLT_MAX ? REACH_UNREACHABLE_TEXEL : (unsigned char)std::min(cost[c] * to_texel, REACH_UNREACHABLE_TEXEL - 1.f);
+    }
+
+public:
+    float last_update_ms = 0.f;
+
+    ReachabilityField(ElevationLineDrawer *height_source, const TerrainData *terrain_data, int resolution = REACH_FIELD_RESOLUTION)
+        : height_source(height_source), metres_per_unit(terrain_data->get_metres_per_local_unit()), resolution(resolution) {}
+
+    // start in terrain local space, max_grade as rise over run; true if the field changed
+    bool update(vec3 start, float max_grade) {
+        load_ground();
+        if (ground.empty()) return false;
+
+        int x = glm::clamp((int)((start.x + 0.5f) * width), 0, width - 1);
+        int y = glm::clamp((int)((start.y + 0.5f) * height), 0, height - 1);
+        int new_start = y * width + x;
+        max_grade = std::fabs(max_grade);
+        if (new_start == start_cell && max_grade == grade_limit) return false;
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        grade_limit = max_grade;
+        recompute(new_start);
+        fill_texels();
+        last_update_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+        return true;
+    }
+
+    // [m] weighted distance to the local position, FLT_MAX if out of reach
+    float get_cost_at_local_pos(float x, float y) const {
+        if (cost.empty()) return FLT_MAX;
+        int i = glm::clamp((int)((x + 0.5f) * width), 0, width - 1);
+        int j = glm::clamp((int)((y + 0.5f) * height), 0, height - 1);
+        return cost[(size_t)j * width + i];
+    }
+
+    // heights are re-read on the next update, for heightmap edits
+    void invalidate() { ground.clear(); start_cell = -1; grade_limit = -1.f; }
+
+    // re-reads the cells sampled inside the pixel rectangle [x0,x1]x[y0,y1], the next update recomputes
+    // the whole field since any edit can open or close a shortcut
+    void invalidate_pixels(int x0, int y0, int x1, int y1) {
+        start_cell = -1; grade_limit = -1.f;
+        if (ground.empty()) return;
+        float scale = height_source->get_height_scale() * metres_per_unit;
+        int cx0 = std::max(0, (x0 - factor / 2 + factor - 1) / factor), cx1 = std::min(width - 1, (x1 - factor / 2) / factor);
+        int cy0 = std::max(0, (y0 - factor / 2 + factor - 1) / factor), cy1 = std::min(height - 1, (y1 - factor / 2) / factor);
+        for (int y = cy0; y <= cy1; y++)
+            for (int x = cx0; x <= cx1; x++)
+                ground[(size_t)y * width + x] = height_source->get_pixel_height(x * factor + factor / 2, y * factor + factor / 2) * scale;
+    }
+
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+    const unsigned char* get_texels() const { return texels.data(); }
+};
+
+#endif
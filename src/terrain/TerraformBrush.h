@@ -0,0 +1,128 @@
+#ifndef TERRAFORMBRUSH_H
+#define TERRAFORMBRUSH_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "settings/Settings.h"
+#include "rendering/ResourceTracker.h"
+#include "ElevationLineDrawer.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+enum TerraformMode {
+    TERRAFORM_RAISE, TERRAFORM_LOWER, TERRAFORM_FLATTEN, TERRAFORM_SMOOTH
+};
+
+// Cut and fill brush on the heightmap. Heights are edited in place in the shared heightmap, rounded with a
+// per pixel dither so steps below the map precision still add up. Every application reports the pixel rectangle
+// it changed to the heightmap's edit listeners, so textures and derived fields only update where the brush went,
+// and grows the rectangle of the current stroke.
+class TerraformBrush
+{
+private:
+    ElevationLineDrawer *height_source;
+    float height_range;                 // [m] between raw heights 0 and 1
+    float metres_per_unit;
+    int width = 0, height = 0;
+    vector<float> smooth_source;        // brush footprint before smoothing
+    TrackedMemory tracked_smooth_source;
+
+    bool in_stroke = false;
+    float flatten_level = 0.f;
+    PixelRect stroke_rect = PixelRect::empty();
+    unsigned int application = 0;       // varies the dither between applications
+
+    float get_height(int x, int y) const {
+        return height_source->get_pixel_height_unchecked((size_t)glm::clamp(y, 0, height - 1) * width + glm::clamp(x, 0, width - 1));
+    }
+
+    // [0,1) hash of the pixel and the application, the rounding offset of the write
+    float get_dither(int x, int y) const {
+        unsigned int h = (unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u ^ application * 83492791u;
+        h ^= h >> 13; h *= 0x5bd1e995u; h ^= h >> 15;
+        return (h & 0xffffff) / 16777216.f;
+    }
+
+public:
+    TerraformBrush(ElevationLineDrawer *height_source, const TerrainData *terrain_data)
+        : height_source(height_source), height_range(terrain_data->maximum_height_reach - terrain_data->minimum_height_reach),
+          metres_per_unit(terrain_data->get_metres_per_local_unit()) {}
+
+    // brush centre in terrain local space, radius in metres, amount in metres for raise / lower
+    // and as a 0-1 blend per application for flatten / smooth; returns the changed pixels
+    PixelRect apply(vec2 local_pos, float radius, float amount, TerraformMode mode) {
+        if (!height_source->is_loaded() || radius <= 0.f) return PixelRect::empty();
+        width = height_source->get_map_width();
+        height = height_source->get_map_height();
+
+        vec2 centre = (local_pos + vec2(0.5f)) * vec2(width, height);
+        vec2 radius_px = radius / metres_per_unit * vec2(width, height);
+        PixelRect r = { std::max(0, (int)std::floor(centre.x - radius_px.x)), std::max(0, (int)std::floor(centre.y - radius_px.y)),
+                        std::min(width - 1, (int)std::ceil(centre.x + radius_px.x)), std::min(height - 1, (int)std::ceil(centre.y + radius_px.y)) };
+        if (r.is_empty()) return r;
+
+        if (!in_stroke) {
+            in_stroke = true;
+            flatten_level = get_height((int)centre.x, (int)centre.y);
+        }
+
+        // smoothing reads the footprint as it was, plus a pixel around it
+        int sw = r.x1 - r.x0 + 3, sh = r.y1 - r.y0 + 3;
+        if (mode == TERRAFORM_SMOOTH) {
+            smooth_source.resize((size_t)sw * sh);
+            for (int y = 0; y < sh; y++)
+                for (int x = 0; x < sw; x++)
+                    smooth_source[(size_t)y * sw + x] = get_height(r.x0 - 1 + x, r.y0 - 1 + y);
+            TRACK_MEMORY(tracked_smooth_source, get_capacity_bytes(smooth_source));
+        }
+
+        float delta = amount / height_range * (mode == TERRAFORM_LOWER ? -1.f : 1.f);
+        float blend = glm::clamp(amount, 0.f, 1.f);
+        for (int y = r.y0; y <= r.y1; y++) {
+            for (int x = r.x0; x <= r.x1; x++) {
+                vec2 d = (vec2(x, y) - centre) / radius_px;
+                float s = 1.f - glm::length(d);
+                if (s <= 0.f) continue;
+                float weight = s * s * (3.f - 2.f * s);     // smoothstep falloff to the rim
+
+                float h = get_height(x, y);
+                switch (mode) {
+                    case TERRAFORM_RAISE:
+                    case TERRAFORM_LOWER:
+                        h += delta * weight;
+                        break;
+                    case TERRAFORM_FLATTEN:
+                        h = glm::mix(h, flatten_level, blend * weight);
+                        break;
+                    case TERRAFORM_SMOOTH: {
+                        const float *row = &smooth_source[(size_t)(y - r.y0) * sw + (x - r.x0)];
+                        float average = (row[0] + row[1] + row[2] + row[sw] + row[sw+1] + row[sw+2] + row[2*sw] + row[2*sw+1] + row[2*sw+2]) / 9.f;
+                        h = glm::mix(h, average, blend * weight);
+                        break;
+                    }
+                }
+                height_source->set_pixel_height(x, y, h, get_dither(x, y));
+            }
+        }
+        application++;
+        stroke_rect.include(r);
+        height_source->notify_edited(r);
+        return r;
+    }
+
+    // pixels changed since the stroke started, a new stroke picks a new flatten level
+    PixelRect end_stroke() {
+        PixelRect r = stroke_rect;
+        stroke_rect = PixelRect::empty();
+        in_stroke = false;
+        return r;
+    }
+
+    bool is_in_stroke() const { return in_stroke; }
+};
+
+#endif
@@ -6,14 +6,23 @@
 #include <string>
 #include <vector>
 #include <regex>
+#include <chrono>
 #include "world_objects/Object.h"
 #include "world_objects/Plane.h"
 #include "TerrainPlane.h"
 #include "rendering/Camera.h"
+#include "rendering/FrameProfiler.h"
 #include "UIText.h"
 #include "settings/Settings.h"
 #include "ElevationLineDrawer.h"
+#include "ContourExtractor.h"
+#include "IsolineTracer.h"
+#include "ReachabilityField.h"
+#include "Hydrology.h"
+#include "TerrainFields.h"
+#include "TerraformBrush.h"
 #include "InteractableManager.h"
+#include "SceneArena.h"
 #include "TerrainPainter.h"
 #include "TerrainData.h"
 #include <glm/glm.hpp>
@@ -31,18 +40,36 @@ public:
     ElevationLineDrawer elevation_line_drawer;
     const TerrainData *terrain_data;
     Texture heightmap_texture;
+    InteractableManager *interactable_manager;
+    ContourExtractor contour_extractor;
+    IsolineTracer isoline_tracer;
+    ReachabilityField reachability_field;
+    Hydrology hydrology;
+    TerrainFields terrain_fields;
+    Texture *gradient_texture = nullptr;
+    TerraformBrush terraform_brush;
+    TerrainPainter painter;
+    Texture *colour_texture = nullptr;
+    bool hydrology_stale = false;     // heights changed since the last hydrology pass
+    float last_terraform_ms = 0.f;
+    Texture *reachability_texture = nullptr;
+    bool reachability_shown = false;
 
     vector<Interactable*> attached_interactables;
 
     Terrain(const TerrainData *terrain_data, World *w, InteractableManager *interactable_manager, Camera *camera, vec3 pos = vec3(0.f)) :
         //terrain_shader(new DEFAULT_WORLD_SHADER),
-        elevation_line_drawer(terrain_data->heightmap_path, terrain_data->vertical_scale),
-        terrain_data(terrain_data), heightmap_texture(Texture(terrain_data->heightmap_path, true, true))
+        elevation_line_drawer(terrain_data->heightmap_path, terrain_data->vertical_scale, true), // 16 bit like the heightmap texture, derived fields need the precision
+        terrain_data(terrain_data), heightmap_texture(Texture(terrain_data->heightmap_path, true, true)),
+        interactable_manager(interactable_manager), contour_extractor(&elevation_line_drawer, terrain_data),
+        isoline_tracer(&elevation_line_drawer), reachability_field(&elevation_line_drawer, terrain_data),
+        hydrology(&elevation_line_drawer, terrain_data), terrain_fields(&elevation_line_drawer, terrain_data, true), terraform_brush(&elevation_line_drawer, terrain_data),
+        painter(terrain_data)
     {
         // Setup the physical plane object for terrain and floor
-        terrain_obj = new TerrainPlane(terrain_data, camera, pos);
+        terrain_obj = get_scene_arena().create<TerrainPlane>(terrain_data, camera, pos);
 
-        terrain_floor = new Plane(2, pos);
+        terrain_floor = get_scene_arena().create<Plane>(2, pos);
         terrain_floor->set_parent(terrain_obj);
         terrain_floor->set_colour(Colour::DARK_GREY);
         //terrain_floor->set_colour(Colour::TERRAIN_SIDE_COLOUR);
@@ -51,8 +78,10 @@ public:
         terrain_obj->move(V3_Y * -(terrain_data->vertical_scale * 2)); 
         
         // generate and apply a colour texture
-        TerrainPainter painter = TerrainPainter(terrain_data);
-        Texture generated_texture = painter.bake_terrain_texture();
+        hydrology.compute();
+        terrain_fields.compute();
+        colour_texture = new Texture(painter.bake_terrain_texture(false, &hydrology, &terrain_fields)); // areas map kept for re-bakes after terrain edits
+        elevation_line_drawer.add_edit_listener([this](const PixelRect &r) { on_heights_edited(r); });
 
         // get interactable and name tag positions from painer, attach them to terrain
         //vector<vec2> interactable_positions = painter.get_interactable_positions();
@@ -84,8 +113,8 @@ public:
             cout << "Interactable " << tag.name << " detected, attached to surface at: " << tag.uv_x << ", " << tag.uv_y << endl;
 
             if (tag.type == TerrainTagType::NAME_TAG) { // create world space text name tag 
-                UIText *name_tag_obj = new UIText(tag.name, 1.5f/SCR_WIDTH, Colour::BLACK);
-                name_tag_obj->set_shader(new WORLD_UI_SHADER);
+                UIText *name_tag_obj = get_scene_arena().create<UIText>(tag.name, 1.5f/SCR_WIDTH, Colour::BLACK);
+                name_tag_obj->set_owned_shader(new WORLD_UI_SHADER);
                 attach_to_surface(name_tag_obj, tag.uv_x, tag.uv_y);
                 //name_tag_obj->set_size(0.01f);
                 name_tag_obj->move(V3_Z*0.1f);
@@ -97,7 +126,7 @@ public:
         }
 
         // handle shader and camera 
-        terrain_shader = &ShaderManager::get_terrain_shader(&heightmap_texture, terrain_data->vertical_scale, &generated_texture);
+        terrain_shader = ShaderManager::new_terrain_shader(&heightmap_texture, terrain_data->vertical_scale, colour_texture);
         terrain_shader->config_worldpos_buffer();
         camera->set_orthographic(terrain_shader);
         terrain_obj->set_shader(terrain_shader);
@@ -109,12 +138,107 @@ public:
         // place objects in world
         w->place(terrain_obj);
         w->place(terrain_floor);
+
+        // slope for the shader comes from the shared fields instead of per fragment differences
+        if (terrain_fields.is_computed()) {
+            gradient_texture = new Texture(terrain_fields.get_width(), terrain_fields.get_height(), GL_RG16, GL_RG, GL_UNSIGNED_SHORT, terrain_fields.get_gradient_data());
+            terrain_shader->use();
+            terrain_shader->addTexture(gradient_texture); terrain_shader->setInt("terrain_gradient", terrain_shader->get_last_loaded_tex_slot());
+            terrain_shader->setFloat("field_max_grade", FIELD_MAX_GRADE);
+            terrain_shader->setFloat("grade_steepness_scale", terrain_fields.get_steepness_scale());
+        }
     }
     
+    // the planes and name tags are the scene arena's, the shader and the textures it samples besides the heightmap are ours
+    ~Terrain() {
+        delete terrain_shader;
+        delete colour_texture;
+        delete gradient_texture;
+        delete reachability_texture;
+    }
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
     Plane* get_obj() {
         return terrain_obj;
     }
 
+    // reachability overlay from a path handle under the grade limit, recomputed when the handle cell or the limit changes
+    void show_reachability(vec3 start, float max_grade) {
+        PROFILE_ZONE("reachability");
+        bool changed = reachability_field.update(start, max_grade);
+        if (!reachability_texture && reachability_field.get_width() > 0) {
+            reachability_texture = new Texture(reachability_field.get_width(), reachability_field.get_height());
+            terrain_shader->use();
+            terrain_shader->addTexture(reachability_texture); terrain_shader->setInt("reachability_map", terrain_shader->get_last_loaded_tex_slot());
+            changed = true;
+        }
+        if (changed && reachability_texture) reachability_texture->set_red_data(reachability_field.get_texels());
+        if (!reachability_shown && reachability_texture) {
+            terrain_shader->use();
+            terrain_shader->setBool("reachability_enabled", true);
+            reachability_shown = true;
+        }
+    }
+    void hide_reachability() {
+        if (!reachability_shown) return;
+        terrain_shader->use();
+        terrain_shader->setBool("reachability_enabled", false);
+        reachability_shown = false;
+    }
+
+    // One brush application, the heights change in place and on_heights_edited follows them
+    PixelRect terraform(vec2 local_pos, float radius, float amount, TerraformMode mode) {
+        PROFILE_ZONE("terraform");
+        auto start_time = std::chrono::high_resolution_clock::now();
+        PixelRect r = terraform_brush.apply(local_pos, radius, amount, mode);
+        last_terraform_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+        return r;
+    }
+
+    // Heights changed in place: only the changed pixels are uploaded to the heightmap texture, colour tiles around
+    // them are re-baked and caches overlapping them are dropped. Drainage waits for the end of the stroke.
+    void on_heights_edited(const PixelRect &r) {
+        // heightmap texture rows are the CPU rows, both are loaded flipped
+        int map_width = elevation_line_drawer.get_map_width();
+        size_t first = (size_t)r.y0 * map_width + r.x0;
+        const void *data = elevation_line_drawer.is_16bit() ? (const void*)((const unsigned short*)elevation_line_drawer.get_raw_data() + first)
+                                                            : (const void*)((const unsigned char*)elevation_line_drawer.get_raw_data() + first);
+        heightmap_texture.set_sub_data(r.x0, r.y0, r.x1 - r.x0 + 1, r.y1 - r.y0 + 1, GL_RED,
+                                       elevation_line_drawer.is_16bit() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE, data, map_width);
+        PixelRect fr = terrain_fields.update_pixels(r);
+        if (!fr.is_empty() && gradient_texture)
+            gradient_texture->set_sub_data(fr.x0, fr.y0, fr.x1 - fr.x0 + 1, fr.y1 - fr.y0 + 1, GL_RG, GL_UNSIGNED_SHORT,
+                                           terrain_fields.get_gradient_data() + ((size_t)fr.y0 * map_width + fr.x0) * 2, map_width);
+        painter.rebake_regions(&elevation_line_drawer, { fr.is_empty() ? r : fr }, colour_texture);
+
+        vec2 box_min, box_max;
+        get_local_box(r, box_min, box_max);
+        contour_extractor.invalidate_pixels(r.x0, r.y0, r.x1, r.y1);
+        isoline_tracer.invalidate_region(box_min, box_max);
+        reachability_field.invalidate_pixels(r.x0, r.y0, r.x1, r.y1);
+        hydrology_stale = true;
+    }
+
+    // Drainage is global so it is redone once per stroke, on another thread over a copy of the heights
+    void end_terraform_stroke() {
+        terraform_brush.end_stroke();
+        if (!hydrology_stale) return;
+        hydrology_stale = false;
+        hydrology.start_compute_async();
+    }
+
+    // once per frame: picks up a finished drainage pass, only the colour tiles whose rivers or lakes changed are re-baked
+    void update_drainage() {
+        vector<PixelRect> changed;
+        if (hydrology.poll_compute(PAINTER_TILE_SIZE, changed)) painter.rebake_regions(&elevation_line_drawer, changed, colour_texture);
+    }
+
+    // local space box covered by a pixel rectangle
+    void get_local_box(const PixelRect &r, vec2 &box_min, vec2 &box_max) {
+        elevation_line_drawer.get_local_box(r, box_min, box_max);
+    }
+
     // --- Fixed Attach Function ---
     // Attaches an object to the terrain surface at specific UV coordinates (0.0 to 1.0)
     void attach_to_surface(Object *obj, float along_x, float along_y) {
@@ -127,6 +251,10 @@ public:
         obj->set_position(local_pos); // reposition obj to local space (relative to terrain)
         obj->set_parent(terrain_obj); // attached objects will follow terrain rotations
     }
+    void attach_to_surface(Interactable *i, float along_x, float along_y) {
+        attach_to_surface((Object*)i, along_x, along_y);
+        if (i) interactable_manager->update_position(i); // keep the spatial grid in sync
+    }
 };
 
 #endif
\ No newline at end of file
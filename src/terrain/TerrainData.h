@@ -37,6 +37,12 @@ struct TerrainData
     float snow_level_height = 3000.f;
 
     TerrainTag tags[MAX_TAG_AMOUNT];
+
+    // heightmap [0,1] spans the height reach and is drawn vertical_scale tall in local space,
+    // terrain is not exaggerated so the same factor converts horizontal local units to metres
+    float get_metres_per_local_unit() const {
+        return (maximum_height_reach - minimum_height_reach) / vertical_scale;
+    }
 };
 
 const TerrainData terrain_transalpine = {
@@ -97,6 +103,12 @@ enum GreenRegions {
     GREEN_NONE = 0,
 };
 
+// region codes are 16k-1 values of the blue / green area data channel, slot 0 is no region
+#define AREA_REGION_SLOT_NUM 17
+inline int get_area_region_slot(int channel_value) {
+    return ((channel_value + 1) % 16) == 0 ? (channel_value + 1) / 16 : 0;
+}
+
 const std::unordered_map<int, glm::vec4> BLUE_REGION_COLOURS = {
     { BlueRegions::BLUE_RESERVED12, Colour::TRANSPARENT }, // Interactable (Invisible on map, logic handled separately)
     { BlueRegions::NATURE_RESERVE, Colour::GREEN }, // Nature Reserve (Dark Green tint)
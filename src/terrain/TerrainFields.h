@@ -0,0 +1,139 @@
+#ifndef TERRAINFIELDS_H
+#define TERRAINFIELDS_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include "settings/Settings.h"
+#include "settings/Parallel.h"
+#include "rendering/ResourceTracker.h"
+#include "ElevationLineDrawer.h"
+#include "TerrainData.h"
+
+using namespace glm;
+using namespace std;
+
+// Surface derivatives of the heightfield, computed once for everyone who needs them: the painter, the terrain
+// and line shaders and the path metrics. Central differences over STEEPNESS_SMOOTHING_STEP_SIZE pixels
+// (which also hides 8 bit steps). The gradient is kept as two 16 bit values per pixel in the layout of the
+// RG16 texture, so CPU and GPU read the same numbers. Slope, aspect and normals all come from the gradient,
+// curvature (laplacian of the height) is CPU only.
+class TerrainFields
+{
+private:
+    ElevationLineDrawer *height_source;
+    const TerrainData *terrain_data;
+    bool debug_msg;
+    int width = 0, height = 0;
+
+    vector<uint16_t> gradient;          // dz/dx, dz/dy as grade, mapped from [-FIELD_MAX_GRADE, FIELD_MAX_GRADE]
+    vector<int16_t> curvature;          // [1/m] mapped from [-FIELD_MAX_CURVATURE, FIELD_MAX_CURVATURE]
+    TrackedMemory tracked_fields;
+
+    static uint16_t encode_grade(float g) { return (uint16_t)std::lround((glm::clamp(g / FIELD_MAX_GRADE, -1.f, 1.f) * .5f + .5f) * 65535.f); }
+    static float decode_grade(uint16_t v) { return (v / 65535.f * 2.f - 1.f) * FIELD_MAX_GRADE; }
+
+    inline float get_height_m(int x, int y, float range) {
+        return height_source->get_pixel_height(glm::clamp(x, 0, width - 1), glm::clamp(y, 0, height - 1)) * range;
+    }
+
+    void compute_rows(int x0, int y0, int x1, int y1) {
+        const int S = STEEPNESS_SMOOTHING_STEP_SIZE;
+        float range = terrain_data->maximum_height_reach - terrain_data->minimum_height_reach;
+        float metres_per_unit = terrain_data->get_metres_per_local_unit();
+        float step_x = 2.f * S * metres_per_unit / width, step_y = 2.f * S * metres_per_unit / height;  // [m] across the stencil
+        float inv_sqr_x = 4.f / (step_x * step_x), inv_sqr_y = 4.f / (step_y * step_y);
+
+        // every brush step lands here, the shared pool saves starting threads per step
+        get_shared_worker_pool().run(y1 - y0 + 1, [&](int row, int worker) {
+            int y = y0 + row;
+            for (int x = x0; x <= x1; x++) {
+                float h = get_height_m(x, y, range);
+                float l = get_height_m(x - S, y, range), r = get_height_m(x + S, y, range);
+                float d = get_height_m(x, y - S, range), u = get_height_m(x, y + S, range);
+                size_t c = (size_t)y * width + x;
+                gradient[2*c] = encode_grade((r - l) / step_x);
+                gradient[2*c+1] = encode_grade((u - d) / step_y);
+                float laplacian = (l + r - 2.f * h) * inv_sqr_x + (d + u - 2.f * h) * inv_sqr_y;
+                curvature[c] = (int16_t)std::lround(glm::clamp(laplacian / FIELD_MAX_CURVATURE, -1.f, 1.f) * 32767.f);
+            }
+        });
+    }
+
+public:
+    float last_compute_ms = 0.f;
+
+    TerrainFields(ElevationLineDrawer *height_source, const TerrainData *terrain_data, bool debug_msg = false)
+        : height_source(height_source), terrain_data(terrain_data), debug_msg(debug_msg) {}
+
+    void compute() {
+        if (!height_source->is_loaded()) return;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        width = height_source->get_map_width();
+        height = height_source->get_map_height();
+        gradient.resize((size_t)width * height * 2);
+        curvature.resize((size_t)width * height);
+        TRACK_MEMORY(tracked_fields, get_capacity_bytes(gradient, curvature));
+        compute_rows(0, 0, width - 1, height - 1);
+        last_compute_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start_time).count();
+        if (debug_msg) std::cout << "Terrain fields of " << width << "x" << height << " computed in " << last_compute_ms << "ms." << std::endl;
+    }
+
+    // heights changed inside the pixel rectangle, returns the pixels whose derivatives changed (the stencil reaches out)
+    PixelRect update_pixels(const PixelRect &r) {
+        if (!is_computed() || r.is_empty()) return PixelRect::empty();
+        const int S = STEEPNESS_SMOOTHING_STEP_SIZE;
+        PixelRect out = { std::max(0, r.x0 - S), std::max(0, r.y0 - S), std::min(width - 1, r.x1 + S), std::min(height - 1, r.y1 + S) };
+        compute_rows(out.x0, out.y0, out.x1, out.y1);
+        return out;
+    }
+
+    bool is_computed() const { return !gradient.empty(); }
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+
+    // RG16 texture data, row 0 is local y = -0.5 like the heightmap
+    const uint16_t* get_gradient_data() const { return gradient.data(); }
+
+    // [rise over run] of the terrain, x and y in terrain local axes
+    vec2 get_gradient_at_pixel(int x, int y) const {
+        if (!is_computed()) return vec2(0.f);
+        size_t c = (size_t)glm::clamp(y, 0, height - 1) * width + glm::clamp(x, 0, width - 1);
+        return vec2(decode_grade(gradient[2*c]), decode_grade(gradient[2*c+1]));
+    }
+    vec2 get_gradient_at_local_pos(float x, float y) const {
+        return get_gradient_at_pixel((int)((x + 0.5f) * width), (int)((y + 0.5f) * height));
+    }
+
+    float get_slope_at_pixel(int x, int y) const { return glm::length(get_gradient_at_pixel(x, y)); }
+
+    // [rad] direction the ground falls towards, counter clockwise from local +x
+    float get_aspect_at_pixel(int x, int y) const {
+        vec2 g = get_gradient_at_pixel(x, y);
+        return std::atan2(-g.y, -g.x);
+    }
+
+    // local space normal, the terrain is not exaggerated so grades are the same in local units
+    vec3 get_normal_at_pixel(int x, int y) const {
+        vec2 g = get_gradient_at_pixel(x, y);
+        return glm::normalize(vec3(-g.x, -g.y, 1.f));
+    }
+
+    // [1/m] laplacian of the height, positive in hollows
+    float get_curvature_at_pixel(int x, int y) const {
+        if (!is_computed()) return 0.f;
+        return curvature[(size_t)glm::clamp(y, 0, height - 1) * width + glm::clamp(x, 0, width - 1)] / 32767.f * FIELD_MAX_CURVATURE;
+    }
+
+    // grade to the steepness used for colouring: the old per pixel height difference times STEEPNESS_SCALE,
+    // so the gradients keep their look
+    float get_steepness_scale() const {
+        return width > 0 ? STEEPNESS_SCALE / (terrain_data->vertical_scale * width) : 0.f;
+    }
+};
+
+#endif
@@ -12,6 +12,10 @@
 #include "settings/Settings.h"
 #include "ElevationLineDrawer.h"
 #include "TerrainData.h"
+#include "Hydrology.h"
+#include "TerrainFields.h"
+#include "settings/Parallel.h"
+#include "rendering/ResourceTracker.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -39,155 +43,127 @@ public:
         this->terrain_data = terrain_data;
     }
 
-    Texture bake_terrain_texture(bool release_data = true) {
+    ~TerrainPainter() { release_source(); }
+
+    // rivers and lakes are painted on dry land if a computed hydrology is given,
+    // steepness comes from the shared terrain fields when they are computed
+    Texture bake_terrain_texture(bool release_data = true, const Hydrology *hydrology = nullptr, const TerrainFields *fields = nullptr) {
         #if OVERWRITE_CACHED_TEXTURES
             bool debug_overwrite = true;
         #else
             bool debug_overwrite = false;
         #endif
 
-        // chceck if a generated texture already present - if so and no flag, use it
+        // re-bakes after terrain edits paint with the same inputs, also when the texture comes from the cache
+        this->hydrology = hydrology;
+        this->fields = fields;
+
+        // chceck if a generated texture already present - if so and no flag, use it; the painted inputs are part of its name
         std::string cleaned_name = clean_map_name(terrain_data->title);
-        std::string cache_path = std::string(TEXTURE_GENERATED_CACHE_FOLDER_PATH) + "/" + cleaned_name + "_colour_texture.png";
+        std::string inputs = std::string(hydrology && hydrology->is_computed() ? "_water" : "") + (fields && fields->is_computed() ? "_fields" : "");
+        std::string cache_path = std::string(TEXTURE_GENERATED_CACHE_FOLDER_PATH) + "/" + cleaned_name + inputs + "_colour_texture.png";
 
         if (!debug_overwrite && std::ifstream(cache_path).good()) {
             return Texture(cache_path.c_str(), false);
         }
 
-        // load terrain data
-        int width, height, nrChannels;
-        unsigned char* map_data = stbi_load(terrain_data->areas_data_path, &width, &height, &nrChannels, 3);
-        if (!map_data) return ERROR_EMPTY_TEXTURE_RETURN;
+        // paint, no GL involved up to the texture
+        std::vector<unsigned char> color_buffer;
+        if (!bake_terrain_pixels(color_buffer, hydrology, fields)) return ERROR_EMPTY_TEXTURE_RETURN;
+        int width = map_width, height = map_height;
 
+        // release raw data
+        if (release_data) release_source();
 
-        // load painting gradients
-        int grad_w;
-        std::vector<vec3> grad_elev = load_gradient_data(GRADIENT_ELEVATION_PATH, grad_w);
-        std::vector<vec3> grad_steep = load_gradient_data(GRADIENT_STEEPNESS_PATH, grad_w);
-        std::vector<vec3> grad_water = load_gradient_data(GRADIENT_WATER_PATH, grad_w);
+        // teturn generated png as texture
+        stbi_write_png(cache_path.c_str(), width, height, 3, color_buffer.data(), width * 3);
+        return Texture(width, height, color_buffer.data());
+    }
+
+    // RGB colour of every pixel of the areas map into color_buffer, false if the source could not be loaded
+    bool bake_terrain_pixels(std::vector<unsigned char> &color_buffer, const Hydrology *hydrology = nullptr, const TerrainFields *fields = nullptr) {
+        this->hydrology = hydrology;
+        this->fields = fields;
+
+        // load terrain data and painting gradients
+        if (!load_source()) return false;
+        int width = map_width, height = map_height;
 
         // init output colour buffer and arrays
-        std::vector<unsigned char> color_buffer(width * height * 3);
+        color_buffer.resize((size_t)width * height * 3);
         interactable_positions.clear();
         name_tag_positions.clear();
 
-        // helper function to query data at pixel
-        auto get_pixel = [&](int x, int y) -> glm::ivec3 {
-            int cx = glm::clamp(x, 0, width - 1);
-            int cy = glm::clamp(y, 0, height - 1);
-            int idx = (cy * width + cx) * 3;
-            return glm::ivec3(map_data[idx], map_data[idx+1], map_data[idx+2]);
-        };
+        // calculate colour for every pixel of output terrain
+        parallel_for(0, height, [&](int y, int worker) {
+            for (int x = 0; x < width; x++) write_colour(&color_buffer[((size_t)y * width + x) * 3], paint_pixel(x, y));
+        });
+        return true;
+    }
 
-        // Get Normalized Height (0.0 - 1.0) from Red Channel
-        auto get_h_norm = [&](int x, int y) -> float {
-            return (float)get_pixel(x, y).r / 255.0f;
-        };
+    // areas map and gradients from memory instead of the terrain data files, kept until the painter goes
+    void set_source(const unsigned char *areas_rgb, int width, int height,
+                    const std::vector<vec3> &elevation_gradient, const std::vector<vec3> &steepness_gradient, const std::vector<vec3> &water_gradient) {
+        release_source();
+        memory_source.assign(areas_rgb, areas_rgb + (size_t)width * height * 3);
+        map_data = memory_source.data();
+        map_width = width; map_height = height;
+        grad_elev = elevation_gradient; grad_steep = steepness_gradient; grad_water = water_gradient;
+        TRACK_MEMORY(tracked_source, get_capacity_bytes(memory_source));
+    }
 
-        // calculate colour for every pixel of output terrain
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                int idx = (y * width + x) * 3;
-
-                /* ================================================ */
-                /* COLOUR TERRAIN BOUNDARY  */
-
-                if (y < TERRAIN_BOUNDARY_PIXEL_NUM || x < TERRAIN_BOUNDARY_PIXEL_NUM || x >= width-TERRAIN_BOUNDARY_PIXEL_NUM || y >= height-TERRAIN_BOUNDARY_PIXEL_NUM) {
-                    color_buffer[idx] = (unsigned char)(Colour::TERRAIN_SIDE_COLOUR.r * 255.f);
-                    color_buffer[idx+1] = (unsigned char)(Colour::TERRAIN_SIDE_COLOUR.g * 255.f);
-                    color_buffer[idx+2] = (unsigned char)(Colour::TERRAIN_SIDE_COLOUR.b * 255.f);
-                    continue;
-                }
-
-                /* ================================================ */
-                /* ELEVATION AND STEEPNESS COLOURING  */
-
-                // get height at pixel
-                float get_height_at_pixel = get_pixel(x,y).r;
-                float norm_h = get_height_at_pixel / 255.f;
-                float pixel_elevation = terrain_data->minimum_height_reach + norm_h * (terrain_data->maximum_height_reach - terrain_data->minimum_height_reach);
-                vec3 final_colour;
-
-                // get steepness at pixel
-                const int S = STEEPNESS_SMOOTHING_STEP_SIZE;
-                float dx = (get_h_norm(x+S,y) - get_h_norm(x-S,y)) / (2.f*S);
-                float dy = (get_h_norm(x,y+S) - get_h_norm(x,y-S)) / (2.f*S);
-                float steepness = glm::length(vec2(dx, dy));
-
-                // find elevation region
-                bool is_under_water_level = pixel_elevation <= terrain_data->water_level_height;
-                bool is_dry_land = !is_under_water_level;
-                bool is_above_snow_level = pixel_elevation >= terrain_data->snow_level_height;
-
-                // apply water gradient
-                if (is_under_water_level) {
-                    float depth = glm::clamp((terrain_data->water_level_height- pixel_elevation) / terrain_data->water_level_height, 0.f, 1.f);
-                    final_colour = sample_gradient(grad_water, depth * depth);
-                }
-
-                // apply dry land - elevation and steepness gradients
-                if (is_dry_land) {
-                    float t_elev = glm::clamp(pixel_elevation / ELEVATION_GRADIENT_MAX_HEIGHT, 0.f, 1.f);
-                    float t_steep = glm::clamp(steepness * STEEPNESS_SCALE, 0.f, 1.f);
-                    final_colour = glm::mix(sample_gradient(grad_steep, t_steep), sample_gradient(grad_elev, t_elev), ELEVATION_GRADIENT_STRENGTH);
-                }
-
-                // apply extra snow layer
-                if (is_above_snow_level) {
-
-                    float height_above = pixel_elevation - terrain_data->snow_level_height;
-                    float above_snow_level_mult = height_above / SNOW_FALLOFF_RANGE;
-                    float falloff_ratio = glm::clamp(above_snow_level_mult*above_snow_level_mult, 0.0f, 1.0f);
-                    float allowed_steepness = glm::mix(SNOW_MAX_STEEPNESS, 1.0f, falloff_ratio);
-                    
-                    if (steepness * STEEPNESS_SCALE < allowed_steepness) {
-                        float snow_transition = glm::clamp(height_above / 50.0f, 0.0f, 1.0f); // Smooth transition at the very bottom edge of snow line
-                        float snow_opacity = snow_transition; //glm::clamp(snow_transition, 0.f, 1.f);
-                        final_colour = glm::mix(final_colour, vec3(Colour::SNOW_COLOUR), snow_opacity*Colour::SNOW_COLOUR.a);
-                    }
-                }
-                
-                /* ================================================ */
-                /* REGION SPECIFIC COLOURING  */
-                
-                // blue region check
-                if (is_border_pixel(x,y,width,height,map_data)) final_colour = BORDER_COLOUR;
-                else {
-                    float pixel_blue_channel = get_pixel(x,y).b;
-                    BlueRegions blue_region = ((int)(pixel_blue_channel+1) % 16) == 0 ? (BlueRegions)(int)(pixel_blue_channel) : BlueRegions::BLUE_NONE;
-                    if (blue_region != BlueRegions::BLUE_NONE) {
-                        vec4 blue_region_colour = get_color_from_map(BLUE_REGION_COLOURS, blue_region);
-                        final_colour = glm::mix(final_colour, vec3(blue_region_colour), BLUE_REGION_OPACITY);
-                    }
-                    else if (is_border_pixel(x,y,width,height,map_data)) final_colour = BORDER_COLOUR;
-                    
-                    // green region check
-                    float pixel_green_channel = get_pixel(x,y).g;
-                    GreenRegions green_region = ((int)(pixel_green_channel+1) % 16) == 0 ? (GreenRegions)(int)(pixel_green_channel) : GreenRegions::GREEN_NONE;
-                    if (green_region != GreenRegions::GREEN_NONE) {
-                        vec4 green_region_colour = get_color_from_map(GREEN_REGION_COLOURS, green_region);
-                        final_colour = glm::mix(final_colour, vec3(green_region_colour), GREEN_REGION_OPACITY);
-                    }
-                }
-                
-                                
-                // apply final colour
-                color_buffer[idx] = (unsigned char)(final_colour.r * 255.f);
-                color_buffer[idx+1] = (unsigned char)(final_colour.g * 255.f);
-                color_buffer[idx+2] = (unsigned char)(final_colour.b * 255.f);
-            }
+    // decoded areas map, loaded if the bake came from the texture cache; the red channel follows terrain edits
+    const unsigned char* get_areas_rgb() { return load_source() ? map_data : nullptr; }
+    int get_map_width() const { return map_width; }
+    int get_map_height() const { return map_height; }
+
+    // Heightmap pixel rectangles changed since the bake: their heights are copied into the areas map and every
+    // colour tile within the steepness stencil of them is repainted and uploaded to the texture.
+    void rebake_regions(ElevationLineDrawer *height_source, const vector<PixelRect> &rects, Texture *target) {
+        if (rects.empty() || !height_source->is_loaded()) return;
+        if (!map_data) {
+            // released after the bake, all earlier edits have to be copied in again
+            if (!load_source()) return;
+            copy_heights(height_source, { 0, 0, height_source->get_map_width() - 1, height_source->get_map_height() - 1 });
         }
-
-        // release raw data
-        if (release_data) {
-            stbi_image_free(map_data);
+        else for (const PixelRect &r : rects) copy_heights(height_source, r);
+
+        // touched tiles, the steepness stencil reaches STEEPNESS_SMOOTHING_STEP_SIZE pixels out
+        int tiles_x = (map_width + PAINTER_TILE_SIZE - 1) / PAINTER_TILE_SIZE, tiles_y = (map_height + PAINTER_TILE_SIZE - 1) / PAINTER_TILE_SIZE;
+        vector<unsigned char> touched(tiles_x * tiles_y, 0);
+        vector<int> tiles;
+        int margin = STEEPNESS_SMOOTHING_STEP_SIZE + 1;
+        for (const PixelRect &r : rects) {
+            PixelRect a = to_areas_rect(height_source, r);
+            int tx0 = std::max(0, (a.x0 - margin) / PAINTER_TILE_SIZE), tx1 = std::min(tiles_x - 1, (a.x1 + margin) / PAINTER_TILE_SIZE);
+            int ty0 = std::max(0, (a.y0 - margin) / PAINTER_TILE_SIZE), ty1 = std::min(tiles_y - 1, (a.y1 + margin) / PAINTER_TILE_SIZE);
+            for (int ty = ty0; ty <= ty1; ty++)
+                for (int tx = tx0; tx <= tx1; tx++)
+                    if (!touched[ty * tiles_x + tx]) { touched[ty * tiles_x + tx] = 1; tiles.push_back(ty * tiles_x + tx); }
         }
 
-        // teturn generated png as texture
-        stbi_write_png(cache_path.c_str(), width, height, 3, color_buffer.data(), width * 3);
-        return Texture(width, height, color_buffer.data());
+        // paint in parallel, upload on this thread
+        tile_buffers.resize(std::max(tile_buffers.size(), tiles.size()));
+        parallel_for(0, (int)tiles.size(), [&](int t, int worker) {
+            int x0 = tiles[t] % tiles_x * PAINTER_TILE_SIZE, y0 = tiles[t] / tiles_x * PAINTER_TILE_SIZE;
+            int w = std::min(PAINTER_TILE_SIZE, map_width - x0), h = std::min(PAINTER_TILE_SIZE, map_height - y0);
+            tile_buffers[t].resize(w * h * 3);
+            for (int y = 0; y < h; y++)
+                for (int x = 0; x < w; x++) write_colour(&tile_buffers[t][(y * w + x) * 3], paint_pixel(x0 + x, y0 + y));
+        });
+        size_t tile_bytes = 0;
+        for (const vector<unsigned char> &buffer : tile_buffers) tile_bytes += get_capacity_bytes(buffer);
+        TRACK_MEMORY(tracked_tiles, tile_bytes);
+        for (size_t t = 0; t < tiles.size(); t++) {
+            int x0 = tiles[t] % tiles_x * PAINTER_TILE_SIZE, y0 = tiles[t] / tiles_x * PAINTER_TILE_SIZE;
+            int w = std::min(PAINTER_TILE_SIZE, map_width - x0), h = std::min(PAINTER_TILE_SIZE, map_height - y0);
+            target->set_sub_data(x0, y0, w, h, GL_RGB, GL_UNSIGNED_BYTE, tile_buffers[t].data());
+        }
+        last_rebaked_tile_num = (int)tiles.size();
     }
 
+    int get_last_rebaked_tile_num() const { return last_rebaked_tile_num; }
+
     vector<vec2> get_interactable_positions() {
         return interactable_positions;
     }
@@ -196,6 +172,179 @@ public:
     }
 
 private:
+    // kept between the bake and partial re-bakes
+    unsigned char *map_data = nullptr;
+    std::vector<unsigned char> memory_source;   // set_source data, map_data points into it
+    int map_width = 0, map_height = 0;
+    std::vector<vec3> grad_elev, grad_steep, grad_water;
+    const Hydrology *hydrology = nullptr;
+    const TerrainFields *fields = nullptr;
+    vector<vector<unsigned char>> tile_buffers;
+    int last_rebaked_tile_num = 0;
+    TrackedMemory tracked_source, tracked_tiles;
+
+    bool load_source() {
+        if (map_data) return true;
+        int nrChannels;
+        map_data = stbi_load(terrain_data->areas_data_path, &map_width, &map_height, &nrChannels, 3);
+        if (!map_data) return false;
+        TRACK_MEMORY(tracked_source, (size_t)map_width * map_height * 3);
+
+        int grad_w;
+        grad_elev = load_gradient_data(GRADIENT_ELEVATION_PATH, grad_w);
+        grad_steep = load_gradient_data(GRADIENT_STEEPNESS_PATH, grad_w);
+        grad_water = load_gradient_data(GRADIENT_WATER_PATH, grad_w);
+        return true;
+    }
+
+    void release_source() {
+        if (!memory_source.empty()) return;
+        if (map_data) stbi_image_free(map_data);
+        map_data = nullptr;
+        TRACK_MEMORY(tracked_source, 0);
+    }
+
+    // helper function to query data at pixel
+    glm::ivec3 get_pixel(int x, int y) const {
+        int cx = glm::clamp(x, 0, map_width - 1);
+        int cy = glm::clamp(y, 0, map_height - 1);
+        int idx = (cy * map_width + cx) * 3;
+        return glm::ivec3(map_data[idx], map_data[idx+1], map_data[idx+2]);
+    }
+
+    // Get Normalized Height (0.0 - 1.0) from Red Channel
+    float get_h_norm(int x, int y) const {
+        return (float)get_pixel(x, y).r / 255.0f;
+    }
+
+    static void write_colour(unsigned char *out, vec3 colour) {
+        out[0] = (unsigned char)(colour.r * 255.f);
+        out[1] = (unsigned char)(colour.g * 255.f);
+        out[2] = (unsigned char)(colour.b * 255.f);
+    }
+
+    // heightmap pixel rectangle to the areas map pixels it covers, the two maps may differ in size
+    PixelRect to_areas_rect(ElevationLineDrawer *height_source, const PixelRect &r) const {
+        int hw = height_source->get_map_width(), hh = height_source->get_map_height();
+        return { r.x0 * map_width / hw, r.y0 * map_height / hh,
+                 std::min(map_width - 1, ((r.x1 + 1) * map_width + hw - 1) / hw - 1), std::min(map_height - 1, ((r.y1 + 1) * map_height + hh - 1) / hh - 1) };
+    }
+
+    // edited heights into the red channel, the painter reads heights from there like from the original map
+    void copy_heights(ElevationLineDrawer *height_source, const PixelRect &r) {
+        int hw = height_source->get_map_width(), hh = height_source->get_map_height();
+        PixelRect a = to_areas_rect(height_source, r);
+        for (int y = a.y0; y <= a.y1; y++)
+            for (int x = a.x0; x <= a.x1; x++)
+                map_data[(y * map_width + x) * 3] = (unsigned char)std::lround(glm::clamp(height_source->get_pixel_height(x * hw / map_width, y * hh / map_height), 0.f, 1.f) * 255.f);
+    }
+
+    vec3 paint_pixel(int x, int y) {
+        int width = map_width, height = map_height;
+        bool paint_water = hydrology && hydrology->is_computed();
+
+        /* ================================================ */
+        /* COLOUR TERRAIN BOUNDARY  */
+
+        if (y < TERRAIN_BOUNDARY_PIXEL_NUM || x < TERRAIN_BOUNDARY_PIXEL_NUM || x >= width-TERRAIN_BOUNDARY_PIXEL_NUM || y >= height-TERRAIN_BOUNDARY_PIXEL_NUM) {
+            return vec3(Colour::TERRAIN_SIDE_COLOUR);
+        }
+
+        /* ================================================ */
+        /* ELEVATION AND STEEPNESS COLOURING  */
+
+        // get height at pixel
+        float get_height_at_pixel = get_pixel(x,y).r;
+        float norm_h = get_height_at_pixel / 255.f;
+        float pixel_elevation = terrain_data->minimum_height_reach + norm_h * (terrain_data->maximum_height_reach - terrain_data->minimum_height_reach);
+        vec3 final_colour;
+
+        // get steepness at pixel, the terrain fields are in heightmap pixels
+        float steepness;
+        if (fields && fields->is_computed()) {
+            int fx = x * fields->get_width() / width, fy = y * fields->get_height() / height;
+            steepness = fields->get_slope_at_pixel(fx, fy) * fields->get_steepness_scale() / STEEPNESS_SCALE;
+        }
+        else {
+            const int S = STEEPNESS_SMOOTHING_STEP_SIZE;
+            float dx = (get_h_norm(x+S,y) - get_h_norm(x-S,y)) / (2.f*S);
+            float dy = (get_h_norm(x,y+S) - get_h_norm(x,y-S)) / (2.f*S);
+            steepness = glm::length(vec2(dx, dy));
+        }
+
+        // find elevation region
+        bool is_under_water_level = pixel_elevation <= terrain_data->water_level_height;
+        bool is_dry_land = !is_under_water_level;
+        bool is_above_snow_level = pixel_elevation >= terrain_data->snow_level_height;
+
+        // apply water gradient
+        if (is_under_water_level) {
+            float depth = glm::clamp((terrain_data->water_level_height- pixel_elevation) / terrain_data->water_level_height, 0.f, 1.f);
+            final_colour = sample_gradient(grad_water, depth * depth);
+        }
+
+        // apply dry land - elevation and steepness gradients
+        if (is_dry_land) {
+            float t_elev = glm::clamp(pixel_elevation / ELEVATION_GRADIENT_MAX_HEIGHT, 0.f, 1.f);
+            float t_steep = glm::clamp(steepness * STEEPNESS_SCALE, 0.f, 1.f);
+            final_colour = glm::mix(sample_gradient(grad_steep, t_steep), sample_gradient(grad_elev, t_elev), ELEVATION_GRADIENT_STRENGTH);
+        }
+
+        // apply rivers and lakes, the hydrology raster may differ in size from the areas map
+        if (is_dry_land && paint_water) {
+            int hx = x * hydrology->get_width() / width, hy = y * hydrology->get_height() / height;
+            if (hydrology->get_lake_at_pixel(hx, hy) >= 0) {
+                float depth = glm::clamp(hydrology->get_water_depth_at_pixel(hx, hy) / HYDRO_LAKE_FULL_DEPTH, 0.f, 1.f);
+                final_colour = sample_gradient(grad_water, depth * depth);
+            }
+            else {
+                float river = hydrology->get_river_strength_at_pixel(hx, hy);
+                if (river > 0.f) final_colour = glm::mix(final_colour, sample_gradient(grad_water, HYDRO_RIVER_GRADIENT_POS), river * HYDRO_RIVER_OPACITY);
+            }
+        }
+
+        // apply extra snow layer
+        if (is_above_snow_level) {
+
+            float height_above = pixel_elevation - terrain_data->snow_level_height;
+            float above_snow_level_mult = height_above / SNOW_FALLOFF_RANGE;
+            float falloff_ratio = glm::clamp(above_snow_level_mult*above_snow_level_mult, 0.0f, 1.0f);
+            float allowed_steepness = glm::mix(SNOW_MAX_STEEPNESS, 1.0f, falloff_ratio);
+            
+            if (steepness * STEEPNESS_SCALE < allowed_steepness) {
+                float snow_transition = glm::clamp(height_above / 50.0f, 0.0f, 1.0f); // Smooth transition at the very bottom edge of snow line
+                float snow_opacity = snow_transition; //glm::clamp(snow_transition, 0.f, 1.f);
+                final_colour = glm::mix(final_colour, vec3(Colour::SNOW_COLOUR), snow_opacity*Colour::SNOW_COLOUR.a);
+            }
+        }
+        
+        /* ================================================ */
+        /* REGION SPECIFIC COLOURING  */
+        
+        // blue region check
+        if (is_border_pixel(x,y,width,height,map_data)) final_colour = BORDER_COLOUR;
+        else {
+            float pixel_blue_channel = get_pixel(x,y).b;
+            BlueRegions blue_region = ((int)(pixel_blue_channel+1) % 16) == 0 ? (BlueRegions)(int)(pixel_blue_channel) : BlueRegions::BLUE_NONE;
+            if (blue_region != BlueRegions::BLUE_NONE) {
+                vec4 blue_region_colour = get_color_from_map(BLUE_REGION_COLOURS, blue_region);
+                final_colour = glm::mix(final_colour, vec3(blue_region_colour), BLUE_REGION_OPACITY);
+            }
+            else if (is_border_pixel(x,y,width,height,map_data)) final_colour = BORDER_COLOUR;
+            
+            // green region check
+            float pixel_green_channel = get_pixel(x,y).g;
+            GreenRegions green_region = ((int)(pixel_green_channel+1) % 16) == 0 ? (GreenRegions)(int)(pixel_green_channel) : GreenRegions::GREEN_NONE;
+            if (green_region != GreenRegions::GREEN_NONE) {
+                vec4 green_region_colour = get_color_from_map(GREEN_REGION_COLOURS, green_region);
+                final_colour = glm::mix(final_colour, vec3(green_region_colour), GREEN_REGION_OPACITY);
+            }
+        }
+        
+                        
+        return final_colour;
+    }
+
     static std::string clean_map_name(const std::string& name) {
         std::string cleaned = name;
         cleaned = std::regex_replace(cleaned, std::regex(", "), "-");
@@ -6,9 +6,11 @@
 #include <string>
 #include <vector>
 #include <regex>
+#include <iostream>
 #include "world_objects/Object.h"
 #include "world_objects/Plane.h"
 #include "rendering/Camera.h"
+#include "rendering/GpuTimer.h"
 #include "UIText.h"
 #include "settings/Settings.h"
 #include "ElevationLineDrawer.h"
@@ -25,12 +27,66 @@ class TerrainPlane : public Plane
 {
     const TerrainData *td;
 
+    // variant timing, see TERRAIN_SHADER_PROFILE_FRAMES
+    GpuTimer gpu_timer;
+    vector<float> variant_ms;
+    vector<int> variant_frames;
+    int profiled_variant = -1, profile_frame = 0;
+    bool profile_draining = false, profile_done = false;
+
+    void profile_render() {
+        int world_pos_variant = shader->get_world_pos_variant();
+        if (profiled_variant < 0) {
+            variant_ms.assign(shader->get_variant_num(), 0.f);
+            variant_frames.assign(shader->get_variant_num(), 0);
+            profiled_variant = shader->get_draw_variant();
+        }
+        gpu_timer.collect([&](int tag, float ms) { variant_ms[tag] += ms; variant_frames[tag]++; });
+
+        // back at the configured variant, wait for the last results
+        if (profile_draining) {
+            Plane::render();
+            if (gpu_timer.is_idle()) print_profile();
+            return;
+        }
+
+        bool world_pos_pass = shader->is_in_world_pos_pass();
+        int tag = world_pos_pass && world_pos_variant >= 0 ? world_pos_variant : shader->get_draw_variant();
+        bool timed = gpu_timer.begin(tag);
+        Plane::render();
+        if (timed) gpu_timer.end();
+        if (world_pos_pass) return;
+
+        // next draw variant after enough frames, the configured one is first and comes back last
+        if (++profile_frame < TERRAIN_SHADER_PROFILE_FRAMES) return;
+        profile_frame = 0;
+        int next = shader->get_draw_variant();
+        do next = (next + 1) % shader->get_variant_num(); while (next == world_pos_variant);
+        shader->set_draw_variant(next);
+        profile_draining = next == profiled_variant;
+    }
+
+    void print_profile() {
+        profile_done = true;
+        std::cout << "Terrain shader variants, GPU time per draw:" << std::endl;
+        for (int v = 0; v < shader->get_variant_num(); v++) {
+            if (!variant_frames[v]) continue;
+            std::cout << "  " << variant_ms[v] / variant_frames[v] << "ms  " << shader->get_variant_name(v)
+                      << (v == shader->get_world_pos_variant() ? " (world position pass)" : "") << std::endl;
+        }
+    }
+
 public:
     Camera *cam;
     TerrainPlane(const TerrainData *td, Camera *cam, vec3 pos = vec3(0.0f,0.0f,0.0f), vec3 size = vec3(1.0f,1.0f,1.0f) )
         : Plane(glm::max(td->resolution_x,td->resolution_y),pos,size), td(td), cam(cam)
     {}
 
+    void render() override {
+        if (TERRAIN_SHADER_PROFILE_FRAMES > 0 && !profile_done && visible) profile_render();
+        else Plane::render();
+    }
+
     void initialize_shader_properties() override {
         //shader->setFloat("camera_zoom_level", cam->get_current_orthographic_zoom())
         shader->use();
@@ -45,7 +101,7 @@ public:
         shader->setVec3("terrain_boundary_colour", Colour::TERRAIN_SIDE_COLOUR);
         shader->setInt("terrain_boundrary_pixel_width", TERRAIN_BOUNDARY_PIXEL_NUM);
         //shader->addTexture(new Texture(td->heightmap_path)); shader->setInt("heightmap",shader->get_last_loaded_tex_slot());
-        shader->addTexture(new Texture(td->areas_data_path)); shader->setInt("terrain_area_data",shader->get_last_loaded_tex_slot());
+        shader->addTexture(new Texture(td->areas_data_path), true); shader->setInt("terrain_area_data",shader->get_last_loaded_tex_slot());
 
         // --- Terrain contour lines ---
         shader->setFloat("iso_line_spacing", ISO_LINE_SPACING);
@@ -53,9 +109,9 @@ public:
         shader->setVec4("iso_line_colour", CONTOUR_LINE_COLOUR);
 
         // --- Terrain colour pallete ---
-        shader->addTexture(new GRADIENT_ELEVATION); shader->setInt("elevation_gradient",shader->get_last_loaded_tex_slot());
-        shader->addTexture(new GRADIENT_STEEPNESS); shader->setInt("steepness_gradient", shader->get_last_loaded_tex_slot());
-        shader->addTexture(new GRADIENT_WATER); shader->setInt("water_gradient", shader->get_last_loaded_tex_slot());
+        shader->addTexture(new GRADIENT_ELEVATION, true); shader->setInt("elevation_gradient",shader->get_last_loaded_tex_slot());
+        shader->addTexture(new GRADIENT_STEEPNESS, true); shader->setInt("steepness_gradient", shader->get_last_loaded_tex_slot());
+        shader->addTexture(new GRADIENT_WATER, true); shader->setInt("water_gradient", shader->get_last_loaded_tex_slot());
         shader->setFloat("elevation_gradient_max_height", ELEVATION_GRADIENT_MAX_HEIGHT);
         shader->setFloat("elevation_gradient_strength", ELEVATION_GRADIENT_STRENGTH);
         shader->setFloat("steepness_scale", STEEPNESS_SCALE);
@@ -70,6 +126,10 @@ public:
         shader->setFloat("snow_falloff_range", SNOW_FALLOFF_RANGE);
         shader->setFloat("snow_max_steepness", SNOW_MAX_STEEPNESS);
         shader->setVec4("snow_colour", Colour::SNOW_COLOUR);
+
+        // --- Reachability overlay, the map is added by Terrain when first shown ---
+        shader->setBool("reachability_enabled", false);
+        shader->setVec3("reachability_colour", REACH_COLOUR);
     }
 };
 
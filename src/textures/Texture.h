@@ -4,6 +4,7 @@
 #define TEXTURE_H
 
 #include <glad/glad.h>
+#include "rendering/ResourceTracker.h"
 
 #include <string>
 #include <fstream>
@@ -19,9 +20,9 @@
 class Texture
 {
 public:
-    unsigned int ID;
+    unsigned int ID = 0;
     unsigned int width = -1, height = -1;
-    const char* texturePath;
+    const char* texturePath = nullptr;
 
     // generate from file path
     Texture(const char* texturePath, bool flip_vert = true, bool load_16_bit = false) : texturePath(texturePath)
@@ -43,6 +44,8 @@ public:
 
             glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, width, height, 0, GL_RED, GL_UNSIGNED_SHORT, data);
             glGenerateMipmap(GL_TEXTURE_2D);
+            TRACK_GL_BYTES(RESOURCE_TEXTURE, ID, (size_t)width * height * get_texel_bytes(GL_R16));
+            TRACK_GL_MIPMAPS(ID);
             stbi_image_free(data);
 
         } else {
@@ -53,6 +56,8 @@ public:
             int colour_range = nrColourChannels == 4 ? GL_RGBA : nrColourChannels == 3 ? GL_RGB : GL_RED;
             glTexImage2D(GL_TEXTURE_2D, 0, colour_range, width, height, 0, colour_range, GL_UNSIGNED_BYTE, data);
             glGenerateMipmap(GL_TEXTURE_2D);    
+            TRACK_GL_BYTES(RESOURCE_TEXTURE, ID, (size_t)width * height * get_texel_bytes(colour_range));
+            TRACK_GL_MIPMAPS(ID);
             stbi_image_free(data);
         }
 
@@ -77,6 +82,62 @@ public:
         
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        TRACK_GL_BYTES(RESOURCE_TEXTURE, ID, (size_t)width * height * get_texel_bytes(GL_RGB));
+        TRACK_GL_MIPMAPS(ID);
+    }
+
+    // single channel 8 bit texture, contents are uploaded with set_red_data
+    Texture(int _width, int _height) : width(_width), height(_height)
+    {
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D, ID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+        TRACK_GL_BYTES(RESOURCE_TEXTURE, ID, (size_t)width * height * get_texel_bytes(GL_R8));
+    }
+
+    // any format, e.g. GL_RG16 for derived terrain fields; data may be nullptr
+    Texture(int _width, int _height, GLint internal_format, GLenum format, GLenum type, const void* data) : width(_width), height(_height)
+    {
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D, ID);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        TRACK_GL_BYTES(RESOURCE_TEXTURE, ID, (size_t)width * height * get_texel_bytes(internal_format));
+    }
+
+    // one owner per GL texture, moves hand it over
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+    Texture(Texture &&o) noexcept : ID(o.ID), width(o.width), height(o.height), texturePath(o.texturePath) { o.ID = 0; }
+
+    ~Texture() {
+        if (ID && has_gl_context()) glDeleteTextures(1, &ID);
+    }
+
+    void set_red_data(const unsigned char* data) {
+        glBindTexture(GL_TEXTURE_2D, ID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    // rectangle of a bigger image, rows of row_length pixels (0 when the data is just the rectangle)
+    void set_sub_data(int x, int y, int w, int h, GLenum format, GLenum type, const void* data, int row_length = 0) {
+        glBindTexture(GL_TEXTURE_2D, ID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format, type, data);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     }
 
     // activate the shader
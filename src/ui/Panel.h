@@ -55,9 +55,11 @@ public:
 
         glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
         glBufferData(GL_ARRAY_BUFFER, 20 * sizeof(float), Panel_vertices, GL_STATIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, this->VBO, 20 * sizeof(float));
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(unsigned int), Panel_indicies, GL_STATIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, this->EBO, 6 * sizeof(unsigned int));
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
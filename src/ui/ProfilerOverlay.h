@@ -0,0 +1,66 @@
+#ifndef PROFILEROVERLAY_H
+#define PROFILEROVERLAY_H
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "TextPanel.h"
+#include "ScreenUI.h"
+#include "settings/Settings.h"
+#include "settings/ColourData.h"
+#include "rendering/FrameProfiler.h"
+
+using namespace glm;
+
+// Rolling frame profiler statistics, one text panel per zone (UIText draws a single line).
+// Text is only rebuilt every FRAME_PROFILER_OVERLAY_INTERVAL frames while shown.
+class ProfilerOverlay
+{
+private:
+    vector<TextPanel*> rows;
+    bool shown = false;
+    int last_update_frame = -FRAME_PROFILER_OVERLAY_INTERVAL;
+
+    static std::string format_row(const char *name, float cpu_avg, float cpu_max, bool gpu, float gpu_avg) {
+        char buffer[128];
+        if (gpu) std::snprintf(buffer, sizeof(buffer), "%-18s cpu %6.2f  max %6.2f  gpu %6.2f ms", name, cpu_avg, cpu_max, gpu_avg);
+        else std::snprintf(buffer, sizeof(buffer), "%-18s cpu %6.2f  max %6.2f ms", name, cpu_avg, cpu_max);
+        return buffer;
+    }
+
+public:
+    void place(ScreenUI *screen_ui) {
+        for (int i = 0; i < FRAME_PROFILER_OVERLAY_ROWS; i++) {
+            TextPanel *row = new TextPanel("-", 0.4f, Colour::WHITE, Colour::DARK_GREY, vec2(560, 26), false, false, 8, vec2(4));
+            row->set_anchor(UIAnchor::TOP_LEFT, vec2(20, 20 + i * 26));
+            row->set_visible(false);
+            screen_ui->place(row);
+            rows.push_back(row);
+        }
+    }
+
+    void toggle() {
+        shown = !shown;
+        last_update_frame = -FRAME_PROFILER_OVERLAY_INTERVAL;
+        for (TextPanel *row : rows) row->set_visible(false);
+    }
+
+    void update(const FrameProfiler &profiler) {
+        if (!shown || profiler.get_frame_num() - last_update_frame < FRAME_PROFILER_OVERLAY_INTERVAL) return;
+        last_update_frame = profiler.get_frame_num();
+
+        // frame first, then the zones in the order they first ran
+        vector<string> names = { "frame" };
+        for (const string &name : profiler.get_zone_names()) if (name != "frame") names.push_back(name);
+
+        for (int i = 0; i < (int)rows.size(); i++) {
+            if (i >= (int)names.size()) { rows[i]->set_visible(false); continue; }
+            const ZoneStats &z = profiler.get_zone_stats(names[i]);
+            rows[i]->set_text(format_row(names[i].c_str(), ZoneStats::average(z.cpu_ms), ZoneStats::maximum(z.cpu_ms), z.gpu, ZoneStats::average(z.gpu_ms)));
+            rows[i]->set_visible(true);
+        }
+    }
+};
+
+#endif
@@ -76,8 +76,11 @@ public:
         button_callback = callback;
     }
 
+    // the ui owns what was placed in it unless the scene arena does, buttons are parts of those
     void clear_objects() {
+        for (UIObject *obj : objects) if (!obj->scene_allocated) delete obj;
         objects.clear();
+        buttons.clear();
     }
 };
 
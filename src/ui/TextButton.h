@@ -26,6 +26,8 @@ public:
 
         resize_and_reposition();
     }
+
+    ~TextButton() override { delete text_obj; }
     
     void construct() override {
         Button::construct();
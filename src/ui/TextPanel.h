@@ -30,6 +30,8 @@ public:
 
         resize_and_reposition();
     }
+
+    ~TextPanel() override { delete text_obj; }
     
     void construct() override {
         Panel::construct();
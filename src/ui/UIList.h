@@ -43,7 +43,7 @@ public:
         
         items.push_back(item);
 
-        if (this->shader) {
+        if (custom_shader) { // list already placed, otherwise its construct() builds the item
             item->construct();
             item->set_shader(this->shader);
         }
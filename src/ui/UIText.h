@@ -12,6 +12,7 @@
 
 #include "UIObject.h"
 #include "Shader.h"
+#include "rendering/ResourceTracker.h"
 
 struct Character {
     unsigned int TextureID;  
@@ -24,7 +25,7 @@ class UIText : public UIObject {
 private:
     std::string textString;
     float font_scale; // Renamed to avoid confusion with Object::size (transform scale)
-    unsigned int VAO, VBO;
+    unsigned int VAO = 0, VBO = 0;
     int height_below_writing_line = 0;
     
     static std::map<GLchar, Character> Characters;
@@ -43,7 +44,14 @@ public:
         resize_and_reposition();
     }
 
+    ~UIText() override {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+    }
+
+    // the glyph textures are shared by every text of every scene
     static void loadFont(const char* fontPath) {
+        GlobalResourceScope global_scope;
         FT_Library ft;
         if (FT_Init_FreeType(&ft)) { std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl; return; }
         FT_Face face;
@@ -56,6 +64,7 @@ public:
             glGenTextures(1, &texture);
             glBindTexture(GL_TEXTURE_2D, texture);
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
+            TRACK_GL_BYTES(RESOURCE_TEXTURE, texture, (size_t)face->glyph->bitmap.width * face->glyph->bitmap.rows * get_texel_bytes(GL_RED));
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -69,12 +78,19 @@ public:
         isFontLoaded = true;
     }
 
+    static void unload_font() {
+        for (auto &c : Characters) glDeleteTextures(1, &c.second.TextureID);
+        Characters.clear();
+        isFontLoaded = false;
+    }
+
     void construct() override {
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glBindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, VBO, sizeof(float) * 6 * 4);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(1);
@@ -7,6 +7,8 @@
 #include <algorithm>
 #include "settings/Utility.h"
 #include "settings/Settings.h"
+#include "rendering/FrameProfiler.h"
+#include "InputRecorder.h"
 #include "Window.h"
 
 const float DOUBLE_CLICK_WINDOW = 0.3f;
@@ -28,6 +30,7 @@ struct MouseClick {
 class InputHandler {
 public:
     bool simulation_paused = false, was_space_pressed = false, holding_shift = false;
+    bool profiler_overlay_toggled = false, was_f3_pressed = false, trace_dump_requested = false, was_f4_pressed = false;
     float scroll_value = 1.f, scroll_speed_multiplier = 10.f;
     vec2 mouse_position_normalized = vec2(0.f), last_mouse_position_pixels = vec2(0.f), mouse_position_pixels = vec2(0.f), mouse_position_pixels_inv_y = vec2(0.f);     // Surowe piksele ekranu
     
@@ -40,16 +43,47 @@ public:
     InputHandler() { instance = this; }
 
     void process_input(GLFWwindow *glfw_window, float dt, vec2 window_size){
+        apply_frame(poll_frame(glfw_window, dt), window_size);
+    }
+
+    // GLFW state of this frame, scroll is what the callback collected since the last poll
+    InputFrame poll_frame(GLFWwindow *glfw_window, float dt) {
+        InputFrame frame;
+        double xpos, ypos;
+        glfwGetCursorPos(glfw_window, &xpos, &ypos);
+        frame.cursor_x = (float)xpos;
+        frame.cursor_y = (float)ypos;
+        frame.scroll = pending_scroll;
+        frame.dt = dt;
+        pending_scroll = 0.f;
+
+        if (glfwGetMouseButton(glfw_window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS) frame.buttons |= INPUT_MOUSE_LEFT;
+        if (glfwGetMouseButton(glfw_window, GLFW_MOUSE_BUTTON_MIDDLE) == GLFW_PRESS) frame.buttons |= INPUT_MOUSE_MIDDLE;
+        if (glfwGetMouseButton(glfw_window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) frame.buttons |= INPUT_MOUSE_RIGHT;
+        if (glfwGetKey(glfw_window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) frame.buttons |= INPUT_KEY_SHIFT;
+        if (glfwGetKey(glfw_window, GLFW_KEY_SPACE) == GLFW_PRESS) frame.buttons |= INPUT_KEY_SPACE;
+        if (glfwGetKey(glfw_window, GLFW_KEY_F3) == GLFW_PRESS) frame.buttons |= INPUT_KEY_F3;
+        if (glfwGetKey(glfw_window, GLFW_KEY_F4) == GLFW_PRESS) frame.buttons |= INPUT_KEY_F4;
+        return frame;
+    }
+
+    // all input state is derived from the frame, so a recorded frame replays exactly
+    void apply_frame(const InputFrame &frame, vec2 window_size) {
+        float dt = frame.dt;
+        if (frame.scroll != 0.f) update_scroll_value(frame.scroll);
 
         // shift
-        holding_shift = glfwGetKey(glfw_window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS;
+        holding_shift = frame.is_down(INPUT_KEY_SHIFT);
 
         // pause 
-        if(glfwGetKey(glfw_window, GLFW_KEY_SPACE) == GLFW_PRESS) simulation_paused = !simulation_paused;
+        if(frame.is_down(INPUT_KEY_SPACE)) simulation_paused = !simulation_paused;
+
+        // frame profiler overlay and trace export, once per key press
+        profiler_overlay_toggled = update_key_press(frame.is_down(INPUT_KEY_F3), &was_f3_pressed);
+        trace_dump_requested = update_key_press(frame.is_down(INPUT_KEY_F4), &was_f4_pressed);
 
         // get mouse position
-        double xpos, ypos;
-        glfwGetCursorPos(glfw_window, &xpos, &ypos);
+        double xpos = frame.cursor_x, ypos = frame.cursor_y;
         last_mouse_position_pixels = mouse_position_pixels;
         mouse_position_normalized = vec2((float)(xpos / SCR_WIDTH)*2.f, (0.5f - (float)(ypos / SCR_HEIGHT))*2.f);
         mouse_position_normalized += vec2(0.011f, -0.015f); // offset idk why ???
@@ -59,14 +93,15 @@ public:
         mouse_position_pixels_inv_y = vec2(glm::clamp((float)xpos,0.f,window_size.x), glm::clamp(window_size.y - (float)ypos,0.f,window_size.y));
 
         // mouse button logic
-        update_mouse_click_logic(&mouse_left, glfwGetMouseButton(glfw_window, GLFW_MOUSE_BUTTON_LEFT), dt);
-        update_mouse_click_logic(&mouse_middle, glfwGetMouseButton(glfw_window, GLFW_MOUSE_BUTTON_MIDDLE), dt);
-        update_mouse_click_logic(&mouse_right, glfwGetMouseButton(glfw_window, GLFW_MOUSE_BUTTON_RIGHT), dt);
+        update_mouse_click_logic(&mouse_left, frame.is_down(INPUT_MOUSE_LEFT) ? GLFW_PRESS : GLFW_RELEASE, dt);
+        update_mouse_click_logic(&mouse_middle, frame.is_down(INPUT_MOUSE_MIDDLE) ? GLFW_PRESS : GLFW_RELEASE, dt);
+        update_mouse_click_logic(&mouse_right, frame.is_down(INPUT_MOUSE_RIGHT) ? GLFW_PRESS : GLFW_RELEASE, dt);
     }
     
     // Scroll wheel logic
+    // collected until the next poll_frame, so the wheel is part of the recorded frame
     static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
-        if (instance) instance->update_scroll_value((float)yoffset);
+        if (instance) instance->pending_scroll += (float)yoffset;
     }
     void update_scroll_value(float yoffset) {
         scroll_value -= yoffset * scroll_speed_multiplier; 
@@ -84,6 +119,7 @@ public:
 
     vec3 get_mouse_position_world() {
         // 2. Odczytaj piksel pod myszą
+        PROFILE_ZONE("read world pos");     // waits for the world position pass to finish
         int mouse_y_gl = SCR_HEIGHT - (int)mouse_position_pixels.y; // Odwróć oś Y GL
         
         float pixelData[3];
@@ -114,8 +150,18 @@ public:
     bool get_simulation_paused() { return simulation_paused; }
     float get_scroll_value() { return scroll_value; }
     bool is_holding_shift() { return holding_shift; }
+    bool is_profiler_overlay_toggled() { return profiler_overlay_toggled; }
+    bool is_trace_dump_requested() { return trace_dump_requested; }
 
 private:
+    float pending_scroll = 0.f;
+
+    bool update_key_press(bool pressed, bool *was_pressed) {
+        bool just_pressed = pressed && !*was_pressed;
+        *was_pressed = pressed;
+        return just_pressed;
+    }
+
     void update_mouse_click_logic(MouseClick *state, int curr_val, float dt) {
         
         bool was_held = state->is_held;
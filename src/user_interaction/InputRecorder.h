@@ -0,0 +1,151 @@
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "settings/Settings.h"
+#include "settings/Utility.h"
+
+using namespace std;
+
+#define INPUT_RECORDING_OFF 0
+#define INPUT_RECORDING_RECORD 1
+#define INPUT_RECORDING_REPLAY 2
+
+#define INPUT_RECORDING_MAGIC "LTIR"
+#define INPUT_RECORDING_VERSION 1
+#define INPUT_RECORDING_FRAME_BYTES 17
+
+enum InputBit {
+    INPUT_MOUSE_LEFT = 1, INPUT_MOUSE_MIDDLE = 2, INPUT_MOUSE_RIGHT = 4,
+    INPUT_KEY_SHIFT = 8, INPUT_KEY_SPACE = 16, INPUT_KEY_F3 = 32, INPUT_KEY_F4 = 64
+};
+
+// everything InputHandler reads from GLFW in one frame
+struct InputFrame {
+    float cursor_x = 0.f, cursor_y = 0.f;   // [px] as reported by GLFW
+    float scroll = 0.f;                     // wheel offset since the last frame
+    float dt = 0.f;                         // [s] frame time the input was processed with
+    unsigned char buttons = 0;              // InputBit flags
+
+    bool is_down(InputBit bit) const { return (buttons & bit) != 0; }
+};
+
+// Records the per frame input of a session to a compact binary file, or feeds a recording back frame by frame
+// with the recorded frame times and collects the frame times of the replay. File: 4 byte magic, version and the worker number of the
+// recording machine (uint32 each, little endian), then INPUT_RECORDING_FRAME_BYTES per frame until the end.
+class InputRecorder
+{
+private:
+    int mode = INPUT_RECORDING_OFF;
+    std::ofstream out;
+    vector<InputFrame> replay_frames;
+    int frame_index = 0;                    // frames recorded or replayed so far
+    uint32_t recorded_worker_num = 0;
+
+    std::chrono::steady_clock::time_point frame_start;
+    vector<float> frame_ms;
+
+    template <typename T>
+    static void write_value(std::ostream &s, T value) { s.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+    template <typename T>
+    static bool read_value(std::istream &s, T &value) { return (bool)s.read(reinterpret_cast<char*>(&value), sizeof(T)); }
+
+public:
+    ~InputRecorder() { if (out.is_open()) out.close(); }
+
+    bool start_recording(const char *path, int worker_num) {
+        out.open(path, std::ios::binary);
+        if (!out) { std::cout << "Could not open input recording " << path << std::endl; return false; }
+        out.write(INPUT_RECORDING_MAGIC, 4);
+        write_value<uint32_t>(out, INPUT_RECORDING_VERSION);
+        write_value<uint32_t>(out, (uint32_t)worker_num);
+        mode = INPUT_RECORDING_RECORD;
+        std::cout << "Recording input to " << path << std::endl;
+        return true;
+    }
+
+    void record(const InputFrame &frame) {
+        if (mode != INPUT_RECORDING_RECORD) return;
+        write_value(out, frame.cursor_x);
+        write_value(out, frame.cursor_y);
+        write_value(out, frame.scroll);
+        write_value(out, frame.dt);
+        write_value(out, frame.buttons);
+        // a closed window ends the process without a chance to flush
+        if (++frame_index % 60 == 0) out.flush();
+    }
+
+    bool load_replay(const char *path) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[4];
+        uint32_t version = 0;
+        if (!in || !in.read(magic, 4) || std::memcmp(magic, INPUT_RECORDING_MAGIC, 4) != 0 || !read_value(in, version) || version != INPUT_RECORDING_VERSION) {
+            std::cout << "Could not read input recording " << path << std::endl;
+            return false;
+        }
+        read_value(in, recorded_worker_num);
+
+        InputFrame f;
+        while (read_value(in, f.cursor_x) && read_value(in, f.cursor_y) && read_value(in, f.scroll) && read_value(in, f.dt) && read_value(in, f.buttons)) {
+            replay_frames.push_back(f);
+        }
+        mode = INPUT_RECORDING_REPLAY;
+        frame_index = 0;
+        frame_ms.reserve(replay_frames.size());
+        std::cout << "Replaying " << replay_frames.size() << " input frames from " << path << std::endl;
+        return true;
+    }
+
+    bool is_recording() const { return mode == INPUT_RECORDING_RECORD; }
+    bool is_replaying() const { return mode == INPUT_RECORDING_REPLAY; }
+    bool is_replay_finished() const { return is_replaying() && frame_index >= (int)replay_frames.size(); }
+    int get_recorded_worker_num() const { return (int)recorded_worker_num; }
+
+    // next recorded frame with the dt it was recorded with, so dt driven motion (camera, brush) ends up where it did.
+    // INPUT_REPLAY_FIXED_DT > 0 replaces it for timing runs that want the same simulated time per frame
+    InputFrame next_replay_frame() {
+        if (replay_frames.empty()) return InputFrame();
+        InputFrame f = replay_frames[std::min(frame_index, (int)replay_frames.size() - 1)];
+        frame_index++;
+        if (INPUT_REPLAY_FIXED_DT > 0.f) f.dt = INPUT_REPLAY_FIXED_DT;
+        return f;
+    }
+
+    /* Replay timing */
+
+    void begin_frame() { frame_start = std::chrono::steady_clock::now(); }
+    void end_frame() {
+        if (!is_replaying()) return;
+        frame_ms.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frame_start).count());
+    }
+
+    // one line per frame to path and a summary to the console
+    void write_replay_timings(const char *path) {
+        std::ofstream file(path);
+        if (file) {
+            file << "frame,frame_ms\n";
+            for (size_t i = 0; i < frame_ms.size(); i++) file << i << "," << frame_ms[i] << "\n";
+        }
+        float total = 0.f;
+        for (float ms : frame_ms) total += ms;
+        std::cout << "Replay of " << frame_ms.size() << " frames: mean " << (frame_ms.empty() ? 0.f : total / frame_ms.size())
+                  << "ms, p50 " << get_percentile(frame_ms, 50.f) << "ms, p95 " << get_percentile(frame_ms, 95.f)
+                  << "ms, p99 " << get_percentile(frame_ms, 99.f) << "ms, max " << get_percentile(frame_ms, 100.f) << "ms"
+                  << (file ? ", frame times written to " : ", could not write ") << path << std::endl;
+    }
+};
+
+inline InputRecorder& get_input_recorder() {
+    static InputRecorder recorder;
+    return recorder;
+}
+
+#endif
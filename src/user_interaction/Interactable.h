@@ -36,6 +36,7 @@ class Interactable : public Object {
     Sphere render_sphere;
 
     bool disabled = false;
+    bool highlighted = false;
 
     Interactable(vec3 position, const char* name, InteractionType type, float interaction_distance, int id=-1) : 
         Object(position,vec3(interaction_distance)), 
@@ -43,9 +44,24 @@ class Interactable : public Object {
         render_sphere(position, interaction_distance*INTERACTABLE_RENDER_RADUIS_MUTLIPLIER),
         name(name), type(type), id(id)
         {
+        init_properties();
+    }
+    // handle of a manager, it and its sphere draw with the manager's shader
+    Interactable(vec3 position, const char* name, InteractionType type, float interaction_distance, int id, Shader *shared_shader) : 
+        Object(position,vec3(interaction_distance),shared_shader), 
+        interaction_distance(interaction_distance),
+        render_sphere(position, interaction_distance*INTERACTABLE_RENDER_RADUIS_MUTLIPLIER, shared_shader),
+        name(name), type(type), id(id)
+        {
+        init_properties();
+    }
+
+    void init_properties() {
         this->render_to_world_pos = false;
         interaction_distance_sqr = interaction_distance*interaction_distance;
         highlight_distance_sqr = interaction_distance_sqr;
+        render_sphere.set_colour( INTERACTABLE_DEFUALT_COLOUR );
+        render_sphere.set_transparency ( INTERACTABLE_OBJECT_ALPHA );
         std::cout << "created interactable: " << name << std::endl;
     }
 
@@ -57,28 +73,40 @@ class Interactable : public Object {
         if (type == InteractionType::NONE || disabled) return;
         
         render_sphere.set_colour( Colour::RED );
+        highlighted = false; // next highlight transition restores the colour
         for (const auto& callback : callbacks) { 
             if (callback) callback(this);
         }
     }
     
-    void process (float distance_sqr, bool call_in_range ) {
-        if (type == InteractionType::NONE || disabled) return;
+    // returns true if the object is highlighted after processing
+    bool process (float distance_sqr, bool call_in_range ) {
+        if (type == InteractionType::NONE || disabled) return false;
 
         //highlight obj if in range
-        if (distance_sqr <= highlight_distance_sqr){
+        bool in_highlight_range = distance_sqr <= highlight_distance_sqr;
+        set_highlighted(in_highlight_range);
+
+        // call if in range and flag set
+        if (call_in_range && distance_sqr <= interaction_distance_sqr) call();
+        return in_highlight_range;
+    }
+
+    // render properties only change on a state transition
+    void set_highlighted (bool state) {
+        if (state == highlighted) return;
+        highlighted = state;
+        if (highlighted) {
             render_sphere.set_colour( INTERACTABLE_HIGHLIGHTED_COLOUR );
             render_sphere.set_transparency ( INTERACTABLE_HIGHLIGHTED_OBJECT_ALPHA );
         } else {
             render_sphere.set_colour( INTERACTABLE_DEFUALT_COLOUR );
             render_sphere.set_transparency ( INTERACTABLE_OBJECT_ALPHA );
         }
-
-        // call if in range and flag set
-        if (call_in_range && distance_sqr <= interaction_distance_sqr) call();
     }
 
     void configure_render_properties () override {
+        if (!owned_shader) render_sphere.render_props_changed = true; // a shared shader still has the colour of the last handle drawn
         render_sphere.configure_render_properties();
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -5,8 +5,11 @@
 #include "rendering/Camera.h" // The base class for all renderable entities
 #include "World.h" // The base class for all renderable entities
 #include "Interactable.h" // The base class for all renderable entities
+#include "SceneArena.h"
 #include <vector>
 #include <memory>   // Required for std::unique_ptr
+#include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <stdexcept>
 
@@ -14,6 +17,8 @@ class Object;
 
 using namespace glm;
 
+#define INTERACTABLE_GRID_SIZE ((int)std::ceil(1.f / INTERACTABLE_GRID_CELL_SIZE))
+
 class InteractableManager {
 public:
     std::vector<Interactable*> interactables;
@@ -21,25 +26,42 @@ public:
     const InteractionCallback callback_function;
 
     InteractableManager (World *world_ref, const InteractionCallback& callback_function) 
-        : world_ref(world_ref), callback_function(callback_function) {}
+        : world_ref(world_ref), callback_function(callback_function), handle_shader(new DEFAULT_WORLD_SHADER),
+          grid_cells(INTERACTABLE_GRID_SIZE * INTERACTABLE_GRID_SIZE) {}
+    // the handles themselves are the scene pool's
+    ~InteractableManager() { delete handle_shader; }
+    InteractableManager(const InteractableManager&) = delete;
+    InteractableManager& operator=(const InteractableManager&) = delete;
 
+    // only interactables in grid cells around the cursor are tested, highlight changes are edge triggered
     void process_all ( vec3 click_pos, bool call_objects_in_range ) {
-        for (const auto& i : interactables) {
+        query_radius(vec2(click_pos), max_interaction_distance, nearby);
+
+        next_highlighted.clear();
+        for (int index : nearby) {
+            Interactable *i = interactables[index];
             float dx = click_pos.x - i->position.x;
             float dy = click_pos.y - i->position.y;
             float dz = click_pos.z - i->position.z;
             float distance_squared = dx*dx + dy*dy + dz*dz;
-            i->process(distance_squared, call_objects_in_range);
+            if (i->process(distance_squared, call_objects_in_range)) next_highlighted.push_back(index);
+        }
+
+        // switch off highlights of everything the cursor has left
+        for (int index : highlighted) {
+            if (std::find(next_highlighted.begin(), next_highlighted.end(), index) == next_highlighted.end())
+                interactables[index]->set_highlighted(false);
         }
+        std::swap(highlighted, next_highlighted);
     }
     void resize_on_zoom( float current_zoom ){
-        float resize_mult = glm::clamp(current_zoom, 0.3f, 1.8f);
-        for (const auto& i: interactables) {
-            i->set_size(resize_mult * INTERACTABLE_INTERACT_DISTANCE * INTERACTABLE_RENDER_RADUIS_MUTLIPLIER);
-        }
+        if (current_zoom == last_zoom) return;
+        last_zoom = current_zoom;
+        for (const auto& i: interactables) i->set_size(get_render_size());
     }
+    // handles live in the scene pool, contiguous and released with the scene, and share one shader
     Interactable* create(vec3 pos, const char* name, InteractionType interaction_type, float interact_dist) {
-        Interactable* intr = new Interactable(pos, name, interaction_type, interact_dist, interactables.size());
+        Interactable* intr = get_scene_pool<Interactable>().create(pos, name, interaction_type, interact_dist, (int)interactables.size(), handle_shader);
         add(intr);
         return intr;
     }
@@ -47,15 +69,69 @@ public:
         this->interactables.push_back(interactable);
         interactable->add_callback (callback_function);
         interactable->set_id(interactables.size()-1);
+        if (last_zoom >= 0.f) interactable->set_size(get_render_size());
+
+        // spatial grid entry
+        int cell = get_cell(vec2(interactable->position));
+        grid_cells[cell].push_back(interactable->get_id());
+        cell_of_interactable.push_back(cell);
+        max_interaction_distance = glm::max(max_interaction_distance,
+            std::sqrt(glm::max(interactable->highlight_distance_sqr, interactable->interaction_distance_sqr)));
 
         Object* obj = dynamic_cast<Object*>(interactable);
         if (!obj) {
             throw std::runtime_error("add: Interactable is not an Object");
         }
-        obj->construct();
-        world_ref->place(obj);
+        world_ref->place(obj);     // constructs it
+    }
+    // has to be called after an added interactable is moved (e.g. attached to the terrain surface)
+    void update_position(Interactable* interactable) {
+        int index = interactable->get_id();
+        if (index < 0 || index >= (int)interactables.size() || interactables[index] != interactable) return;
+
+        int new_cell = get_cell(vec2(interactable->position));
+        int old_cell = cell_of_interactable[index];
+        if (new_cell == old_cell) return;
+
+        std::vector<int> &old_list = grid_cells[old_cell];
+        auto it = std::find(old_list.begin(), old_list.end(), index);
+        if (it != old_list.end()) { *it = old_list.back(); old_list.pop_back(); }
+        grid_cells[new_cell].push_back(index);
+        cell_of_interactable[index] = new_cell;
+    }
+    // indices of interactables in all grid cells overlapping the circle (xy, terrain local)
+    void query_radius(vec2 pos, float radius, std::vector<int> &out) {
+        out.clear();
+        int min_x = get_cell_coord(pos.x - radius), max_x = get_cell_coord(pos.x + radius);
+        int min_y = get_cell_coord(pos.y - radius), max_y = get_cell_coord(pos.y + radius);
+        for (int y = min_y; y <= max_y; y++) {
+            for (int x = min_x; x <= max_x; x++) {
+                const std::vector<int> &cell = grid_cells[y * INTERACTABLE_GRID_SIZE + x];
+                out.insert(out.end(), cell.begin(), cell.end());
+            }
+        }
     }
     vector<Interactable*> get_current_interactables() { return interactables; }
+    Shader* get_handle_shader() { return handle_shader; }
+
+private:
+    Shader *handle_shader;
+    std::vector<std::vector<int>> grid_cells;   // interactable ids per cell, positions outside the terrain clamp to the border cells
+    std::vector<int> cell_of_interactable;
+    std::vector<int> nearby, highlighted, next_highlighted;
+    float max_interaction_distance = 0.f;
+    float last_zoom = -1.f;
+
+    float get_render_size() {
+        float resize_mult = glm::clamp(last_zoom, 0.3f, 1.8f);
+        return resize_mult * INTERACTABLE_INTERACT_DISTANCE * INTERACTABLE_RENDER_RADUIS_MUTLIPLIER;
+    }
+    int get_cell_coord(float local) {
+        return glm::clamp((int)std::floor((local + 0.5f) / INTERACTABLE_GRID_CELL_SIZE), 0, INTERACTABLE_GRID_SIZE - 1);
+    }
+    int get_cell(vec2 local_pos) {
+        return get_cell_coord(local_pos.y) * INTERACTABLE_GRID_SIZE + get_cell_coord(local_pos.x);
+    }
 };
 
 #endif // InteractableManager_H
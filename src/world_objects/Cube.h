@@ -37,6 +37,7 @@ public:
         glBindVertexArray(this->VAO);
         glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
         glBufferData(GL_ARRAY_BUFFER, 180*sizeof(float), Cube::vertices, GL_STATIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, this->VBO, 180*sizeof(float));
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3*sizeof(float)));
@@ -22,6 +22,7 @@ private:
     unsigned int vbo = 0;
     std::vector<vec3> points;
     float line_thickness = 5.f;
+    bool points_changed = true; // vertex buffer is only re-uploaded after the points change
 
 public:
     Line(std::vector<vec3> points, float line_thickness = 3.f)
@@ -48,8 +49,12 @@ public:
         //glDisable(GL_DEPTH_TEST);
 
         glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(glm::vec3), points.data(), GL_DYNAMIC_DRAW);
+        if (points_changed) {
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(glm::vec3), points.data(), GL_DYNAMIC_DRAW);
+            TRACK_GL_BYTES(RESOURCE_BUFFER, vbo, points.size() * sizeof(glm::vec3));
+            points_changed = false;
+        }
 
         glLineWidth(line_thickness);
         
@@ -59,10 +64,10 @@ public:
         //glEnable(GL_DEPTH_TEST);
     }
 
-    void add_point(vec3 p) { points.push_back(p); }
-    void add_points(std::vector<vec3> new_points) { for (auto p : new_points) points.push_back(p); }
-    void set_points(std::vector<vec3> new_points) { this->points = new_points; }
-    void clear_points() { points.clear(); }
+    void add_point(vec3 p) { points.push_back(p); points_changed = true; }
+    void add_points(const std::vector<vec3> &new_points) { points.insert(points.end(), new_points.begin(), new_points.end()); points_changed = true; }
+    void set_points(const std::vector<vec3> &new_points) { this->points = new_points; points_changed = true; }
+    void clear_points() { points.clear(); points_changed = true; }
     int get_point_num() { return points.size(); }
     std::vector<vec3> get_points() { return points; }
     vec3 get_last_point() { return points.back(); }
@@ -19,6 +19,7 @@ public:
     vec3 rotation = vec3(0.f);
     bool visible = true;
     Shader *shader = new DEFAULT_WORLD_SHADER;
+    Shader *owned_shader = shader;      // deleted with the object, nullptr when the shader belongs to someone else
 
     bool custom_shader = false;
 
@@ -35,12 +36,21 @@ public:
 
     bool is_screen_object = false;
     bool render_props_changed = true;
+    bool scene_allocated = false;       // memory belongs to the scene arena, it is destroyed on release instead of deleted
 
-    virtual ~Object() = default;
+    virtual ~Object() { delete owned_shader; }
+
+    // the owned shader and GL objects of the subclasses are not shareable
+    Object(const Object&) = delete;
+    Object& operator=(const Object&) = delete;
 
     Object(vec3 pos = vec3(0.0f), vec3 size = vec3(1.0f))
         : position(pos), size(size) {
     }
+    // objects with many instances use one shader instead of compiling their own, its owner keeps it
+    Object(vec3 pos, vec3 size, Shader *shared_shader)
+        : position(pos), size(size), shader(shared_shader), owned_shader(nullptr) {
+    }
         
     // necessary functions
     virtual void render() = 0;
@@ -98,11 +108,20 @@ public:
     void set_tint_colour (vec3 new_colour) { tint_colour = vec4(new_colour, 1.f); render_props_changed = true;  }
     void set_tint_colour (vec4 new_colour) { tint_colour = new_colour; if (new_colour.a !=1.f) { opacity = new_colour.a*colour.a; render_props_changed = true; } }
     void set_texture (Texture *tex) { uses_texture = true; shader->addTexture(tex); shader->use(); shader->setInt("texture", shader->get_last_loaded_tex_slot()); render_props_changed = true; }
-    virtual void set_shader (Shader *s) { shader = s; render_props_changed = true; custom_shader = true; }
+    virtual void set_shader (Shader *s) { release_owned_shader(s); shader = s; render_props_changed = true; custom_shader = true; }
+    void set_owned_shader (Shader *s) { set_shader(s); owned_shader = s; }
     void set_screenspace() { is_screen_object = true; }
     void enable_shader() { shader->use(); }
     virtual void update_transform() { shader->setMatrix("transform", global_transform_matrix); }
     virtual int get_id() { return -1; }
+
+protected:
+    // the default shader is dropped once another one is set, before the camera has been given it
+    void release_owned_shader(Shader *replacement) {
+        if (owned_shader == replacement) return;
+        delete owned_shader;
+        owned_shader = nullptr;
+    }
 };
 
 #endif // OBJECT_H
\ No newline at end of file
@@ -110,9 +110,11 @@ private:
 
         glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
         glBufferData(GL_ARRAY_BUFFER, subdiv_vertices.size() * sizeof(float), subdiv_vertices.data(), GL_STATIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, this->VBO, subdiv_vertices.size() * sizeof(float));
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, subdiv_indices.size() * sizeof(unsigned int), subdiv_indices.data(), GL_STATIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, this->EBO, subdiv_indices.size() * sizeof(unsigned int));
     }
 };
 
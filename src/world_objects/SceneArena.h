@@ -0,0 +1,160 @@
+#ifndef SCENEARENA_H
+#define SCENEARENA_H
+
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include "settings/Settings.h"
+#include "rendering/ResourceTracker.h"
+#include "Object.h"
+
+using namespace std;
+
+// Memory for what a scene creates and only drops when the scene ends. Allocation is a pointer bump in
+// large blocks, ObjectPool keeps the objects of one type in contiguous chunks taken from the arena. Nothing
+// is destroyed earlier: release() runs every destructor, pools first and then the arena objects in reverse
+// creation order, and rewinds the arena; main calls it after the world and the ui dropped their pointers.
+// Objects created here are marked scene_allocated, World and ScreenUI leave them to the arena.
+
+inline void mark_scene_allocated(Object *obj) { obj->scene_allocated = true; }
+inline void mark_scene_allocated(const void *) {}
+
+class ScenePoolBase
+{
+public:
+    virtual ~ScenePoolBase() {}
+    virtual void release() = 0;
+};
+
+class SceneArena
+{
+private:
+    struct Block {
+        char *data;
+        size_t size;
+    };
+    struct Destructor {
+        void *obj;
+        void (*destroy)(void *obj);
+    };
+
+    vector<Block> blocks;
+    size_t current_block = 0, used = 0;     // bump position in blocks[current_block]
+    size_t block_bytes = 0;
+    vector<Destructor> destructors;
+    vector<ScenePoolBase*> pools;
+    TrackedMemory tracked_blocks;
+
+    void add_block(size_t min_size) {
+        size_t size = std::max((size_t)SCENE_ARENA_BLOCK_BYTES, min_size);
+        blocks.push_back({ static_cast<char*>(::operator new(size)), size });
+        current_block = blocks.size() - 1;
+        used = 0;
+        block_bytes += size;
+        GlobalResourceScope global_scope;   // the first block is kept between scenes
+        TRACK_MEMORY(tracked_blocks, block_bytes);
+    }
+
+public:
+    SceneArena() {}
+    SceneArena(const SceneArena&) = delete;
+    SceneArena& operator=(const SceneArena&) = delete;
+
+    // alignment has to be a power of two
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        while (current_block < blocks.size()) {
+            Block &b = blocks[current_block];
+            uintptr_t base = reinterpret_cast<uintptr_t>(b.data);
+            size_t start = ((base + used + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+            if (start + bytes <= b.size) {
+                used = start + bytes;
+                return b.data + start;
+            }
+            current_block++;
+            used = 0;
+        }
+        add_block(bytes + alignment);
+        return allocate(bytes, alignment);
+    }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        T *obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+            destructors.push_back({ obj, [](void *p) { static_cast<T*>(p)->~T(); } });
+        mark_scene_allocated(obj);
+        return obj;
+    }
+
+    void add_pool(ScenePoolBase *pool) { pools.push_back(pool); }
+
+    // everything created since the last release is destroyed, the first block stays for the next scene
+    void release() {
+        for (ScenePoolBase *pool : pools) pool->release();
+        for (size_t i = destructors.size(); i-- > 0; ) destructors[i].destroy(destructors[i].obj);
+        destructors.clear();
+        for (size_t b = 1; b < blocks.size(); b++) ::operator delete(blocks[b].data);
+        if (blocks.size() > 1) blocks.resize(1);
+        block_bytes = blocks.empty() ? 0 : blocks[0].size;
+        current_block = 0;
+        used = 0;
+        TRACK_MEMORY(tracked_blocks, block_bytes);
+    }
+
+    size_t get_block_bytes() const { return block_bytes; }
+    size_t get_object_num() const { return destructors.size(); }
+};
+
+// never destroyed, like the resource tracker, so static pools can register with it in any order
+inline SceneArena& get_scene_arena() {
+    static SceneArena *arena = new SceneArena();
+    return *arena;
+}
+
+// Objects of one type in chunks of SCENE_POOL_CHUNK_SLOTS, in creation order
+template <typename T>
+class ObjectPool : public ScenePoolBase
+{
+private:
+    SceneArena &arena;
+    vector<T*> chunks;
+    int size = 0;
+
+    T* get_slot(int slot) const { return chunks[slot / SCENE_POOL_CHUNK_SLOTS] + slot % SCENE_POOL_CHUNK_SLOTS; }
+
+public:
+    ObjectPool(SceneArena &arena) : arena(arena) { arena.add_pool(this); }
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <typename... Args>
+    T* create(Args&&... args) {
+        if (size == (int)chunks.size() * SCENE_POOL_CHUNK_SLOTS)
+            chunks.push_back(static_cast<T*>(arena.allocate(sizeof(T) * SCENE_POOL_CHUNK_SLOTS, alignof(T))));
+        T *obj = new (get_slot(size)) T(std::forward<Args>(args)...);
+        size++;
+        mark_scene_allocated(obj);
+        return obj;
+    }
+
+    // chunk memory goes back with the arena
+    void release() override {
+        for (int slot = 0; slot < size; slot++) get_slot(slot)->~T();
+        chunks.clear();
+        size = 0;
+    }
+
+    int get_size() const { return size; }
+};
+
+template <typename T>
+ObjectPool<T>& get_scene_pool() {
+    static ObjectPool<T> *pool = new ObjectPool<T>(get_scene_arena());
+    return *pool;
+}
+
+#endif
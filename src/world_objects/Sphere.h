@@ -21,9 +21,9 @@ using namespace glm;
 class Sphere : public Object
 {
 private:
-    unsigned int VAO;
-    unsigned int VBO;
-    unsigned int EBO;
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
     unsigned int indexCount;
 
     int sectors;
@@ -36,6 +36,9 @@ public:
     Sphere(vec3 pos = vec3(0.0f,0.0f,0.0f), float raduis = 1.f, int sectors = 36, int stacks = 18) 
         : Object(pos, vec3(raduis)), sectors(sectors), stacks(stacks), indexCount(0), raduis(raduis)
     {}
+    Sphere(vec3 pos, float raduis, Shader *shared_shader, int sectors = 36, int stacks = 18) 
+        : Object(pos, vec3(raduis), shared_shader), sectors(sectors), stacks(stacks), indexCount(0), raduis(raduis)
+    {}
 
     void construct() override {
         std::vector<float> data;
@@ -114,10 +117,12 @@ public:
         // Load VBO
         glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
         glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, this->VBO, data.size() * sizeof(float));
 
         // Load EBO
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        TRACK_GL_BYTES(RESOURCE_BUFFER, this->EBO, indices.size() * sizeof(unsigned int));
 
         // Pointers (Pos: 3 floats, Tex: 2 floats) = Stride 5
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
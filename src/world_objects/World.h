@@ -43,7 +43,9 @@ public:
         camera->set_orthographic(obj->shader);
     }
 
+    // the world owns what was placed in it, unless the scene arena does
     void clear_objects() {
+        for (Object *obj : objects) if (!obj->scene_allocated) delete obj;
         objects.clear();
     }
 };